@@ -0,0 +1,231 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// AudioFstream performance suite (gain stage and routing matrix ones are in
+// bench_gainstage.cpp and bench_routingmatrix.cpp):
+//   Read/<file>/<frames>              decode + convert per codec, no resampling
+//   Resample/<quality>/<frames>       44.1 kHz -> 48 kHz through libsoxr
+//   Seek/<file>                       seekg() to random positions plus one period
+//
+// The "realtime" counter is seconds of audio produced per second of CPU,
+// roughly how many players of that kind one core can carry.
+//
+// Media comes from generate_test_files.sh / generate_test_videos.sh
+// output (or the CUEMS_BENCH_MEDIA_DIRS colon separated list). With no
+// media available a synthetic WAV file is used.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include "audiofstream.h"
+#include "testwav.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::vector<std::string> mediaExtensions = {
+    ".wav", ".aif", ".aiff", ".flac", ".mp3", ".aac", ".m4a", ".ogg", ".opus",
+    ".wma", ".mp4", ".mov", ".mkv", ".avi", ".webm"
+};
+
+const std::vector<int64_t> bufferSizes = { 128, 512, 2048 };
+
+// Ten seconds of 16 bit stereo noise at 44.1 kHz
+std::string syntheticWav( void )
+{
+    fs::path path = fs::temp_directory_path() / "cuems_bench_synthetic.wav";
+    if ( fs::exists( path ) ) {
+        return path.string();
+    }
+
+    std::mt19937 noise( 1 );
+    writeTestWav( path, 441000, 2, [&noise]( uint32_t, uint16_t ) {
+        return (int32_t)(int16_t)( noise() >> 16 );
+    } );
+
+    return path.string();
+}
+
+// Every media file found in the configured directories
+std::vector<std::string> findMedia( void )
+{
+    const char* env = getenv( "CUEMS_BENCH_MEDIA_DIRS" );
+    std::string dirs = env ? env : CUEMS_BENCH_MEDIA_DIRS;
+
+    std::vector<std::string> files;
+    std::stringstream list( dirs );
+    std::string dir;
+
+    while ( std::getline( list, dir, ':' ) ) {
+        if ( dir.empty() || !fs::is_directory( dir ) ) continue;
+
+        for ( const auto& entry : fs::directory_iterator( dir ) ) {
+            std::string ext = entry.path().extension().string();
+            for ( auto& c : ext ) c = tolower( c );
+
+            if ( entry.is_regular_file() &&
+                 std::find( mediaExtensions.begin(), mediaExtensions.end(), ext ) != mediaExtensions.end() ) {
+                files.push_back( entry.path().string() );
+            }
+        }
+    }
+
+    std::sort( files.begin(), files.end() );
+    return files;
+}
+
+// Read period after period, rewinding (untimed) at the end of the file
+void readLoop( benchmark::State& state, AudioFstream& stream, unsigned int rate )
+{
+    size_t frames = state.range( 0 );
+    std::vector<float> buffer( frames * stream.getChannels() );
+    int64_t totalFrames = 0;
+
+    for ( auto _ : state ) {
+        stream.read( (char*) buffer.data(), buffer.size() * sizeof(float) );
+        streamsize got = stream.gcount();
+        benchmark::DoNotOptimize( buffer.data() );
+        totalFrames += got / sizeof(float) / stream.getChannels();
+
+        if ( got < (streamsize)( buffer.size() * sizeof(float) ) ) {
+            state.PauseTiming();
+            stream.clear();
+            stream.seekg( 0, ios_base::beg );
+            state.ResumeTiming();
+        }
+    }
+
+    state.SetItemsProcessed( totalFrames );
+    state.counters["realtime"] = benchmark::Counter( (double) totalFrames / rate, benchmark::Counter::kIsRate );
+}
+
+////////////////////////////////////////////
+// Decode throughput, file rate out
+////////////////////////////////////////////
+void BM_Read( benchmark::State& state, const std::string& path )
+{
+    AudioFstream stream( path );
+    if ( !stream.good() ) {
+        state.SkipWithError( "Cannot open file" );
+        return;
+    }
+
+    readLoop( state, stream, stream.getSampleRate() );
+}
+
+////////////////////////////////////////////
+// Resampling cost per soxr quality
+////////////////////////////////////////////
+void BM_Resample( benchmark::State& state, const std::string& path, const std::string& quality )
+{
+    AudioFstream stream( path );
+    if ( !stream.good() ) {
+        state.SkipWithError( "Cannot open file" );
+        return;
+    }
+
+    stream.setResampleQuality( quality );
+    unsigned int target = ( stream.getSampleRate() == 48000 ) ? 44100 : 48000;
+    stream.setTargetSampleRate( target );
+
+    readLoop( state, stream, target );
+}
+
+////////////////////////////////////////////
+// Seek latency: random position plus the first period after it
+////////////////////////////////////////////
+void BM_Seek( benchmark::State& state, const std::string& path )
+{
+    AudioFstream stream( path );
+    if ( !stream.good() || stream.getFileSize() == 0 ) {
+        state.SkipWithError( "Cannot open file or unknown length" );
+        return;
+    }
+
+    size_t frameBytes = stream.getChannels() * sizeof(float);
+    unsigned long long fileFrames = stream.getFileSize() / frameBytes;
+    std::vector<float> buffer( 512 * stream.getChannels() );
+    std::mt19937_64 positions( 42 );
+
+    for ( auto _ : state ) {
+        long long frame = positions() % ( fileFrames > 512 ? fileFrames - 512 : 1 );
+        stream.clear();
+        stream.seekg( frame * frameBytes, ios_base::beg );
+        stream.read( (char*) buffer.data(), buffer.size() * sizeof(float) );
+        benchmark::DoNotOptimize( buffer.data() );
+    }
+}
+
+std::string label( const std::string& path )
+{
+    return fs::path( path ).filename().string();
+}
+
+}
+
+int main( int argc, char** argv )
+{
+    std::vector<std::string> media = findMedia();
+    if ( media.empty() ) {
+        media.push_back( syntheticWav() );
+    }
+
+    // Resampling is measured on one 44.1 kHz file, the codec does not matter
+    std::string resampleSource = media.front();
+    for ( const auto& path : media ) {
+        if ( path.find( "44100" ) != std::string::npos && fs::path( path ).extension() == ".wav" ) {
+            resampleSource = path;
+            break;
+        }
+    }
+
+    for ( const auto& path : media ) {
+        auto* bm = benchmark::RegisterBenchmark( ( "Read/" + label( path ) ).c_str(), BM_Read, path );
+        for ( int64_t frames : bufferSizes ) bm->Arg( frames );
+    }
+
+    for ( const std::string quality : { "vhq", "hq", "mq", "lq" } ) {
+        auto* bm = benchmark::RegisterBenchmark( ( "Resample/" + quality ).c_str(), BM_Resample, resampleSource, quality );
+        for ( int64_t frames : bufferSizes ) bm->Arg( frames );
+    }
+
+    for ( const auto& path : media ) {
+        benchmark::RegisterBenchmark( ( "Seek/" + label( path ) ).c_str(), BM_Seek, path )->Unit( benchmark::kMicrosecond );
+    }
+
+    benchmark::Initialize( &argc, argv );
+    if ( benchmark::ReportUnrecognizedArguments( argc, argv ) ) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,120 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// Gain stage suite, registered alongside the AudioFstream one:
+//   Gain/Modulo/<channels>/<frames>     the former per sample loop,
+//                                        volumeMaster[i % nChannels]
+//   Gain/Constant/<channels>/<frames>   GainStage, gains unchanged
+//   Gain/Ramp/<channels>/<frames>       GainStage, new gains every period
+//
+// Every iteration first copies a fresh period into the buffer, as the
+// decoder would, so repeated gains never take it into denormals. The
+// "realtime" counter is seconds of audio processed per second of CPU at
+// 48 kHz. The kernel picked for this CPU is in the benchmark label.
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+#include "gainstage.h"
+
+static const double GAIN_BENCH_RATE = 48000.0;
+
+static void setRealtime( benchmark::State& state, unsigned int frames )
+{
+    state.counters["realtime"] = benchmark::Counter(
+        state.iterations() * frames / GAIN_BENCH_RATE, benchmark::Counter::kIsRate );
+    state.SetItemsProcessed( state.iterations() * frames );
+}
+
+static void BM_GainModulo( benchmark::State& state )
+{
+    unsigned int channels = state.range( 0 );
+    unsigned int frames = state.range( 1 );
+    std::vector<float> source( frames * channels, 0.5f );
+    std::vector<float> buffer( source );
+    float* volumeMaster = new float[channels];
+    for ( unsigned int c = 0; c < channels; c++ ) {
+        volumeMaster[c] = 0.999f;
+    }
+
+    for ( auto _ : state ) {
+        memcpy( buffer.data(), source.data(), buffer.size() * sizeof( float ) );
+        float* floatBuffer = buffer.data();
+        for ( unsigned int i = 0; i < frames * channels; i++ ) {
+            floatBuffer[i] *= volumeMaster[i % channels];
+        }
+        benchmark::DoNotOptimize( floatBuffer );
+        benchmark::ClobberMemory();
+    }
+
+    delete []volumeMaster;
+    setRealtime( state, frames );
+}
+
+static void BM_GainConstant( benchmark::State& state )
+{
+    unsigned int channels = state.range( 0 );
+    unsigned int frames = state.range( 1 );
+    std::vector<float> source( frames * channels, 0.5f );
+    std::vector<float> buffer( source );
+    GainStage gain;
+    gain.setAllGains( 0.999f );
+    gain.process( buffer.data(), frames, channels );
+
+    for ( auto _ : state ) {
+        memcpy( buffer.data(), source.data(), buffer.size() * sizeof( float ) );
+        gain.process( buffer.data(), frames, channels );
+        benchmark::ClobberMemory();
+    }
+
+    setRealtime( state, frames );
+    state.SetLabel( GainStage::getKernelName() );
+}
+
+static void BM_GainRamp( benchmark::State& state )
+{
+    unsigned int channels = state.range( 0 );
+    unsigned int frames = state.range( 1 );
+    std::vector<float> source( frames * channels, 0.5f );
+    std::vector<float> buffer( source );
+    GainStage gain;
+    gain.setRamp( state.range( 2 ) ? GainStage::RAMP_EXPONENTIAL : GainStage::RAMP_LINEAR );
+    bool up = false;
+
+    for ( auto _ : state ) {
+        memcpy( buffer.data(), source.data(), buffer.size() * sizeof( float ) );
+        gain.setAllGains( up ? 1.0f : 0.5f );
+        up = !up;
+        gain.process( buffer.data(), frames, channels );
+        benchmark::ClobberMemory();
+    }
+
+    setRealtime( state, frames );
+    state.SetLabel( std::string( GainStage::getKernelName() ) + ( state.range( 2 ) ? " exp" : " lin" ) );
+}
+
+BENCHMARK( BM_GainModulo )->Name( "Gain/Modulo" )
+    ->ArgsProduct( { { 2, 8 }, { 128, 512, 2048 } } );
+BENCHMARK( BM_GainConstant )->Name( "Gain/Constant" )
+    ->ArgsProduct( { { 2, 8 }, { 128, 512, 2048 } } );
+BENCHMARK( BM_GainRamp )->Name( "Gain/Ramp" )
+    ->ArgsProduct( { { 2, 8 }, { 128, 512, 2048 }, { 0, 1 } } );
@@ -0,0 +1,63 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// Native PCM conversion suite, registered alongside the AudioFstream one:
+//   Pcm/Convert/<encoding>/<frames>    PcmReader::convert, stereo
+//
+// <encoding> is a PcmReader::Encoding (0 s16le, 2 s24le, 4 s32le,
+// 6 f32le, odd ones big endian). The "realtime" counter is seconds of
+// stereo 48 kHz audio converted per second of CPU. The kernel picked
+// for this CPU is in the benchmark label. Whole file throughput,
+// mapping included, shows in the Decode benchmarks of WAV files.
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "pcmreader.h"
+
+static const double PCM_BENCH_RATE = 48000.0;
+
+static void BM_PcmConvert( benchmark::State& state )
+{
+    PcmReader::Encoding encoding = (PcmReader::Encoding) state.range( 0 );
+    unsigned int frames = state.range( 1 );
+    size_t samples = frames * 2;
+    std::vector<unsigned char> input( samples * PcmReader::bytesPerSample( encoding ) );
+    for ( size_t i = 0; i < input.size(); i++ ) {
+        input[i] = (unsigned char) ( i * 37 );
+    }
+    std::vector<float> output( samples );
+
+    for ( auto _ : state ) {
+        PcmReader::convert( input.data(), output.data(), samples, encoding );
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["realtime"] = benchmark::Counter(
+        state.iterations() * frames / PCM_BENCH_RATE, benchmark::Counter::kIsRate );
+    state.SetBytesProcessed( state.iterations() * input.size() );
+    state.SetLabel( PcmReader::getKernelName() );
+}
+
+BENCHMARK( BM_PcmConvert )->Name( "Pcm/Convert" )
+    ->ArgsProduct( { { PcmReader::INT16_LE, PcmReader::INT16_BE, PcmReader::INT24_LE,
+                       PcmReader::INT24_BE, PcmReader::INT32_LE, PcmReader::FLOAT32_LE },
+                     { 512, 16384 } } );
@@ -0,0 +1,95 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// Routing matrix suite, registered alongside the AudioFstream one:
+//   Route/Loop/<inputs>/<outputs>/<frames>     plain triple loop over
+//                                               frames, outputs and inputs
+//   Route/Matrix/<inputs>/<outputs>/<frames>   RoutingMatrix::route()
+//
+// Every input feeds every output, the worst case for the matrix. The
+// "realtime" counter is seconds of audio routed per second of CPU at
+// 48 kHz. The kernel picked for this CPU is in the benchmark label.
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "routingmatrix.h"
+
+static const double ROUTE_BENCH_RATE = 48000.0;
+
+static void BM_RouteLoop( benchmark::State& state )
+{
+    unsigned int inputs = state.range( 0 );
+    unsigned int outputs = state.range( 1 );
+    unsigned int frames = state.range( 2 );
+    std::vector<float> in( frames * inputs, 0.5f );
+    std::vector<float> out( frames * outputs );
+    std::vector<float> gains( inputs * outputs, 0.7f );
+
+    for ( auto _ : state ) {
+        for ( unsigned int f = 0; f < frames; f++ ) {
+            for ( unsigned int o = 0; o < outputs; o++ ) {
+                float sum = 0.0f;
+                for ( unsigned int i = 0; i < inputs; i++ ) {
+                    sum += in[f * inputs + i] * gains[i * outputs + o];
+                }
+                out[f * outputs + o] = sum;
+            }
+        }
+        benchmark::DoNotOptimize( out.data() );
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["realtime"] = benchmark::Counter(
+        state.iterations() * frames / ROUTE_BENCH_RATE, benchmark::Counter::kIsRate );
+}
+
+static void BM_RouteMatrix( benchmark::State& state )
+{
+    unsigned int inputs = state.range( 0 );
+    unsigned int outputs = state.range( 1 );
+    unsigned int frames = state.range( 2 );
+    std::vector<float> in( frames * inputs, 0.5f );
+    std::vector<float> out( frames * outputs );
+
+    RoutingMatrix matrix;
+    matrix.setSize( inputs, outputs );
+    for ( unsigned int i = 0; i < inputs; i++ ) {
+        for ( unsigned int o = 0; o < outputs; o++ ) {
+            matrix.setGain( i, o, 0.7f );
+        }
+    }
+
+    for ( auto _ : state ) {
+        matrix.route( in.data(), out.data(), frames );
+        benchmark::DoNotOptimize( out.data() );
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["realtime"] = benchmark::Counter(
+        state.iterations() * frames / ROUTE_BENCH_RATE, benchmark::Counter::kIsRate );
+    state.SetLabel( RoutingMatrix::getKernelName() );
+}
+
+BENCHMARK( BM_RouteLoop )->Name( "Route/Loop" )
+    ->Args( { 2, 6, 512 } )->Args( { 6, 8, 512 } )->Args( { 8, 16, 512 } );
+BENCHMARK( BM_RouteMatrix )->Name( "Route/Matrix" )
+    ->Args( { 2, 6, 512 } )->Args( { 6, 8, 512 } )->Args( { 8, 16, 512 } );
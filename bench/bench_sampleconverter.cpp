@@ -0,0 +1,118 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// Sample converter suite, registered alongside the AudioFstream one:
+//   Convert/Swr/<format>/<channels>          libswresample, same rate
+//   Convert/Specialised/<format>/<channels>  SampleConverter
+//
+// <format> is a SampleConverter::Format (0 s16, 2 flt, 4 s16p, 6 fltp,
+// 7 dblp), always 1024 frames, as an AAC frame. The "realtime" counter
+// is seconds of 48 kHz audio converted per second of CPU. The planar
+// float kernel picked for this CPU is in the label.
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "sampleconverter.h"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+}
+
+static const int CONVERT_BENCH_RATE = 48000;
+static const int CONVERT_BENCH_FRAMES = 1024;
+
+static const AVSampleFormat avFormats[SampleConverter::FORMAT_COUNT] = {
+    AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_DBL,
+    AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP
+};
+
+// Silence in any format: channels planes, each big enough for all
+// the samples of a packed format at 8 bytes a sample
+struct Input {
+    Input( unsigned int channels ) :
+        data( channels, std::vector<uint8_t>( CONVERT_BENCH_FRAMES * channels * 8 ) )
+    {
+        for ( auto& plane : data ) {
+            planes.push_back( plane.data() );
+        }
+    }
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<const uint8_t*> planes;
+};
+
+static void setRealtime( benchmark::State& state )
+{
+    state.counters["realtime"] = benchmark::Counter(
+        state.iterations() * CONVERT_BENCH_FRAMES / (double) CONVERT_BENCH_RATE, benchmark::Counter::kIsRate );
+    state.SetItemsProcessed( state.iterations() * CONVERT_BENCH_FRAMES );
+}
+
+static void BM_ConvertSwr( benchmark::State& state )
+{
+    SampleConverter::Format format = (SampleConverter::Format) state.range( 0 );
+    unsigned int channels = state.range( 1 );
+    Input input( channels );
+    std::vector<float> output( CONVERT_BENCH_FRAMES * channels );
+
+    int64_t layout = av_get_default_channel_layout( channels );
+    SwrContext* swr = swr_alloc_set_opts( nullptr, layout, AV_SAMPLE_FMT_FLT, CONVERT_BENCH_RATE,
+                                          layout, avFormats[format], CONVERT_BENCH_RATE, 0, nullptr );
+    if ( swr == nullptr || swr_init( swr ) < 0 ) {
+        swr_free( &swr );
+        state.SkipWithError( "swresample context" );
+        return;
+    }
+
+    for ( auto _ : state ) {
+        uint8_t* out = (uint8_t*) output.data();
+        swr_convert( swr, &out, CONVERT_BENCH_FRAMES, (const uint8_t**) input.planes.data(), CONVERT_BENCH_FRAMES );
+        benchmark::ClobberMemory();
+    }
+
+    swr_free( &swr );
+    setRealtime( state );
+}
+
+static void BM_ConvertSpecialised( benchmark::State& state )
+{
+    SampleConverter::Format format = (SampleConverter::Format) state.range( 0 );
+    unsigned int channels = state.range( 1 );
+    Input input( channels );
+    std::vector<float> output( CONVERT_BENCH_FRAMES * channels );
+    SampleConverter::Function convert = SampleConverter::find( format, channels );
+
+    for ( auto _ : state ) {
+        convert( input.planes.data(), output.data(), CONVERT_BENCH_FRAMES );
+        benchmark::ClobberMemory();
+    }
+
+    setRealtime( state );
+    state.SetLabel( SampleConverter::getKernelName() );
+}
+
+BENCHMARK( BM_ConvertSwr )->Name( "Convert/Swr" )
+    ->ArgsProduct( { { SampleConverter::S16, SampleConverter::FLT, SampleConverter::S16P,
+                       SampleConverter::FLTP, SampleConverter::DBLP }, { 2, 8 } } );
+BENCHMARK( BM_ConvertSpecialised )->Name( "Convert/Specialised" )
+    ->ArgsProduct( { { SampleConverter::S16, SampleConverter::FLT, SampleConverter::S16P,
+                       SampleConverter::FLTP, SampleConverter::DBLP }, { 2, 8 } } );
@@ -37,8 +37,14 @@
 //////////////////////////////////////////////////////////
 
 #include "audiofstream.h"
+#include "sampleconverter.h"
 #include <cstring>
 #include <algorithm>
+#include <chrono>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
 
 ////////////////////////////////////////////
 // Constructor
@@ -59,6 +65,7 @@ AudioFstream::AudioFstream( const string filename,
     lastBytesRead = 0;
     
     // Initialize audio properties
+    sourceChannels = 0;
     fileChannels = 0;
     fileSampleRate = 0;
     fileBitsPerSample = 32;  // Output is 32-bit float
@@ -66,11 +73,20 @@ AudioFstream::AudioFstream( const string filename,
     fileSize = 0;
     currentSamplePos = 0;
     
+    // Initialize seek state
+    lastFramePts = AV_NOPTS_VALUE;
+    streamTimeBase = (AVRational){1, 1};
+    streamStartTime = AV_NOPTS_VALUE;
+    seekPrerollFrames = 0;
+    seekScratch = nullptr;
+    seekScratchFrames = 0;
+    
     // Initialize conversion buffer
     conversionBuffer = nullptr;
     conversionBufferSize = 0;
     conversionBufferUsed = 0;
     conversionBufferPos = 0;
+    remixBuffer = nullptr;
     
     // Initialize resampling members
     targetSampleRate = 0;
@@ -78,9 +94,20 @@ AudioFstream::AudioFstream( const string filename,
     resampler = nullptr;
     resamplingEnabled = false;
     qualitySpec = soxr_quality_spec(SOXR_HQ, 0);  // Default to high quality
-    resampleInputBuffer = nullptr;
-    resampleOutputBuffer = nullptr;
-    resampleBufferSize = 0;
+    varispeedEnabled = false;
+    playbackRate = 1.0;
+
+    // Initialize preload, off unless asked for
+    fileMode = openmode;
+    preloadForced = false;
+    preloadMaxSeconds = 0;
+    preloaded = false;
+    memoryData = nullptr;
+    memoryFloats = 0;
+    qualityName = "hq";
+    cacheCancel = false;
+    sharedMemory = false;
+    nativePcm = true;
 
     if ( !filename.empty() ) {
         open(filename, openmode);
@@ -112,6 +139,15 @@ void AudioFstream::open(const string path, ios_base::openmode mode)
 {
     close();  // Close any existing file
     
+    filePath = path;
+    fileMode = mode;
+    
+    // Uncompressed PCM needs neither demuxer nor decoder
+    if (openNative()) {
+        completeOpen(string(pcmReader.getFormatName()) + " (native PCM)");
+        return;
+    }
+    
     // Open using MediaFileReader
     if (!fileReader.open(path)) {
         std::cerr << "Unable to find or open file: " << path << endl;
@@ -202,58 +238,141 @@ void AudioFstream::open(const string path, ios_base::openmode mode)
         totalSamples = 0;  // Will be updated as we decode
     }
     
-    // File size in bytes (32-bit float output for JACK)
-    fileSize = totalSamples * fileChannels * 4;  // 4 bytes per sample (32-bit float)
-    
-    // Setup libswresample for format conversion to float (and optional channel downmixing)
-    // Use AudioDecoder's createSwrContext which handles unknown channel layouts properly
-    unsigned int outputChannels = (targetChannels > 0) ? targetChannels : fileChannels;
-    
-    if (targetChannels > 0 && targetChannels != fileChannels) {
-        std::cerr << "Downmixing from " << fileChannels << " to " << targetChannels << " channels" << endl;
-        CuemsLogger::getLogger()->logInfo("Downmixing audio: " + std::to_string(fileChannels) + 
-                                          " -> " + std::to_string(targetChannels) + " channels");
-    }
+    // Stream timing used to find where a seek actually landed
+    streamTimeBase = audioStream->time_base;
+    streamStartTime = audioStream->start_time;
     
-    swrContext = audioDecoder.createSwrContextExplicit(outputChannels, fileSampleRate, AV_SAMPLE_FMT_FLT);
+    // Codecs with overlapping frames (MP3 bit reservoir, AAC/Opus MDCT)
+    // need some audio decoded before the target to come out right
+    seekPrerollFrames = std::max(codecParams->seek_preroll, 0) + std::max(codecParams->frame_size, 0);
     
-    if (!swrContext) {
-        std::cerr << "Failed to create swresample context" << endl;
-        CuemsLogger::getLogger()->logError("Failed to create swresample context");
+    // Setup libswresample for format conversion to float (and optional channel downmixing)
+    sourceChannels = fileChannels;
+    if (!setupConversion((targetChannels > 0) ? targetChannels : sourceChannels)) {
         cleanupFFmpeg();
         errorState = true;
         fileOpen = false;
         return;
     }
     
-    // Allocate conversion buffer (decode → float)
-    // Use outputChannels (may be downmixed) instead of fileChannels
-    // Increase buffer size for formats like DTS that may have larger frames
-    conversionBufferSize = 16384 * outputChannels;  // 16384 frames worth (larger for DTS/complex codecs)
-    conversionBuffer = new float[conversionBufferSize];
-    conversionBufferUsed = 0;
-    conversionBufferPos = 0;
+    completeOpen(av_get_sample_fmt_name(sampleFmt));
+}
+
+////////////////////////////////////////////
+// Open uncompressed PCM with the native reader
+////////////////////////////////////////////
+bool AudioFstream::openNative()
+{
+    if (!nativePcm || !pcmReader.open(filePath)) {
+        return false;
+    }
     
-    // Update fileChannels to reflect output channel count (for reading logic)
-    fileChannels = outputChannels;
+    sourceChannels = pcmReader.getChannels();
+    fileSampleRate = pcmReader.getSampleRate();
+    totalSamples = pcmReader.getFrames();
     
+    if (!setupConversion((targetChannels > 0) ? targetChannels : sourceChannels)) {
+        pcmReader.close();
+        return false;
+    }
+    
+    std::cerr << "Native PCM reader, " << PcmReader::getKernelName() << " conversion" << endl;
+    return true;
+}
+
+////////////////////////////////////////////
+// Common end of open() once the source is ready
+////////////////////////////////////////////
+void AudioFstream::completeOpen(const string& formatName)
+{
     fileOpen = true;
     errorState = false;
     eofReached = false;
     currentSamplePos = 0;
     
-    CuemsLogger::getLogger()->logOK("File open OK! : " + path);
+    CuemsLogger::getLogger()->logOK("File open OK! : " + filePath);
     CuemsLogger::getLogger()->logOK("Sample rate: " + std::to_string(fileSampleRate) + " Hz");
     CuemsLogger::getLogger()->logOK("Channels: " + std::to_string(fileChannels));
-    CuemsLogger::getLogger()->logOK("Format: " + string(av_get_sample_fmt_name(sampleFmt)));
+    CuemsLogger::getLogger()->logOK("Format: " + formatName);
     if (totalSamples > 0) {
         CuemsLogger::getLogger()->logOK("Duration: " + std::to_string(totalSamples / (double)fileSampleRate) + " seconds");
     }
     
     // Initialize resampler if target sample rate is already set
-    if (targetSampleRate > 0 && targetSampleRate != fileSampleRate) {
+    if (resamplerNeeded()) {
         initializeResampler();
     }
+    
+    // Reopened with the output already known, e.g. OSC /load
+    if (targetSampleRate > 0) {
+        preloadFile();
+    }
+}
+
+////////////////////////////////////////////
+// Conversion from the decoded format to interleaved float in
+// outputChannels: the swresample context and the buffers sized by it.
+// Also sets fileChannels and fileSize, which follow the output layout.
+////////////////////////////////////////////
+bool AudioFstream::setupConversion(unsigned int outputChannels)
+{
+    if (swrContext) {
+        swr_free(&swrContext);
+    }
+    delete[] conversionBuffer;
+    conversionBuffer = nullptr;
+    delete[] seekScratch;
+    seekScratch = nullptr;
+    delete[] remixBuffer;
+    remixBuffer = nullptr;
+    
+    if (outputChannels != sourceChannels) {
+        std::cerr << "Downmixing from " << sourceChannels << " to " << outputChannels << " channels" << endl;
+        CuemsLogger::getLogger()->logInfo("Downmixing audio: " + std::to_string(sourceChannels) + 
+                                          " -> " + std::to_string(outputChannels) + " channels");
+    }
+    
+    if (!pcmReader.isOpen()) {
+        // Use AudioDecoder's createSwrContext which handles unknown channel layouts properly
+        swrContext = audioDecoder.createSwrContextExplicit(outputChannels, fileSampleRate, AV_SAMPLE_FMT_FLT);
+    } else if (outputChannels != sourceChannels) {
+        // Native PCM comes out of its reader as float already, libswresample
+        // only remixes it, from the default layout FFmpeg gives such files
+        swrContext = swr_alloc_set_opts(nullptr,
+                                        av_get_default_channel_layout(outputChannels), AV_SAMPLE_FMT_FLT, fileSampleRate,
+                                        av_get_default_channel_layout(sourceChannels), AV_SAMPLE_FMT_FLT, fileSampleRate,
+                                        0, nullptr);
+        if (swrContext && swr_init(swrContext) < 0) {
+            swr_free(&swrContext);
+        }
+        remixBuffer = new float[16384 * sourceChannels];
+    }
+    
+    if (!swrContext && (!pcmReader.isOpen() || outputChannels != sourceChannels)) {
+        std::cerr << "Failed to create swresample context" << endl;
+        CuemsLogger::getLogger()->logError("Failed to create swresample context");
+        return false;
+    }
+    
+    // Allocate conversion buffer (decode → float)
+    // Use outputChannels (may be downmixed) instead of fileChannels
+    // Increase buffer size for formats like DTS that may have larger frames
+    conversionBufferSize = 16384 * outputChannels;  // 16384 frames worth (larger for DTS/complex codecs)
+    conversionBuffer = new float[conversionBufferSize];
+    conversionBufferUsed = 0;
+    conversionBufferPos = 0;
+    
+    // Scratch for the resampled frames discarded after a seek
+    seekScratchFrames = 1024;
+    seekScratch = new float[seekScratchFrames * outputChannels];
+    
+    // Update fileChannels to reflect output channel count (for reading logic)
+    fileChannels = outputChannels;
+    
+    // File size in bytes (32-bit float output for JACK)
+    fileSize = totalSamples * fileChannels * 4;  // 4 bytes per sample (32-bit float)
+    
+    return true;
 }
 
 ////////////////////////////////////////////
@@ -262,8 +381,38 @@ void AudioFstream::open(const string path, ios_base::openmode mode)
 void AudioFstream::setTargetChannels(unsigned int channels)
 {
     targetChannels = channels;
-    // Note: Downmixing is applied when file is opened, not dynamically
-    // This matches mpv's behavior where channel layout is set at demuxer initialization
+    
+    if (!fileOpen) {
+        return;  // Applied when the file is opened
+    }
+    
+    unsigned int outputChannels = (channels > 0) ? channels : sourceChannels;
+    if (outputChannels == fileChannels) {
+        return;
+    }
+    
+    // Where we are, in frames, to land there again in the new layout
+    int64_t frame = currentSamplePos / fileChannels;
+    bool started = currentSamplePos > 0 || conversionBufferUsed > 0;
+    
+    // Memory holds the old layout
+    dropMemory();
+    
+    // The demuxer and the codec (or the native reader) stay as they are,
+    // only the conversion (and soxr, built for a channel count) is made again
+    if (!setupConversion(outputChannels)) {
+        errorState = true;
+        return;
+    }
+    if (resampler) {
+        initializeResampler();
+    }
+    
+    if (started) {
+        seekg(frame * fileChannels * 4, ios_base::beg);
+    }
+    
+    preloadFile();
 }
 
 ////////////////////////////////////////////
@@ -347,6 +496,116 @@ bool AudioFstream::decodeNextFrame()
     }
 }
 
+////////////////////////////////////////////
+// Specialised converter for a decoded sample format, if there is one
+////////////////////////////////////////////
+static SampleConverter::Function frameConverter(int format, unsigned int channels)
+{
+    switch (format) {
+        case AV_SAMPLE_FMT_S16:     return SampleConverter::find(SampleConverter::S16, channels);
+        case AV_SAMPLE_FMT_S32:     return SampleConverter::find(SampleConverter::S32, channels);
+        case AV_SAMPLE_FMT_FLT:     return SampleConverter::find(SampleConverter::FLT, channels);
+        case AV_SAMPLE_FMT_DBL:     return SampleConverter::find(SampleConverter::DBL, channels);
+        case AV_SAMPLE_FMT_S16P:    return SampleConverter::find(SampleConverter::S16P, channels);
+        case AV_SAMPLE_FMT_S32P:    return SampleConverter::find(SampleConverter::S32P, channels);
+        case AV_SAMPLE_FMT_FLTP:    return SampleConverter::find(SampleConverter::FLTP, channels);
+        case AV_SAMPLE_FMT_DBLP:    return SampleConverter::find(SampleConverter::DBLP, channels);
+        default:                    return nullptr;
+    }
+}
+
+////////////////////////////////////////////
+// Decode the next frame and convert it to float into conversionBuffer
+// Returns false when nothing could be added (EOF or error)
+////////////////////////////////////////////
+bool AudioFstream::refillConversionBuffer()
+{
+    uint8_t* out = (uint8_t*)conversionBuffer;
+    int maxBufferSamples = conversionBufferSize / fileChannels;
+
+    if (pcmReader.isOpen()) {
+        // Remixed, the reader fills remixBuffer in the file's layout
+        float* target = swrContext ? remixBuffer : conversionBuffer;
+        size_t frames = pcmReader.read(target, maxBufferSamples);
+        if (frames == 0) {
+            eofReached = true;
+            return false;
+        }
+        if (swrContext) {
+            const uint8_t* in = (const uint8_t*)remixBuffer;
+            int remixed = swr_convert(swrContext, &out, maxBufferSamples, &in, (int)frames);
+            if (remixed < 0) {
+                std::cerr << "Error remixing audio samples: " << getFFmpegError(remixed) << endl;
+                errorState = true;
+                return false;
+            }
+            frames = remixed;
+        }
+        conversionBufferUsed = frames * fileChannels;
+        conversionBufferPos = 0;
+        return true;
+    }
+
+    if (decodeNextFrame()) {
+        // Common formats at the file's own channel count are converted
+        // without libswresample, as long as it holds nothing back. The
+        // frame is checked too, chained Ogg or an AAC PCE can change it.
+        SampleConverter::Function convert = nullptr;
+        if (fileChannels == sourceChannels && frame->channels == (int)fileChannels &&
+            frame->nb_samples <= maxBufferSamples && swr_get_delay(swrContext, fileSampleRate) == 0) {
+            convert = frameConverter(frame->format, fileChannels);
+        }
+        
+        if (convert) {
+            convert(frame->extended_data, conversionBuffer, frame->nb_samples);
+            lastFramePts = frame->best_effort_timestamp;
+            conversionBufferUsed = frame->nb_samples * fileChannels;
+            conversionBufferPos = 0;
+            av_frame_unref(frame);
+            return true;
+        }
+        
+        // Account for libswresample's internal buffering delay
+        int64_t delay = swr_get_delay(swrContext, fileSampleRate);
+        
+        // Calculate max output samples: input samples + buffered samples
+        int64_t estimated_out_samples = av_rescale_rnd(delay + frame->nb_samples,
+                                                        fileSampleRate, fileSampleRate,
+                                                        AV_ROUND_UP);
+        int max_out_samples = std::min((int64_t)maxBufferSamples, estimated_out_samples);
+        
+        int out_samples = swr_convert(swrContext, &out, max_out_samples,
+                                     (const uint8_t**)frame->data, frame->nb_samples);
+        
+        // Where this frame sits in the stream, used to land seeks exactly
+        lastFramePts = frame->best_effort_timestamp;
+        av_frame_unref(frame);
+        
+        if (out_samples < 0) {
+            std::cerr << "Error converting audio samples: " << getFFmpegError(out_samples) << endl;
+            errorState = true;
+            return false;
+        }
+        
+        conversionBufferUsed = out_samples * fileChannels;
+        conversionBufferPos = 0;
+        return true;
+    }
+    
+    // EOF - drain remaining samples from swresample
+    int64_t delay = swr_get_delay(swrContext, fileSampleRate);
+    if (delay > 0) {
+        int out_samples = swr_convert(swrContext, &out, maxBufferSamples,
+                                     nullptr, 0);  // NULL input to drain
+        if (out_samples > 0) {
+            conversionBufferUsed = out_samples * fileChannels;
+            conversionBufferPos = 0;
+            return true;  // Process drained samples
+        }
+    }
+    return false;
+}
+
 ////////////////////////////////////////////
 // Read data from audio file
 ////////////////////////////////////////////
@@ -364,6 +623,21 @@ void AudioFstream::read(char* buffer, size_t bytes)
     // Calculate how many samples we need (32-bit float output)
     size_t samplesNeeded = bytes / 4;  // 4 bytes per 32-bit float sample
     
+    // Preloaded: just a copy from memory
+    if (preloaded.load(std::memory_order_acquire)) {
+        size_t available = (size_t)currentSamplePos < memoryFloats ? memoryFloats - currentSamplePos : 0;
+        size_t floatsToCopy = std::min(samplesNeeded, available);
+        
+        memcpy(outputPtr, memoryData + currentSamplePos, floatsToCopy * sizeof(float));
+        lastBytesRead = floatsToCopy * 4;
+        currentSamplePos += floatsToCopy;
+        
+        if (floatsToCopy < samplesNeeded) {
+            eofReached = true;
+        }
+        return;
+    }
+    
     // If resampling is enabled, we need to work with floats through the resampling pipeline
     if (resamplingEnabled && resampler) {
         // samplesNeeded is the total number of samples across all channels (for interleaved audio)
@@ -371,53 +645,15 @@ void AudioFstream::read(char* buffer, size_t bytes)
         size_t framesNeeded = samplesNeeded / fileChannels;
         size_t resampledFloatsNeeded = framesNeeded * fileChannels;
         
-        float* tempFloatBuffer = new float[resampledFloatsNeeded];
+        // libsoxr writes straight into the caller's buffer (same interleaved
+        // float layout), so nothing is allocated on this path after open
         size_t floatsResampled = 0;
         
         while (floatsResampled < resampledFloatsNeeded && !eofReached) {
             // First, ensure we have decoded float data in conversionBuffer
             while (conversionBufferPos >= conversionBufferUsed && !eofReached) {
                 // Need to decode more data
-                if (decodeNextFrame()) {
-                    // Convert decoded frame to float
-                    // Account for libswresample's internal buffering delay
-                    int64_t delay = swr_get_delay(swrContext, fileSampleRate);
-                    
-                    // Calculate max output samples: input samples + buffered samples
-                    int64_t estimated_out_samples = av_rescale_rnd(delay + frame->nb_samples,
-                                                                    fileSampleRate, fileSampleRate,
-                                                                    AV_ROUND_UP);
-                    int max_out_samples = std::min((int64_t)(conversionBufferSize / fileChannels),
-                                                    estimated_out_samples);
-                    
-                    uint8_t* out = (uint8_t*)conversionBuffer;
-                    int out_samples = swr_convert(swrContext, &out, max_out_samples,
-                                                 (const uint8_t**)frame->data, frame->nb_samples);
-                    
-                    if (out_samples < 0) {
-                        std::cerr << "Error converting audio samples" << endl;
-                        errorState = true;
-                        av_frame_unref(frame);
-                        break;
-                    }
-                    
-                    conversionBufferUsed = out_samples * fileChannels;
-                    conversionBufferPos = 0;
-                    av_frame_unref(frame);
-                } else {
-                    // EOF - drain remaining samples from swresample
-                    int64_t delay = swr_get_delay(swrContext, fileSampleRate);
-                    if (delay > 0) {
-                        int max_out_samples = conversionBufferSize / fileChannels;
-                        uint8_t* out = (uint8_t*)conversionBuffer;
-                        int out_samples = swr_convert(swrContext, &out, max_out_samples,
-                                                     nullptr, 0);  // NULL input to drain
-                        if (out_samples > 0) {
-                            conversionBufferUsed = out_samples * fileChannels;
-                            conversionBufferPos = 0;
-                            continue;  // Process drained samples
-                        }
-                    }
+                if (!refillConversionBuffer()) {
                     break;  // EOF or error
                 }
             }
@@ -429,7 +665,7 @@ void AudioFstream::read(char* buffer, size_t bytes)
                     size_t outputFramesGenerated = 0;
                     soxr_error_t soxr_err = soxr_process(resampler,
                                                          nullptr, 0, nullptr,  // NULL input to drain
-                                                         tempFloatBuffer + floatsResampled, 
+                                                         outputPtr + floatsResampled, 
                                                          framesNeeded - (floatsResampled / fileChannels), 
                                                          &outputFramesGenerated);
                     
@@ -450,7 +686,6 @@ void AudioFstream::read(char* buffer, size_t bytes)
                 // Feed available float data to libsoxr
                 size_t floatsAvailable = conversionBufferUsed - conversionBufferPos;
                 size_t floatsToResample = std::min(floatsAvailable, resampledFloatsNeeded - floatsResampled);
-                size_t framesAvailable = floatsAvailable / fileChannels;
                 size_t framesInThisPass = floatsToResample / fileChannels;
                 
                 size_t inputFramesUsed = 0;
@@ -458,7 +693,7 @@ void AudioFstream::read(char* buffer, size_t bytes)
                 
                 soxr_error_t soxr_err = soxr_process(resampler,
                                                      conversionBuffer + conversionBufferPos, framesInThisPass, &inputFramesUsed,
-                                                     tempFloatBuffer + floatsResampled, framesNeeded - (floatsResampled / fileChannels), &outputFramesGenerated);
+                                                     outputPtr + floatsResampled, framesNeeded - (floatsResampled / fileChannels), &outputFramesGenerated);
                 
                 if (soxr_err) {
                     std::cerr << "SOXR error: " << soxr_strerror(soxr_err) << endl;
@@ -476,71 +711,28 @@ void AudioFstream::read(char* buffer, size_t bytes)
             }
         }
         
-        // Copy resampled floats directly to output (JACK native format)
-        size_t floatsToCopy = std::min(floatsResampled, samplesNeeded);
-        for (size_t i = 0; i < floatsToCopy; i++) {
-            outputPtr[i] = tempFloatBuffer[i];
-            lastBytesRead += 4;  // 4 bytes per float
-        }
-        
-        // Update current position based on how many samples we output
-        currentSamplePos += floatsToCopy;
-        
-        delete[] tempFloatBuffer;
+        // Resampled floats are already in place (JACK native format)
+        lastBytesRead = std::min(floatsResampled, samplesNeeded) * 4;  // 4 bytes per float
         
     } else {
         // No resampling - direct decode and output as float
         while (bytesRemaining > 0 && !eofReached) {
+            // Native PCM converts straight into the caller's buffer
+            // once nothing is left over from a seek, unless remixed
+            if (pcmReader.isOpen() && !swrContext && conversionBufferPos >= conversionBufferUsed) {
+                size_t framesWanted = bytesRemaining / 4 / fileChannels;
+                size_t frames = pcmReader.read(outputPtr, framesWanted);
+                lastBytesRead += frames * fileChannels * 4;
+                if (frames < framesWanted) {
+                    eofReached = true;
+                }
+                break;
+            }
+            
             // Ensure we have decoded float data
             while (conversionBufferPos >= conversionBufferUsed && !eofReached) {
-                if (decodeNextFrame()) {
-                    // Convert decoded frame to float
-                    // Account for libswresample's internal buffering delay
-                    int64_t delay = swr_get_delay(swrContext, fileSampleRate);
-                    
-                    // Calculate max output samples: input samples + buffered samples
-                    int64_t estimated_out_samples = av_rescale_rnd(delay + frame->nb_samples,
-                                                                    fileSampleRate, fileSampleRate,
-                                                                    AV_ROUND_UP);
-                    int max_out_samples = std::min((int64_t)(conversionBufferSize / fileChannels),
-                                                    estimated_out_samples);
-                    
-                    uint8_t* out = (uint8_t*)conversionBuffer;
-                    int out_samples = swr_convert(swrContext, &out, max_out_samples,
-                                                 (const uint8_t**)frame->data, frame->nb_samples);
-                    
-                    if (out_samples < 0) {
-                        std::cerr << "Error converting audio samples: " << getFFmpegError(out_samples) << endl;
-                        errorState = true;
-                        av_frame_unref(frame);
-                        break;
-                    }
-                    
-                    // Debug: log conversion info for first few frames
-                    static int convert_count_no_resample = 0;
-                    if (convert_count_no_resample < 3) {
-                        std::cerr << "Converted " << out_samples << " samples to float (no resample, frame " << convert_count_no_resample << ")" << endl;
-                        convert_count_no_resample++;
-                    }
-                    
-                    conversionBufferUsed = out_samples * fileChannels;
-                    conversionBufferPos = 0;
-                    av_frame_unref(frame);
-                } else {
-                    // EOF - drain remaining samples from swresample
-                    int64_t delay = swr_get_delay(swrContext, fileSampleRate);
-                    if (delay > 0) {
-                        int max_out_samples = conversionBufferSize / fileChannels;
-                        uint8_t* out = (uint8_t*)conversionBuffer;
-                        int out_samples = swr_convert(swrContext, &out, max_out_samples,
-                                                     nullptr, 0);  // NULL input to drain
-                        if (out_samples > 0) {
-                            conversionBufferUsed = out_samples * fileChannels;
-                            conversionBufferPos = 0;
-                            continue;  // Process drained samples
-                        }
-                    }
-                    break;
+                if (!refillConversionBuffer()) {
+                    break;  // EOF or error
                 }
             }
             
@@ -564,12 +756,42 @@ void AudioFstream::read(char* buffer, size_t bytes)
     currentSamplePos += lastBytesRead / 4;  // Track position in samples (4 bytes per float)
 }
 
+////////////////////////////////////////////
+// Drop already converted frames, decoding more as needed
+// Returns how many frames were actually dropped
+////////////////////////////////////////////
+int64_t AudioFstream::discardConvertedFrames(int64_t frames)
+{
+    int64_t discarded = 0;
+    
+    while (discarded < frames) {
+        if (conversionBufferPos >= conversionBufferUsed) {
+            if (eofReached || !refillConversionBuffer()) {
+                break;
+            }
+            continue;
+        }
+        
+        int64_t available = (conversionBufferUsed - conversionBufferPos) / fileChannels;
+        int64_t toDrop = std::min(available, frames - discarded);
+        conversionBufferPos += toDrop * fileChannels;
+        discarded += toDrop;
+    }
+    
+    return discarded;
+}
+
 ////////////////////////////////////////////
 // Seek to position
+//
+// Lands on the exact requested sample: the demuxer is sent to a packet
+// before the target (plus codec pre-roll), the frames decoded ahead of
+// the target are thrown away and, when resampling, libsoxr is primed
+// with real audio so its output lines up with the target too.
 ////////////////////////////////////////////
 void AudioFstream::seekg(long long pos, ios_base::seekdir dir)
 {
-    if (!fileOpen || !fileReader.isReady()) {
+    if (!fileOpen || (!pcmReader.isOpen() && !fileReader.isReady())) {
         return;
     }
     
@@ -585,29 +807,48 @@ void AudioFstream::seekg(long long pos, ios_base::seekdir dir)
         targetBytePos = (long long)getFileSize() + pos;
     }
     
-    // Convert byte position to sample position (32-bit float samples)
-    int64_t targetSamplePos = targetBytePos / 4;
+    if (targetBytePos < 0) {
+        targetBytePos = 0;
+    }
+    
+    // Preloaded: the target frame is an index into memory
+    if (preloaded.load(std::memory_order_acquire)) {
+        int64_t targetSample = targetBytePos / 4 / fileChannels * fileChannels;
+        currentSamplePos = std::min(targetSample, (int64_t)memoryFloats);
+        eofReached = false;
+        return;
+    }
+    
+    // Convert byte position to output frames (32-bit float samples)
+    bool resampling = resamplingEnabled && resampler && targetSampleRate > 0;
+    int64_t targetFrame = targetBytePos / 4 / fileChannels;
     
     // Account for resampling ratio
-    int64_t fileSamplePos = targetSamplePos;
-    if (resamplingEnabled && targetSampleRate > 0) {
-        fileSamplePos = (int64_t)((double)targetSamplePos * fileSampleRate / targetSampleRate);
+    int64_t targetFileFrame = targetFrame;
+    if (resampling) {
+        targetFileFrame = av_rescale(targetFrame, fileSampleRate, targetSampleRate);
     }
     
-    // Convert to time in seconds
-    double timeSeconds = (double)(fileSamplePos / fileChannels) / fileSampleRate;
+    int64_t prerollFrames = seekPrerollFrames + (resampling ? SEEK_RESAMPLE_PREROLL_FRAMES : 0);
+    int64_t seekFrame = std::max((int64_t)0, targetFileFrame - prerollFrames);
     
-    // Seek using MediaFileReader
-    if (!fileReader.seekToTime(timeSeconds, audioStreamIndex, AVSEEK_FLAG_BACKWARD)) {
-        std::cerr << "Seek error" << endl;
-        CuemsLogger::getLogger()->logError("Seek error");
-        errorState = true;
-        return;
+    if (pcmReader.isOpen()) {
+        // Native PCM lands exactly where asked, an offset into the mapping
+        pcmReader.seek(seekFrame);
+    } else {
+        // Seek using MediaFileReader, this lands on a packet at or before seekFrame
+        double timeSeconds = (double)seekFrame / fileSampleRate;
+        if (!fileReader.seekToTime(timeSeconds, audioStreamIndex, AVSEEK_FLAG_BACKWARD)) {
+            std::cerr << "Seek error" << endl;
+            CuemsLogger::getLogger()->logError("Seek error");
+            errorState = true;
+            return;
+        }
+        
+        // Flush decoder buffers
+        audioDecoder.flush();
     }
     
-    // Flush decoder buffers
-    audioDecoder.flush();
-    
     // Reset conversion buffer
     conversionBufferUsed = 0;
     conversionBufferPos = 0;
@@ -615,12 +856,77 @@ void AudioFstream::seekg(long long pos, ios_base::seekdir dir)
     // Clear EOF flag
     eofReached = false;
     
+    // Without resampling there is nothing to discard or prime
+    if (pcmReader.isOpen() && !resampling) {
+        currentSamplePos = targetFrame * fileChannels;
+        return;
+    }
+    
     // Reset resampler state if active (critical for looping/seeking)
-    if (resamplingEnabled && resampler) {
+    if (resampling) {
         soxr_clear(resampler);
+        
+        // Prime at nominal speed so the output frame math below holds
+        if (varispeedEnabled) {
+            double rate = playbackRate;
+            playbackRate = 1.0;
+            applyPlaybackRate(0);
+            playbackRate = rate;
+        }
+    }
+    
+    // Decode the first frame to find out where the demuxer really landed
+    lastFramePts = AV_NOPTS_VALUE;
+    if (!refillConversionBuffer()) {
+        // Past the end, nothing left to play
+        currentSamplePos = targetFrame * fileChannels;
+        return;
+    }
+    
+    int64_t landedFrame = seekFrame;
+    if (lastFramePts != AV_NOPTS_VALUE) {
+        int64_t pts = lastFramePts;
+        if (streamStartTime != AV_NOPTS_VALUE) {
+            pts -= streamStartTime;
+        }
+        landedFrame = av_rescale_q(pts, streamTimeBase, (AVRational){1, (int)fileSampleRate});
+    }
+    
+    if (!resampling) {
+        // Drop everything decoded ahead of the target
+        int64_t surplus = targetFileFrame - landedFrame;
+        if (surplus > 0) {
+            landedFrame += discardConvertedFrames(surplus);
+        }
+        currentSamplePos = landedFrame * fileChannels;
+        return;
+    }
+    
+    // Keep only SEEK_RESAMPLE_PREROLL_FRAMES of input ahead of the target
+    // for libsoxr, a coarse demuxer seek may have landed far earlier
+    int64_t surplus = targetFileFrame - SEEK_RESAMPLE_PREROLL_FRAMES - landedFrame;
+    if (surplus > 0) {
+        landedFrame += discardConvertedFrames(surplus);
+    }
+    
+    // Run the rest of the pre-roll through libsoxr and drop its output,
+    // this both primes the filter and lands on the exact output frame
+    int64_t outputFrame = av_rescale_rnd(landedFrame, targetSampleRate, fileSampleRate, AV_ROUND_NEAR_INF);
+    while (outputFrame < targetFrame && !eofReached && !errorState) {
+        size_t frames = std::min((int64_t)seekScratchFrames, targetFrame - outputFrame);
+        read((char*)seekScratch, frames * fileChannels * 4);
+        if (lastBytesRead <= 0) {
+            break;
+        }
+        outputFrame += lastBytesRead / 4 / fileChannels;
+    }
+    
+    lastBytesRead = 0;
+    currentSamplePos = outputFrame * fileChannels;
+    
+    if (varispeedEnabled) {
+        applyPlaybackRate(0);
     }
-    // Update current position
-    currentSamplePos = targetSamplePos;
 }
 
 ////////////////////////////////////////////
@@ -682,6 +988,14 @@ void AudioFstream::cleanupFFmpeg()
         delete[] conversionBuffer;
         conversionBuffer = nullptr;
     }
+    if (seekScratch) {
+        delete[] seekScratch;
+        seekScratch = nullptr;
+    }
+    if (remixBuffer) {
+        delete[] remixBuffer;
+        remixBuffer = nullptr;
+    }
     
     // Close cuems-mediadecoder components
     audioDecoder.close();
@@ -691,6 +1005,10 @@ void AudioFstream::cleanupFFmpeg()
     conversionBufferSize = 0;
     conversionBufferUsed = 0;
     conversionBufferPos = 0;
+    seekScratchFrames = 0;
+    lastFramePts = AV_NOPTS_VALUE;
+    streamStartTime = AV_NOPTS_VALUE;
+    seekPrerollFrames = 0;
 }
 
 ////////////////////////////////////////////
@@ -698,12 +1016,17 @@ void AudioFstream::cleanupFFmpeg()
 ////////////////////////////////////////////
 void AudioFstream::close()
 {
+    // The cache thread reads our settings, stop it first
+    dropMemory();
+    
     cleanupFFmpeg();
     cleanupResampler();
+    pcmReader.close();
     
     fileOpen = false;
     eofReached = false;
     errorState = false;
+    sourceChannels = 0;
     fileChannels = 0;
     fileSampleRate = 0;
     totalSamples = 0;
@@ -712,11 +1035,36 @@ void AudioFstream::close()
     lastBytesRead = 0;
 }
 
+////////////////////////////////////////////
+// Back to decoding: stop any rendering in background and release the
+// preloaded data, cache mapping or shared segment
+////////////////////////////////////////////
+void AudioFstream::dropMemory()
+{
+    if (cacheThread.joinable()) {
+        cacheCancel.store(true);
+        cacheThread.join();
+        cacheCancel.store(false);
+    }
+    sharedSegment.detach();
+    
+    preloaded.store(false, std::memory_order_release);
+    memoryData = nullptr;
+    memoryFloats = 0;
+    cacheMapping.close();
+    std::vector<float>().swap(preloadData);
+}
+
 ////////////////////////////////////////////
 // File information accessors
 ////////////////////////////////////////////
 unsigned long long AudioFstream::getFileSize() const
 {
+    // Preloaded, the exact decoded length
+    if (preloaded.load(std::memory_order_acquire)) {
+        return memoryFloats * 4;
+    }
+    
     // If resampling is enabled, return the effective output size at target sample rate
     // This ensures boundary checks compare values at the same sample rate
     if (resamplingEnabled && targetSampleRate > 0 && fileSampleRate > 0 && totalSamples > 0) {
@@ -759,14 +1107,388 @@ void AudioFstream::setTargetSampleRate(unsigned int rate)
         return;  // Will initialize when file is opened
     }
     
+    // Memory holds the old rate, decode again
+    if (preloaded.load() || cacheThread.joinable()) {
+        open(filePath, fileMode);
+        return;
+    }
+    
     // Reinitialize resampler if needed
-    if (targetSampleRate > 0 && targetSampleRate != fileSampleRate) {
+    if (resamplerNeeded()) {
         initializeResampler();
     } else {
         // No resampling needed
         cleanupResampler();
         resamplingEnabled = false;
     }
+    
+    preloadFile();
+}
+
+////////////////////////////////////////////
+// Enable or disable the variable-rate resampler
+////////////////////////////////////////////
+void AudioFstream::setVarispeed(bool enable)
+{
+    if (varispeedEnabled == enable) {
+        return;
+    }
+    
+    varispeedEnabled = enable;
+    playbackRate = 1.0;
+    
+    if (!fileOpen) {
+        return;  // Will initialize when file is opened
+    }
+    
+    // Varispeed needs the live resampler, playing from memory depends on it
+    if (preloaded.load() || cacheThread.joinable() || memoryWanted()) {
+        open(filePath, fileMode);
+        return;
+    }
+    
+    if (resamplerNeeded()) {
+        initializeResampler();
+    } else {
+        cleanupResampler();
+    }
+}
+
+////////////////////////////////////////////
+// Set playback rate (varispeed only)
+////////////////////////////////////////////
+void AudioFstream::setPlaybackRate(double rate)
+{
+    if (!varispeedEnabled) {
+        return;
+    }
+    
+    // Keep inside what the resampler was built for
+    rate = std::min(std::max(rate, 1.0 / VARISPEED_MAX_RATIO), VARISPEED_MAX_RATIO);
+    if (rate == playbackRate) {
+        return;
+    }
+    
+    playbackRate = rate;
+    
+    // Glide to the new ratio over a short stretch to avoid zipper noise
+    applyPlaybackRate(256);
+}
+
+////////////////////////////////////////////
+// Get playback rate
+////////////////////////////////////////////
+double AudioFstream::getPlaybackRate() const
+{
+    return playbackRate;
+}
+
+////////////////////////////////////////////
+// Preload configuration
+////////////////////////////////////////////
+void AudioFstream::setPreload(bool force, double maxSeconds)
+{
+    preloadForced = force;
+    preloadMaxSeconds = std::max(maxSeconds, 0.0);
+    
+    preloadFile();
+}
+
+bool AudioFstream::isPreloaded() const
+{
+    return preloaded.load(std::memory_order_acquire);
+}
+
+////////////////////////////////////////////
+// Decoded PCM cache directory, empty disables it
+////////////////////////////////////////////
+void AudioFstream::setCacheDirectory(const string& directory)
+{
+    cacheDirectory = directory;
+    
+    preloadFile();
+}
+
+////////////////////////////////////////////
+// Node wide shared renditions
+////////////////////////////////////////////
+void AudioFstream::setSharedMemory(bool enable)
+{
+    sharedMemory = enable;
+    
+    preloadFile();
+}
+
+////////////////////////////////////////////
+// Native PCM reader, off forces FFmpeg for every file
+////////////////////////////////////////////
+void AudioFstream::setNativePcm(bool enable)
+{
+    nativePcm = enable;
+}
+
+bool AudioFstream::preloadWanted() const
+{
+    if (!fileOpen || varispeedEnabled || targetSampleRate == 0) {
+        return false;
+    }
+    
+    if (preloadForced) {
+        return true;
+    }
+    
+    // Unknown lengths are never preloaded automatically
+    return preloadMaxSeconds > 0 && totalSamples > 0 &&
+           totalSamples <= preloadMaxSeconds * fileSampleRate;
+}
+
+bool AudioFstream::memoryWanted() const
+{
+    if (!fileOpen || varispeedEnabled || targetSampleRate == 0) {
+        return false;
+    }
+    
+    return !cacheDirectory.empty() || sharedMemory || preloadWanted();
+}
+
+////////////////////////////////////////////
+// Move playback to memory: the cached rendition if there is one, else
+// decode the whole file now (preload) or into the cache in background
+////////////////////////////////////////////
+void AudioFstream::preloadFile()
+{
+    if (preloaded.load() || cacheThread.joinable() || !memoryWanted()) {
+        return;
+    }
+    
+    string key;
+    if (!cacheDirectory.empty() || sharedMemory) {
+        key = PcmCache::keyFor(filePath, targetSampleRate, fileChannels, qualityName);
+    }
+    
+    if (!cacheDirectory.empty() && !key.empty() && mapCache(key)) {
+        return;
+    }
+    
+    // Rendered once for all the players of the node, by whoever comes first
+    if (sharedMemory && !key.empty() &&
+        sharedSegment.attach(key, fileChannels, targetSampleRate, getFileSize() / 4) != SharedPcm::NONE) {
+        if (preloadWanted()) {
+            renderShared(key);
+        } else {
+            cacheThread = std::thread(&AudioFstream::renderShared, this, key);
+        }
+        return;
+    }
+    
+    if (!preloadWanted()) {
+        if (!cacheDirectory.empty() && !key.empty()) {
+            cacheThread = std::thread(&AudioFstream::renderCache, this, key);
+        }
+        return;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    AudioFstream source;
+    if (!openSource(source)) {
+        CuemsLogger::getLogger()->logWarning("Preload: could not open " + filePath + ", decoding while playing");
+        return;
+    }
+    
+    std::vector<float> data;
+    data.reserve(source.getFileSize() / 4 + PRELOAD_CHUNK_FRAMES * fileChannels);
+    
+    size_t chunkFloats = PRELOAD_CHUNK_FRAMES * fileChannels;
+    size_t got = 0;
+    do {
+        size_t used = data.size();
+        data.resize(used + chunkFloats);
+        source.read((char*)(data.data() + used), chunkFloats * 4);
+        got = source.gcount() / 4;
+        data.resize(used + got);
+    } while (got == chunkFloats && !source.bad());
+    
+    if (source.bad()) {
+        CuemsLogger::getLogger()->logWarning("Preload: decoding error in " + filePath + ", decoding while playing");
+        return;
+    }
+    
+    // Next time it is only a mapping
+    if (!cacheDirectory.empty() && !key.empty()) {
+        PcmCache::Writer writer;
+        if (!writer.open(PcmCache::pathFor(cacheDirectory, key), fileChannels, targetSampleRate) ||
+            !writer.write(data.data(), data.size()) || !writer.commit()) {
+            CuemsLogger::getLogger()->logWarning("PCM cache: could not write to " + cacheDirectory);
+        }
+    }
+    
+    preloadData.swap(data);
+    memoryData = preloadData.data();
+    memoryFloats = preloadData.size();
+    preloaded.store(true, std::memory_order_release);
+    
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CuemsLogger::getLogger()->logOK("Preloaded " + std::to_string(preloadData.size() / fileChannels) + " frames (" +
+                                    std::to_string(preloadData.size() * 4 / 1024) + " KB) in " +
+                                    std::to_string((int)ms) + " ms");
+}
+
+////////////////////////////////////////////
+// Open a decoder of our own on the same file and output format,
+// the reading thread may still be using this one
+////////////////////////////////////////////
+bool AudioFstream::openSource(AudioFstream& source) const
+{
+    source.qualitySpec = qualitySpec;
+    source.nativePcm = nativePcm;
+    source.setTargetChannels(targetChannels);
+    source.setTargetSampleRate(targetSampleRate);
+    source.open(filePath, fileMode);
+    
+    return source.good();
+}
+
+////////////////////////////////////////////
+// Play from the cached rendition, if present and valid
+////////////////////////////////////////////
+bool AudioFstream::mapCache(const string& key)
+{
+    string path = PcmCache::pathFor(cacheDirectory, key);
+    if (!cacheMapping.open(path, fileChannels, targetSampleRate)) {
+        return false;
+    }
+    
+    memoryData = cacheMapping.data();
+    memoryFloats = cacheMapping.floats();
+    preloaded.store(true, std::memory_order_release);
+    
+    CuemsLogger::getLogger()->logOK("Playing from PCM cache: " + path);
+    return true;
+}
+
+////////////////////////////////////////////
+// Cache thread: decode the whole file into the cache, then switch
+// playback over to the mapping. Stopped by close().
+////////////////////////////////////////////
+void AudioFstream::renderCache(const string key)
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    AudioFstream source;
+    if (!openSource(source)) {
+        CuemsLogger::getLogger()->logWarning("PCM cache: could not open " + filePath);
+        return;
+    }
+    
+    PcmCache::Writer writer;
+    if (!writer.open(PcmCache::pathFor(cacheDirectory, key), fileChannels, targetSampleRate)) {
+        CuemsLogger::getLogger()->logWarning("PCM cache: could not write to " + cacheDirectory);
+        return;
+    }
+    
+    std::vector<float> chunk(PRELOAD_CHUNK_FRAMES * fileChannels);
+    size_t got = 0;
+    do {
+        source.read((char*)chunk.data(), chunk.size() * 4);
+        got = source.gcount() / 4;
+        if (!writer.write(chunk.data(), got)) {
+            break;
+        }
+    } while (got == chunk.size() && !source.bad() && !cacheCancel.load());
+    
+    if (cacheCancel.load() || source.bad() || !writer.commit()) {
+        writer.abort();
+        return;
+    }
+    
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CuemsLogger::getLogger()->logInfo("PCM cache: rendered " + filePath + " in " + std::to_string((int)ms) + " ms");
+    
+    mapCache(key);
+}
+
+////////////////////////////////////////////
+// Shared memory rendition: render it if we created the segment, else
+// wait for the player that did. Runs on the cache thread, or right away
+// when preloading. Stopped by close().
+////////////////////////////////////////////
+void AudioFstream::renderShared(const string key)
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    if (sharedSegment.getRole() == SharedPcm::CONSUMER) {
+        if (!sharedSegment.waitReady(cacheCancel)) {
+            CuemsLogger::getLogger()->logWarning("Shared PCM: no rendition of " + filePath + " from other players, decoding");
+            sharedSegment.detach();
+            return;
+        }
+    } else {
+        AudioFstream source;
+        if (!openSource(source)) {
+            CuemsLogger::getLogger()->logWarning("Shared PCM: could not open " + filePath);
+            sharedSegment.detach();
+            return;
+        }
+        
+        // Also keep it on disk if there is a cache
+        PcmCache::Writer writer;
+        bool caching = !cacheDirectory.empty() &&
+                       writer.open(PcmCache::pathFor(cacheDirectory, key), fileChannels, targetSampleRate);
+        
+        std::vector<float> chunk(PRELOAD_CHUNK_FRAMES * fileChannels);
+        size_t got = 0;
+        bool written = true;
+        do {
+            source.read((char*)chunk.data(), chunk.size() * 4);
+            got = source.gcount() / 4;
+            written = sharedSegment.write(chunk.data(), got);
+            if (caching) {
+                caching = writer.write(chunk.data(), got);
+            }
+        } while (written && got == chunk.size() && !source.bad() && !cacheCancel.load());
+        
+        if (!written || cacheCancel.load() || source.bad() || !sharedSegment.publish()) {
+            CuemsLogger::getLogger()->logWarning("Shared PCM: could not render " + filePath + ", decoding");
+            sharedSegment.detach();
+            return;
+        }
+        
+        if (caching) {
+            writer.commit();
+        }
+    }
+    
+    memoryData = sharedSegment.data();
+    memoryFloats = sharedSegment.floats();
+    preloaded.store(true, std::memory_order_release);
+    
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CuemsLogger::getLogger()->logOK(string("Shared PCM: ") +
+                                    (sharedSegment.getRole() == SharedPcm::PRODUCER ? "rendered " : "mapped ") +
+                                    SharedPcm::nameFor(key) + " after " + std::to_string((int)ms) + " ms");
+}
+
+////////////////////////////////////////////
+// Is a resampler needed at all?
+////////////////////////////////////////////
+bool AudioFstream::resamplerNeeded() const
+{
+    return targetSampleRate > 0 && (targetSampleRate != fileSampleRate || varispeedEnabled);
+}
+
+////////////////////////////////////////////
+// Push the playback rate to the variable-rate resampler
+////////////////////////////////////////////
+void AudioFstream::applyPlaybackRate(size_t slewFrames)
+{
+    if (!resampler || !varispeedEnabled) {
+        return;
+    }
+    
+    // soxr io ratio is input/output: playing faster consumes more input
+    double ioRatio = (double)fileSampleRate / targetSampleRate * playbackRate;
+    soxr_set_io_ratio(resampler, ioRatio, slewFrames);
 }
 
 ////////////////////////////////////////////
@@ -775,6 +1497,7 @@ void AudioFstream::setTargetSampleRate(unsigned int rate)
 void AudioFstream::setResampleQuality(const string& quality)
 {
     qualitySpec = parseQualityString(quality);
+    qualityName = quality;  // Part of the PCM cache key
     
     // If resampler is already initialized, recreate it with new quality
     if (resampler != nullptr) {
@@ -808,7 +1531,7 @@ void AudioFstream::initializeResampler()
 {
     cleanupResampler();
     
-    if (targetSampleRate == 0 || targetSampleRate == fileSampleRate) {
+    if (!resamplerNeeded()) {
         resamplingEnabled = false;
         return;
     }
@@ -816,8 +1539,18 @@ void AudioFstream::initializeResampler()
     soxr_error_t error;
     soxr_io_spec_t io_spec = soxr_io_spec(SOXR_FLOAT32_I, SOXR_FLOAT32_I);
     
-    resampler = soxr_create(fileSampleRate, targetSampleRate, fileChannels,
-                           &error, &io_spec, &qualitySpec, nullptr);
+    if (varispeedEnabled) {
+        // Variable-rate mode: soxr is created with the largest input/output
+        // ratio it will see, the actual ratio is then set on the fly
+        soxr_quality_spec_t vrSpec = qualitySpec;
+        vrSpec.flags |= SOXR_VR;
+        double maxRatio = (double)fileSampleRate / targetSampleRate * VARISPEED_MAX_RATIO;
+        resampler = soxr_create(maxRatio, 1, fileChannels,
+                               &error, &io_spec, &vrSpec, nullptr);
+    } else {
+        resampler = soxr_create(fileSampleRate, targetSampleRate, fileChannels,
+                               &error, &io_spec, &qualitySpec, nullptr);
+    }
     
     if (error || !resampler) {
         std::cerr << "Failed to create resampler: " << (error ? error : "unknown error") << endl;
@@ -828,11 +1561,12 @@ void AudioFstream::initializeResampler()
     
     resamplingEnabled = true;
     
-    // Allocate resampling buffers
-    // Increase buffer size for formats like DTS that may need more headroom
-    resampleBufferSize = 16384 * fileChannels;  // 16384 frames worth (larger for complex codecs)
-    resampleInputBuffer = new float[resampleBufferSize];
-    resampleOutputBuffer = new float[resampleBufferSize];
+    if (varispeedEnabled) {
+        applyPlaybackRate(0);
+    }
+    
+    // No resampling buffers: input comes from conversionBuffer and
+    // output goes straight to the caller's buffer in read()
     
     CuemsLogger::getLogger()->logOK("Resampler initialized: " + std::to_string(fileSampleRate) + 
                                     " Hz -> " + std::to_string(targetSampleRate) + " Hz");
@@ -847,14 +1581,5 @@ void AudioFstream::cleanupResampler()
         soxr_delete(resampler);
         resampler = nullptr;
     }
-    if (resampleInputBuffer) {
-        delete[] resampleInputBuffer;
-        resampleInputBuffer = nullptr;
-    }
-    if (resampleOutputBuffer) {
-        delete[] resampleOutputBuffer;
-        resampleOutputBuffer = nullptr;
-    }
-    resampleBufferSize = 0;
     resamplingEnabled = false;
 }
@@ -38,9 +38,11 @@
 #define AUDIOFSTREAM_H
 
 #include <iostream>
+#include <atomic>
 #include <vector>
 #include <iomanip>
 #include <string>
+#include <thread>
 #include <soxr.h>
 
 #include "cuems_mediadecoder/MediaFileReader.h"
@@ -54,6 +56,30 @@ extern "C" {
 
 #include "cuemslogger.h"
 #include "cuems_errors.h"
+#include "pcmcache.h"
+#include "sharedpcm.h"
+#include "pcmreader.h"
+
+// Extra input frames decoded before the target when resampling, so the
+// soxr filter is settled by the time the requested sample comes out
+#ifndef SEEK_RESAMPLE_PREROLL_FRAMES
+#define SEEK_RESAMPLE_PREROLL_FRAMES 1024
+#endif
+
+// Largest playback rate deviation the variable-rate resampler is built for
+#ifndef VARISPEED_MAX_RATIO
+#define VARISPEED_MAX_RATIO 1.05
+#endif
+
+// Files up to this long are decoded into memory by default (player level)
+#ifndef PRELOAD_MAX_SECONDS
+#define PRELOAD_MAX_SECONDS 30.0
+#endif
+
+// Frames per read while decoding a whole file into memory
+#ifndef PRELOAD_CHUNK_FRAMES
+#define PRELOAD_CHUNK_FRAMES 4096
+#endif
 
 using namespace std;
 
@@ -79,7 +105,40 @@ class AudioFstream
         // Methods for resampling
         void setTargetSampleRate(unsigned int rate);
         void setResampleQuality(const string& quality);
-        void setTargetChannels(unsigned int channels);  // Set target channel count for downmixing
+        // Output channel count, 0 for the file's own. On an open file only
+        // the conversion is rebuilt, the demuxer and codec stay open and
+        // the read position is kept. Memory renditions are made again.
+        void setTargetChannels(unsigned int channels);
+
+        // Varispeed: a variable-rate resampler is kept even at matching
+        // sample rates so playback can be nudged to follow a clock.
+        // setPlaybackRate must be called from the thread that reads.
+        void setVarispeed(bool enable);
+        void setPlaybackRate(double rate);  // 1.0 = nominal speed
+        double getPlaybackRate() const;
+
+        // Preload: the whole file is decoded and resampled once into memory,
+        // after which read() is a copy and seekg() is pointer arithmetic.
+        // Done when forced or for files up to maxSeconds long (0 = never),
+        // as soon as the target sample rate is known. Not with varispeed.
+        // A second decoder does the work, the reading thread switches to
+        // memory on its next read.
+        void setPreload(bool force, double maxSeconds);
+        bool isPreloaded() const;
+
+        // Decoded PCM cache: with a directory set, any file is played from
+        // a memory mapped float32 rendition at the target rate and layout.
+        // Missing renditions are written on a background thread (or right
+        // away when preloading) while playback goes on decoding.
+        void setCacheDirectory(const string& directory);
+
+        // Shared memory: renditions are made once per node and mapped by
+        // every player process that plays the same file and format
+        void setSharedMemory(bool enable);
+
+        // Native PCM: uncompressed files are read without FFmpeg, on by
+        // default. Takes effect on the next open().
+        void setNativePcm(bool enable);
         
         // File information accessors (for compatibility with audioplayer.cpp)
         unsigned long long getFileSize() const;
@@ -95,6 +154,12 @@ class AudioFstream
         AVFrame* frame;
         SwrContext* swrContext;
         int audioStreamIndex;
+
+        // Uncompressed PCM (WAV, RF64, W64, AIFF) is read from a memory
+        // mapping instead, see pcmreader.h. swrContext then only remixes.
+        PcmReader pcmReader;
+        bool nativePcm;
+        float* remixBuffer;             // Native frames in the file's layout
         
         // File state
         bool fileOpen;
@@ -103,12 +168,22 @@ class AudioFstream
         streamsize lastBytesRead;
         
         // Audio properties
-        unsigned int fileChannels;
+        unsigned int sourceChannels;    // As decoded, before mixing to targetChannels
+        unsigned int fileChannels;      // As read, after mixing
         unsigned int fileSampleRate;
         unsigned int fileBitsPerSample;
         int64_t totalSamples;
         unsigned long long fileSize;  // For boundary checks (in bytes, for 32-bit float output)
         int64_t currentSamplePos;
+
+        // Seek state: where decoded frames sit in the stream, so seekg can
+        // land on the exact requested sample instead of the packet boundary
+        int64_t lastFramePts;           // best effort pts of the last decoded frame
+        AVRational streamTimeBase;
+        int64_t streamStartTime;        // in streamTimeBase units, AV_NOPTS_VALUE if unknown
+        int64_t seekPrerollFrames;      // codec pre-roll decoded before the target
+        float* seekScratch;             // Discard buffer for resampled pre-roll
+        size_t seekScratchFrames;
         
         // Format conversion buffer (FFmpeg decoded → float for libsoxr)
         float* conversionBuffer;
@@ -116,22 +191,55 @@ class AudioFstream
         size_t conversionBufferUsed;  // floats currently in buffer
         size_t conversionBufferPos;   // read position in buffer
 
+        // Preloaded output, interleaved floats at the target rate
+        string filePath;
+        ios_base::openmode fileMode;
+        bool preloadForced;
+        double preloadMaxSeconds;
+        std::vector<float> preloadData;
+        std::atomic<bool> preloaded;
+        const float* memoryData;        // preloadData or the cache mapping
+        size_t memoryFloats;
+
+        // Decoded PCM cache
+        string cacheDirectory;
+        string qualityName;
+        PcmCache::Mapping cacheMapping;
+        std::thread cacheThread;
+        std::atomic<bool> cacheCancel;
+        bool sharedMemory;
+        SharedPcm sharedSegment;
+
         // Resampling members (libsoxr - unchanged)
         unsigned int targetSampleRate;
         unsigned int targetChannels;  // Target channel count for downmixing (0 = use file's channels)
         soxr_t resampler;
         bool resamplingEnabled;
         soxr_quality_spec_t qualitySpec;
-        float* resampleInputBuffer;
-        float* resampleOutputBuffer;
-        size_t resampleBufferSize;
+        bool varispeedEnabled;
+        double playbackRate;
 
         // Helper methods
+        bool openNative();
+        void completeOpen(const string& formatName);
+        bool resamplerNeeded() const;
+        void applyPlaybackRate(size_t slewFrames);
+        bool preloadWanted() const;
+        bool memoryWanted() const;
+        void preloadFile();
+        bool openSource(AudioFstream& source) const;
+        void dropMemory();
+        bool mapCache(const string& key);
+        void renderCache(const string key);
+        void renderShared(const string key);
         void initializeResampler();
         void cleanupResampler();
+        bool setupConversion(unsigned int outputChannels);
         void cleanupFFmpeg();
         soxr_quality_spec_t parseQualityString(const string& quality);
         bool decodeNextFrame();  // Decode one frame from FFmpeg
+        bool refillConversionBuffer();  // Decode and convert into conversionBuffer
+        int64_t discardConvertedFrames(int64_t frames);  // Drop frames before the resampler
         string getFFmpegError(int errnum);  // Translate FFmpeg error codes
 };
 
@@ -36,6 +36,12 @@
 //////////////////////////////////////////////////////////
 
 #include "audioplayer.h"
+#include <sstream>
+#include <fstream>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/ip/UdpSocket.h>
 
 ////////////////////////////////////////////
 // Initializing static class members
@@ -59,21 +65,53 @@ AudioPlayer::AudioPlayer(   int port,
                             unsigned int sRate,
                             RtAudio::Api audioApi,
                             const string &resampleQuality,
-                            long explicitLatencyMs )
+                            long explicitLatencyMs,
+                            const bool streamingFlag,
+                            const bool varispeedFlag,
+                            unsigned int periodFrames,
+                            const bool preloadFlag,
+                            double preloadMaxSeconds,
+                            const string &cacheDirectory,
+                            const bool sharedMemoryFlag,
+                            unsigned int voiceCount,
+                            unsigned int decoderThreads,
+                            const std::vector<int>& decoderCpus,
+                            const bool exponentialRampFlag,
+                            unsigned int outputPorts,
+                            const string &routeSpec,
+                            const bool fastStartFlag )
                             :   // Members initialization
                             OscReceiver(port, oscRoute.c_str()),
-                            mtcReceiver(MTCRECV_DEFAULT_API, client_name),
+                            mtcReceiver(audioApi == RtAudio::Api::RTAUDIO_DUMMY ? RtMidi::Api::RTMIDI_DUMMY : MTCRECV_DEFAULT_API,
+                                        client_name),
                             audioPath(filePath),
                             nChannels(numberOfChannels),
+                            outputChannels(numberOfChannels),
                             sampleRate(sRate),
+                            bufferFrames(periodFrames),
                             deviceName(deviceName),
                             m_explicitLatencyMs(explicitLatencyMs),
                             audio(audioApi),
-                            audioFile(filePath.c_str()),  // Open file to check format
+                            audioFile(fastStartFlag && audioApi != RtAudio::Api::RTAUDIO_DUMMY ?
+                                      "" : filePath.c_str()),  // Open file to check format, in parallel with the device lookup on fast start
+                            streamer(audioFile),
+                            cueStreamer(cueFile),
+                            playingFile(&audioFile),
+                            playingStreamer(&streamer),
                             endWaitTime(finalWait),
                             stopOnMTCLost(stopOnLostFlag),
-                            followingMtc(mtcFollowFlag)
+                            followingMtc(mtcFollowFlag),
+                            streamingMode(streamingFlag),
+                            streamingWanted(streamingFlag),
+                            varispeedMode(varispeedFlag),
+                            nullBackend(audioApi == RtAudio::Api::RTAUDIO_DUMMY)
  {
+    // Receivers and, unless on fast start, the file are open by now
+    startupTrace.mark( "members" );
+
+    // main() sleeps on it until the end of play
+    endOfPlayEvent = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+
     // Enable network-tolerant MTC timeouts (for rtpmidid / MTC over network)
     mtcReceiver.setNetworkMode(true);
 
@@ -88,6 +126,91 @@ AudioPlayer::AudioPlayer(   int port,
     // Set resample quality before opening audio stream
     audioFile.setResampleQuality(resampleQuality);
 
+    // Short files (or all with preloadFlag) are decoded into memory once
+    // the output rate is known, any file is played from the PCM cache
+    // and / or from a rendition shared with the other players of the node
+    audioFile.setCacheDirectory(cacheDirectory);
+    audioFile.setSharedMemory(sharedMemoryFlag);
+    audioFile.setPreload(preloadFlag, preloadMaxSeconds);
+
+    // Cues loaded later with /preload are read the same way
+    cueFile.setResampleQuality(resampleQuality);
+    cueFile.setCacheDirectory(cacheDirectory);
+    cueFile.setSharedMemory(sharedMemoryFlag);
+    cueFile.setPreload(preloadFlag, preloadMaxSeconds);
+
+    // Streamers decode in a shared pool of workers instead of a thread each
+    if ( decoderThreads > 0 ) {
+        decoderPool.reset( new DecoderPool( decoderThreads, decoderCpus ) );
+        streamer.setPool( decoderPool.get() );
+        cueStreamer.setPool( decoderPool.get() );
+    }
+
+    // Voices are all made now, the audio thread walks a fixed list
+    voiceCount = std::min( voiceCount, (unsigned int) MAX_VOICES );
+    for ( unsigned int i = 0; i < voiceCount; i++ ) {
+        voices.emplace_back( new Voice() );
+        voices.back()->setDecoderPool( decoderPool.get() );
+        voices.back()->audioFile.setResampleQuality(resampleQuality);
+        voices.back()->audioFile.setCacheDirectory(cacheDirectory);
+        voices.back()->audioFile.setSharedMemory(sharedMemoryFlag);
+        voices.back()->audioFile.setPreload(preloadFlag, preloadMaxSeconds);
+    }
+
+    // Routing: the file keeps its own channels and the matrix spreads them
+    // over as many output ports as asked for, or as the routes reach
+    if ( outputPorts > 0 || !routeSpec.empty() ) {
+        if ( !routeSpec.empty() ) {
+            initialRoutes = RoutingMatrix::parseRoutes( routeSpec );
+        }
+
+        outputChannels = outputPorts;
+        if ( outputChannels == 0 ) {
+            for ( const auto& route : initialRoutes ) {
+                outputChannels = std::max( outputChannels, route.output + 1 );
+            }
+        }
+        outputChannels = std::min( outputChannels, (unsigned int) ROUTING_MAX_CHANNELS );
+        routingMode = true;
+    }
+
+    //////////////////////////////////////////////////////////
+    // Check for audio devices, now that we know how many outputs we need.
+    // On fast start the file is probed meanwhile, JACK answers slowly.
+    int audioDeviceId = -1;
+    if ( !nullBackend ) {
+        std::thread fileOpener;
+        if ( fastStartFlag ) {
+            fileOpener = std::thread( [this] { audioFile.open( audioPath, ios::binary | ios::in ); } );
+        }
+
+        audioDeviceId = findOutputDevice( fastStartFlag );
+
+        if ( fileOpener.joinable() ) {
+            fileOpener.join();
+        }
+        startupTrace.mark( "devices" );
+    }
+
+    // Routing, continued: the file's own channels
+    if ( routingMode ) {
+        if ( audioFile.good() ) {
+            nChannels = std::min( audioFile.getChannels(), (unsigned int) ROUTING_MAX_CHANNELS );
+        }
+
+        // Files loaded later are mixed to this same layout
+        audioFile.setTargetChannels( nChannels );
+
+        routingMatrix.setSize( nChannels, outputChannels );
+        if ( !initialRoutes.empty() ) {
+            routingMatrix.setRoutes( initialRoutes );
+        }
+        routeBuffer.assign( (size_t) std::max( bufferFrames, (unsigned int) ROUTING_MAX_FRAMES ) * nChannels, 0.0f );
+
+        CuemsLogger::getLogger()->logInfo( "Routing " + std::to_string( nChannels ) + " file channels to " +
+            std::to_string( outputChannels ) + " outputs, " + RoutingMatrix::getKernelName() + " kernel" );
+    }
+
     // Audio frame size calc (will be updated with actual JACK sample rate later)
     audioFrameSize = nChannels * headStep;
     audioSecondSize = sampleRate * audioFrameSize;
@@ -104,140 +227,27 @@ AudioPlayer::AudioPlayer(   int port,
     if ( (playHead + headOffset.load()) >= 0 )
         audioFile.seekg( playHead + headOffset.load() , ios_base::beg );
 
+    // MTC arrivals are timestamped against our own sample clock
+    mtcClock.setSampleRate(sampleRate);
+
     // Per channel volume param to process audio
-    volumeMaster = new float[nChannels];
-    for ( unsigned short int i = 0; i < nChannels; i++ ) {
-        volumeMaster[i] = 1.0;
-    }
+    gainStage.setRamp( exponentialRampFlag ? GainStage::RAMP_EXPONENTIAL : GainStage::RAMP_LINEAR );
+    CuemsLogger::getLogger()->logInfo( string( "Gain stage kernel: " ) + GainStage::getKernelName() );
 
     // Per channel process buffer (32-bit float for JACK)
     intermediate = new float[nChannels];
 
-
-    //////////////////////////////////////////////////////////
-    // Setting our audio stream parameters
-    // Check for audio devices
-    int audioDeviceId = -1;
-    try {
-        int deviceCount = audio.getDeviceCount();
-        if ( deviceCount == 0 ) {
-            std::string str = "No audio devices found on API:" + 
-                std::to_string(audio.getCurrentApi());
-
-            std::cerr << str << endl;
-            CuemsLogger::getLogger()->logError(str);
-
-            str = "Maybe JACK NOT RUNNING!!!";
-
-            std::cerr << str << endl;
-            CuemsLogger::getLogger()->logError(str);
-
-            exit( CUEMS_EXIT_AUDIO_DEVICE_ERR );
-        }
-        else {
-            // Helper function to check if a device is suitable
-            auto isDeviceSuitable = [&](int deviceId) -> bool {
-                try {
-                    RtAudio::DeviceInfo info = audio.getDeviceInfo(deviceId);
-                    // Check if device is probed successfully and has enough output channels
-                    return info.probed && 
-                           info.outputChannels >= nChannels;
-                } catch (...) {
-                    return false;
-                }
-            };
-
-            // First, try to find device by name (if specified)
-            bool found = false;
-            if (!deviceName.empty()) {
-                for(int i = 0; i < deviceCount; ++i) {
-                    try {
-                        RtAudio::DeviceInfo info = audio.getDeviceInfo(i);
-                        if (info.name == deviceName && isDeviceSuitable(i)) {
-                            audioDeviceId = i;
-                            found = true;
-                            CuemsLogger::getLogger()->logInfo("Found specified device: " + deviceName);
-                            break;
-                        }
-                    } catch (...) {
-                        // Skip devices that fail to probe
-                        continue;
-                    }
-                }
-            }
-
-            // If device name not found or not suitable, find any suitable output device
-            if (!found) {
-                // Try default output device first
-                int defaultDevice = audio.getDefaultOutputDevice();
-                if (defaultDevice >= 0 && defaultDevice < deviceCount && isDeviceSuitable(defaultDevice)) {
-                    audioDeviceId = defaultDevice;
-                    found = true;
-                    CuemsLogger::getLogger()->logInfo("Using default output device");
-                } else {
-                    // Iterate through all devices to find a suitable one
-                    for(int i = 0; i < deviceCount; ++i) {
-                        if (isDeviceSuitable(i)) {
-                            audioDeviceId = i;
-                            found = true;
-                            try {
-                                RtAudio::DeviceInfo info = audio.getDeviceInfo(i);
-                                CuemsLogger::getLogger()->logInfo("Using device: " + info.name + 
-                                    " (" + std::to_string(info.outputChannels) + " output channels)");
-                            } catch (...) {
-                                CuemsLogger::getLogger()->logInfo("Using device ID: " + std::to_string(i));
-                            }
-                            break;
-                        }
-                    }
-                }
-            }
-
-            // If still no suitable device found, provide detailed error
-            if (!found || audioDeviceId < 0) {
-                std::string str = "No suitable audio output device found. ";
-                str += "Required: " + std::to_string(nChannels) + " output channels. ";
-                str += "Available devices:";
-                
-                std::cerr << str << endl;
-                CuemsLogger::getLogger()->logError(str);
-                
-                // List available devices for debugging
-                for(int i = 0; i < deviceCount; ++i) {
-                    try {
-                        RtAudio::DeviceInfo info = audio.getDeviceInfo(i);
-                        std::string deviceStr = "  Device " + std::to_string(i) + ": " + info.name;
-                        deviceStr += " (probed: " + std::string(info.probed ? "yes" : "no");
-                        deviceStr += ", output channels: " + std::to_string(info.outputChannels) + ")";
-                        std::cerr << deviceStr << endl;
-                        CuemsLogger::getLogger()->logError(deviceStr);
-                    } catch (...) {
-                        std::string deviceStr = "  Device " + std::to_string(i) + ": (failed to probe)";
-                        std::cerr << deviceStr << endl;
-                        CuemsLogger::getLogger()->logError(deviceStr);
-                    }
-                }
-
-                str = "Maybe JACK NOT RUNNING or no suitable output device available!";
-                std::cerr << str << endl;
-                CuemsLogger::getLogger()->logError(str);
-
-                exit( CUEMS_EXIT_AUDIO_DEVICE_ERR );
-            }
-        }
+    // No audio device at all, renderToFile() will drive the callback
+    if ( nullBackend ) {
+        setupNullBackend( initOffset );
+        return;
     }
-    catch ( RtAudioError &error ) {
-        std::cerr << error.getMessage();
-        CuemsLogger::getLogger()->logError( error.getMessage() );
 
-        CuemsLogger::getLogger()->logInfo( "Exiting with result code: " + std::to_string(CUEMS_EXIT_AUDIO_DEVICE_ERR) );
-        exit( CUEMS_EXIT_AUDIO_DEVICE_ERR );
-    }
 
     // Get the default audio device and set stream parameters
     RtAudio::StreamParameters streamParams;
     streamParams.deviceId = audioDeviceId;
-    streamParams.nChannels = nChannels;
+    streamParams.nChannels = outputChannels;
     streamParams.firstChannel = 0;
 
     RtAudio::StreamOptions streamOps;
@@ -253,15 +263,12 @@ AudioPlayer::AudioPlayer(   int port,
         // This is crucial for pw-jack compatibility where the server rate may differ
         unsigned int requestedRate = sampleRate;  // Start with constructor's rate
         
-        try {
-            RtAudio::DeviceInfo deviceInfo = audio.getDeviceInfo(audioDeviceId);
-            if (deviceInfo.probed && deviceInfo.sampleRates.size() > 0) {
-                // Use the device's preferred (first) sample rate
-                requestedRate = deviceInfo.sampleRates[0];
-                CuemsLogger::getLogger()->logInfo("Using device native sample rate: " + 
-                    std::to_string(requestedRate) + " Hz");
-            }
-        } catch (...) {
+        if (outputDevice.probed && outputDevice.sampleRates.size() > 0) {
+            // Use the device's preferred (first) sample rate
+            requestedRate = outputDevice.sampleRates[0];
+            CuemsLogger::getLogger()->logInfo("Using device native sample rate: " + 
+                std::to_string(requestedRate) + " Hz");
+        } else {
             // If we can't query, stick with requested rate
             CuemsLogger::getLogger()->logInfo("Could not query device sample rate, using requested: " + 
                 std::to_string(requestedRate) + " Hz");
@@ -275,8 +282,10 @@ AudioPlayer::AudioPlayer(   int port,
                             &audioCallback,
                             (void *) this,
                             &streamOps );
+        startupTrace.mark( "stream" );
 
         audio.startStream();
+        startupTrace.mark( "started" );
         
         // Get actual JACK sample rate (JACK is the master)
         unsigned int jackSampleRate = audio.getStreamSampleRate();
@@ -294,6 +303,7 @@ AudioPlayer::AudioPlayer(   int port,
             // Recalculate timing with actual JACK sample rate
             audioSecondSize = sampleRate * audioFrameSize;
             audioMillisecondSize = ( (float) sampleRate / 1000 ) * audioFrameSize;
+            mtcClock.setSampleRate(sampleRate);
 
             if (m_explicitLatencyMs >= 0) {
                 // Explicit override from --output-latency-ms CLI arg
@@ -338,13 +348,15 @@ AudioPlayer::AudioPlayer(   int port,
         // Get the file's actual channel count
         unsigned int fileChannels = audioFile.getChannels();
         
-        // Get device capabilities
-        RtAudio::DeviceInfo deviceInfo = audio.getDeviceInfo(audioDeviceId);
-        unsigned int deviceChannels = deviceInfo.outputChannels;
+        // Get device capabilities, as probed when looking for it
+        unsigned int deviceChannels = outputDevice.outputChannels;
         
         // Determine target channels: use file's channels if device supports it, otherwise downmix
         // This is how mpv does it - only downmix when necessary
-        if (fileChannels > deviceChannels) {
+        if (routingMode) {
+            // Already in its own channels, the matrix does the rest
+            std::cerr << "Routing " << nChannels << " channels to " << outputChannels << " outputs" << endl;
+        } else if (fileChannels > deviceChannels) {
             // File has more channels than device supports, need to downmix
             std::cerr << "Device supports " << deviceChannels << " channels, file has " 
                       << fileChannels << " channels - will downmix" << endl;
@@ -352,13 +364,11 @@ AudioPlayer::AudioPlayer(   int port,
                                               " channels to " + std::to_string(deviceChannels) + 
                                               " channels to match device capabilities");
             
-            // Reopen the file with downmixing
-            audioFile.close();
+            // Downmix in place, only the channel conversion is rebuilt
             audioFile.setTargetChannels(deviceChannels);
-            audioFile.open(audioPath, ios::binary | ios::in);
             
             if (!audioFile.good()) {
-                std::string str = "Error reopening audio file with downmixing: " + audioPath;
+                std::string str = "Error setting up downmixing of audio file: " + audioPath;
                 std::cerr << str << endl;
                 CuemsLogger::getLogger()->logError(str);
                 exit(CUEMS_EXIT_AUDIO_DEVICE_ERR);
@@ -369,8 +379,8 @@ AudioPlayer::AudioPlayer(   int port,
         } else if (fileChannels < nChannels) {
             // File has fewer channels than the JACK stream we already opened.
             // We can't shrink the JACK port count after openStream(), so the
-            // file must be upmixed to match. Reopen with setTargetChannels()
-            // so swresample fills every JACK channel (mono → L=R, etc.).
+            // file must be upmixed to match. setTargetChannels() rebuilds the
+            // conversion so swresample fills every JACK channel (mono → L=R, etc.).
             // Without this the audioCallback writes fileChannels-worth of
             // floats into an nChannels-interleaved buffer, and JACK plays
             // them as nChannels/fileChannels× too fast (e.g. mono into
@@ -381,12 +391,10 @@ AudioPlayer::AudioPlayer(   int port,
                                               " channels to " + std::to_string(nChannels) +
                                               " channels to match JACK stream");
 
-            audioFile.close();
             audioFile.setTargetChannels(nChannels);
-            audioFile.open(audioPath, ios::binary | ios::in);
 
             if (!audioFile.good()) {
-                std::string str = "Error reopening audio file with upmixing: " + audioPath;
+                std::string str = "Error setting up upmixing of audio file: " + audioPath;
                 std::cerr << str << endl;
                 CuemsLogger::getLogger()->logError(str);
                 exit(CUEMS_EXIT_AUDIO_DEVICE_ERR);
@@ -402,8 +410,8 @@ AudioPlayer::AudioPlayer(   int port,
             nChannels = fileChannels;
         }
         
-        // Configure resampling in audio file if needed (libsoxr will handle rate conversion)
-        audioFile.setTargetSampleRate(sampleRate);
+        startDecoding();
+        startupTrace.mark( "decoding" );
     }
     catch (RtAudioError &error) {
         std::cerr << error.getMessage();
@@ -417,31 +425,492 @@ AudioPlayer::AudioPlayer(   int port,
 }
 
 //////////////////////////////////////////////////////////
-AudioPlayer::~AudioPlayer( void ) {
+int AudioPlayer::findOutputDevice( bool fastStart ) {
+    int audioDeviceId = -1;
     try {
-        // Stop the stream
-        audio.abortStream();
+        int deviceCount = audio.getDeviceCount();
+        if ( deviceCount == 0 ) {
+            std::string str = "No audio devices found on API:" + 
+                std::to_string(audio.getCurrentApi());
+
+            std::cerr << str << endl;
+            CuemsLogger::getLogger()->logError(str);
+
+            str = "Maybe JACK NOT RUNNING!!!";
+
+            std::cerr << str << endl;
+            CuemsLogger::getLogger()->logError(str);
+
+            exit( CUEMS_EXIT_AUDIO_DEVICE_ERR );
+        }
+        else {
+            // Device infos, each one probed on first use only
+            std::vector<RtAudio::DeviceInfo> infos( deviceCount );
+            std::vector<bool> tried( deviceCount, false );
+            auto probe = [&](int deviceId) -> const RtAudio::DeviceInfo& {
+                if (!tried[deviceId]) {
+                    tried[deviceId] = true;
+                    try {
+                        infos[deviceId] = audio.getDeviceInfo(deviceId);
+                    } catch (...) {
+                        // Left as not probed
+                    }
+                }
+                return infos[deviceId];
+            };
+
+            // Helper function to check if a device is suitable
+            auto isDeviceSuitable = [&](int deviceId) -> bool {
+                const RtAudio::DeviceInfo& info = probe(deviceId);
+                // Check if device is probed successfully and has enough output channels
+                return info.probed && 
+                       info.outputChannels >= outputChannels;
+            };
+
+            // First, try to find device by name (if specified). On fast
+            // start it is taken as it is, opening the stream checks it.
+            bool found = false;
+            if (!deviceName.empty()) {
+                for(int i = 0; i < deviceCount; ++i) {
+                    if (probe(i).name == deviceName && (fastStart || isDeviceSuitable(i))) {
+                        audioDeviceId = i;
+                        found = true;
+                        CuemsLogger::getLogger()->logInfo("Found specified device: " + deviceName);
+                        break;
+                    }
+                }
+            }
+
+            // If device name not found or not suitable, find any suitable output device
+            if (!found) {
+                // Try default output device first
+                int defaultDevice = audio.getDefaultOutputDevice();
+                if (defaultDevice >= 0 && defaultDevice < deviceCount && isDeviceSuitable(defaultDevice)) {
+                    audioDeviceId = defaultDevice;
+                    found = true;
+                    CuemsLogger::getLogger()->logInfo("Using default output device");
+                } else {
+                    // Iterate through all devices to find a suitable one
+                    for(int i = 0; i < deviceCount; ++i) {
+                        if (isDeviceSuitable(i)) {
+                            audioDeviceId = i;
+                            found = true;
+                            CuemsLogger::getLogger()->logInfo("Using device: " + infos[i].name + 
+                                " (" + std::to_string(infos[i].outputChannels) + " output channels)");
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // If still no suitable device found, provide detailed error
+            if (!found || audioDeviceId < 0) {
+                std::string str = "No suitable audio output device found. ";
+                str += "Required: " + std::to_string(outputChannels) + " output channels. ";
+                str += "Available devices:";
+                
+                std::cerr << str << endl;
+                CuemsLogger::getLogger()->logError(str);
+                
+                // List available devices for debugging
+                for(int i = 0; i < deviceCount; ++i) {
+                    const RtAudio::DeviceInfo& info = probe(i);
+                    std::string deviceStr = "  Device " + std::to_string(i) + ": ";
+                    if (info.probed || !info.name.empty()) {
+                        deviceStr += info.name;
+                        deviceStr += " (probed: " + std::string(info.probed ? "yes" : "no");
+                        deviceStr += ", output channels: " + std::to_string(info.outputChannels) + ")";
+                    } else {
+                        deviceStr += "(failed to probe)";
+                    }
+                    std::cerr << deviceStr << endl;
+                    CuemsLogger::getLogger()->logError(deviceStr);
+                }
+
+                str = "Maybe JACK NOT RUNNING or no suitable output device available!";
+                std::cerr << str << endl;
+                CuemsLogger::getLogger()->logError(str);
+
+                exit( CUEMS_EXIT_AUDIO_DEVICE_ERR );
+            }
+
+            outputDevice = infos[audioDeviceId];
+        }
     }
-    catch (RtAudioError& error) {
+    catch ( RtAudioError &error ) {
         std::cerr << error.getMessage();
         CuemsLogger::getLogger()->logError( error.getMessage() );
+
+        CuemsLogger::getLogger()->logInfo( "Exiting with result code: " + std::to_string(CUEMS_EXIT_AUDIO_DEVICE_ERR) );
+        exit( CUEMS_EXIT_AUDIO_DEVICE_ERR );
+    }
+
+    return audioDeviceId;
+}
+
+//////////////////////////////////////////////////////////
+void AudioPlayer::startDecoding( void ) {
+    // Varispeed needs the variable-rate resampler even at matching rates
+    audioFile.setVarispeed(varispeedMode);
+
+    // Configure resampling in audio file if needed (libsoxr will handle rate conversion)
+    audioFile.setTargetSampleRate(sampleRate);
+
+    // Time budget the callback statistics compare against
+    callbackStats.setPeriod( bufferFrames, sampleRate );
+
+    // Preloaded or cached files are already a copy from memory, no thread needed
+    if ( streamingMode && audioFile.isPreloaded() ) {
+        CuemsLogger::getLogger()->logInfo("File preloaded, streaming decoder not needed");
+        streamingMode = false;
+    }
+
+    // From now on the file belongs to the decoder thread in streaming mode
+    if ( streamingMode ) {
+        if ( !streamer.start( bufferFrames, nChannels, sampleRate ) ) {
+            CuemsLogger::getLogger()->logWarning("Could not start streaming decoder, decoding in the audio callback");
+            streamingMode = false;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////
+void AudioPlayer::setupNullBackend( long int initOffset ) {
+    CuemsLogger::getLogger()->logInfo("Null audio backend: " + std::to_string(nChannels) + " channels at " +
+                                      std::to_string(sampleRate) + " Hz, " + std::to_string(bufferFrames) +
+                                      " frames per period");
+
+    if ( !audioFile.good() || bufferFrames == 0 ) {
+        std::string str = "Error opening audio file: " + audioPath;
+        std::cerr << str << endl;
+        CuemsLogger::getLogger()->logError(str);
+        exit(CUEMS_EXIT_WRONG_DATA_FILE);
+    }
+
+    // Like a fixed size device: the file is up or down mixed to our channels
+    if ( audioFile.getChannels() != nChannels ) {
+        audioFile.setTargetChannels(nChannels);
+
+        if ( !audioFile.good() ) {
+            std::string str = "Error setting up channel mixing of audio file: " + audioPath;
+            std::cerr << str << endl;
+            CuemsLogger::getLogger()->logError(str);
+            exit(CUEMS_EXIT_WRONG_DATA_FILE);
+        }
+    }
+
+    // No device pipeline, only the explicit latency if any
+    if ( m_explicitLatencyMs >= 0 ) {
+        outputLatencyMs_.store( std::min( m_explicitLatencyMs, 500L ) );
+    }
+    headOffset.store((initOffset + outputLatencyMs_.load()) * audioMillisecondSize);
+
+    // Rendering always follows the scripted MTC
+    followingMtc = true;
+
+    startDecoding();
+}
+
+//////////////////////////////////////////////////////////
+int AudioPlayer::renderToFile( const string& outPath, double seconds, bool realTime ) {
+    if ( !nullBackend ) {
+        CuemsLogger::getLogger()->logError("Render: only available with the null audio backend");
+        return CUEMS_EXIT_FAILURE;
+    }
+
+    WavWriter writer;
+    if ( !writer.open( outPath, outputChannels, sampleRate ) ) {
+        CuemsLogger::getLogger()->logError("Render: could not create " + outPath);
+        return CUEMS_EXIT_FAILURE;
+    }
+
+    std::vector<float> buffer( (size_t) bufferFrames * outputChannels );
+    unsigned long long maxFrames = ( seconds > 0 ) ? (unsigned long long)( seconds * sampleRate ) : 0;
+    unsigned long long frames = 0;
+    unsigned long long periods = 0;
+
+    // Scripted MTC: running from 0 at nominal speed, updated once per
+    // quarter frame as a real receiver would
+    double quarterFrameMs = 1000.0 / ( RENDER_MTC_FRAMERATE * 4 );
+    mtcReceiver.curFrameRate.store( RENDER_MTC_FRAMERATE );
+    mtcReceiver.isTimecodeRunning.store( true );
+
+    callbackStats.reset();
+    auto renderStart = chrono::steady_clock::now();
+
+    while ( !endOfPlay && ( maxFrames == 0 || frames < maxFrames ) ) {
+        double nowMs = frames * 1000.0 / sampleRate;
+        mtcReceiver.mtcHead.store( (long) ( floor( nowMs / quarterFrameMs ) * quarterFrameMs ) );
+
+        // As fast as possible must not outrun the decoder thread
+        if ( streamingMode && !realTime ) {
+            auto waitStart = chrono::steady_clock::now();
+            while ( !playingStreamer.load()->isBuffered( (size_t) bufferFrames * nChannels ) &&
+                    chrono::steady_clock::now() - waitStart < chrono::seconds(1) ) {
+                std::this_thread::yield();
+            }
+        }
+
+        int result = audioCallback( buffer.data(), nullptr, bufferFrames, nowMs / 1000.0, 0, this );
+        periods++;
+
+        writer.write( buffer.data(), bufferFrames );
+        frames += bufferFrames;
+
+        if ( result != 0 ) {
+            break;
+        }
+
+        if ( realTime ) {
+            std::this_thread::sleep_until( renderStart + chrono::microseconds( (long long)( frames * 1000000.0 / sampleRate ) ) );
+        }
+    }
+
+    mtcReceiver.isTimecodeRunning.store( false );
+    writer.close();
+
+    double wallSeconds = chrono::duration<double>( chrono::steady_clock::now() - renderStart ).count();
+    double audioSeconds = (double) frames / sampleRate;
+    CallbackStats::Snapshot callbacks = callbackStats.snapshot();
+
+    std::ostringstream stats;
+    stats << std::fixed << std::setprecision(2) <<
+        "Render: " << periods << " periods (" << audioSeconds << " s of audio) in " << wallSeconds << " s, " <<
+        ( wallSeconds > 0 ? periods / wallSeconds : 0.0 ) << " periods/s, " <<
+        ( wallSeconds > 0 ? audioSeconds / wallSeconds : 0.0 ) << "x real time, callback " <<
+        callbacks.avgUs << " us avg / " << callbacks.p99Us << " us p99 / " << callbacks.maxUs << " us max";
+
+    std::cout << stats.str() << endl;
+    CuemsLogger::getLogger()->logInfo( stats.str() );
+    if ( streamingMode && playingStreamer.load()->getUnderruns() > 0 ) {
+        CuemsLogger::getLogger()->logWarning( "Render: " + std::to_string( playingStreamer.load()->getUnderruns() ) + " streaming underruns" );
+    }
+
+    return CUEMS_EXIT_OK;
+}
+
+//////////////////////////////////////////////////////////
+bool AudioPlayer::preloadCue( const string& path ) {
+    // One preload at a time, the previous one is done before we go on
+    if ( cueThread.joinable() ) {
+        cueThread.join();
+    }
+
+    // Take the standby slot, waiting out a swap in progress. A cue
+    // ready but not swapped yet is replaced.
+    int state = cueState.load( std::memory_order_acquire );
+    while ( state == CUE_SWAPPING ||
+            !cueState.compare_exchange_weak( state, CUE_LOADING, std::memory_order_acq_rel ) ) {
+        if ( state == CUE_SWAPPING ) {
+            std::this_thread::yield();
+            state = cueState.load( std::memory_order_acquire );
+        }
+    }
+
+    cueThread = std::thread( &AudioPlayer::prepareCue, this, path );
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+bool AudioPlayer::isCueReady( void ) const {
+    return cueState.load( std::memory_order_acquire ) == CUE_READY;
+}
+
+//////////////////////////////////////////////////////////
+void AudioPlayer::swapCue( void ) {
+    if ( cueState.load( std::memory_order_acquire ) == CUE_EMPTY ) {
+        CuemsLogger::getLogger()->logWarning("Swap: no cue preloaded");
+        return;
+    }
+
+    if ( !isCueReady() ) {
+        CuemsLogger::getLogger()->logInfo("Swap: cue still loading, switching as soon as it is ready");
+    }
+
+    swapRequested.store( true, std::memory_order_release );
+}
+
+//////////////////////////////////////////////////////////
+// Cue thread: open, probe and start decoding the standby slot with the
+// output format of the slot on air
+void AudioPlayer::prepareCue( const string path ) {
+    auto prepareStart = chrono::steady_clock::now();
+
+    bool firstOnAir = ( playingFile.load( std::memory_order_acquire ) == &audioFile );
+    AudioFstream& file = firstOnAir ? cueFile : audioFile;
+    AudioStreamer& stream = firstOnAir ? cueStreamer : streamer;
+
+    // Whatever the slot played before goes away
+    stream.rewind();
+    file.close();
+
+    file.setTargetChannels( nChannels );
+    file.setVarispeed( varispeedMode );
+    file.setTargetSampleRate( sampleRate );
+    file.open( path, ios::binary | ios::in );
+
+    if ( !file.good() ) {
+        CuemsLogger::getLogger()->logError("Preload: could not open cue " + path);
+        cueState.store( CUE_EMPTY, std::memory_order_release );
+        return;
+    }
+
+    // Streamed cues get their ring filled ahead, the others have their
+    // codec and resampler run once so the first callback read is cheap
+    cueStreaming = streamingWanted && !file.isPreloaded();
+    if ( cueStreaming ) {
+        stream.setPlaybackRate( 1.0 );
+        cueStreaming = stream.start( bufferFrames, nChannels, sampleRate );
+
+        size_t ahead = (size_t) bufferFrames * nChannels * ( STREAMER_BUFFER_PERIODS - 1 );
+        auto waitStart = chrono::steady_clock::now();
+        while ( cueStreaming && !stream.isBuffered( ahead ) &&
+                chrono::steady_clock::now() - waitStart < chrono::seconds(1) ) {
+            std::this_thread::sleep_for( chrono::milliseconds(1) );
+        }
+    }
+    else {
+        std::vector<float> warmUp( (size_t) bufferFrames * nChannels );
+        file.read( (char*) warmUp.data(), warmUp.size() * sizeof(float) );
+        file.clear();
+        file.seekg( 0, ios_base::beg );
+    }
+
+    double ms = chrono::duration<double, std::milli>( chrono::steady_clock::now() - prepareStart ).count();
+    std::ostringstream str;
+    str << std::fixed << std::setprecision(1) << "Preload: cue ready in " << ms << " ms"
+        << ( file.isPreloaded() ? " (in memory)" : ( cueStreaming ? " (streaming)" : "" ) ) << " -> " << path;
+    CuemsLogger::getLogger()->logInfo( str.str() );
+
+    cueState.store( CUE_READY, std::memory_order_release );
+}
+
+//////////////////////////////////////////////////////////
+// Audio thread, start of a period: the standby slot goes on air
+void AudioPlayer::switchCue( void ) {
+    AudioFstream* file = playingFile.load( std::memory_order_relaxed );
+    AudioStreamer* stream = playingStreamer.load( std::memory_order_relaxed );
+
+    // Published along with the streamer, sendStats reads both
+    streamingMode.store( cueStreaming, std::memory_order_relaxed );
+    playingFile.store( file == &audioFile ? &cueFile : &audioFile, std::memory_order_release );
+    playingStreamer.store( stream == &streamer ? &cueStreamer : &streamer, std::memory_order_release );
+    swapRequested.store( false, std::memory_order_relaxed );
+
+    // The new cue starts from its top right now, MTC relocations are
+    // then relative to this point. Kept apart from the configured offset
+    // so a later /offset moves the cue by the change, not to its value.
+    cueBase = -( playHead.load() + headOffset.load() );
+    endOfStream = false;
+    outOfFile = false;
+    endTimeStamp.store( 0 );
+
+    // Prepared at nominal speed
+    if ( varispeedMode ) {
+        driftController.reset();
+        playbackRate = 1.0;
+        playHeadFraction = 0.0;
+    }
+}
+
+//////////////////////////////////////////////////////////
+AudioPlayer::~AudioPlayer( void ) {
+    if ( !nullBackend ) {
+        try {
+            // Stop the stream
+            audio.abortStream();
+        }
+        catch (RtAudioError& error) {
+            std::cerr << error.getMessage();
+            CuemsLogger::getLogger()->logError( error.getMessage() );
+        }
+
+        // Clean up
+        audio.closeStream();
+    }
+    if ( cueThread.joinable() ) {
+        cueThread.join();
+    }
+    streamer.stop();
+    cueStreamer.stop();
+
+    if ( endOfPlayEvent >= 0 ) {
+        ::close( endOfPlayEvent );
+    }
+
+    CallbackStats::Snapshot callbacks = callbackStats.snapshot();
+    if ( callbacks.callbacks > 0 ) {
+        std::ostringstream stats;
+        stats << std::fixed << std::setprecision(1) <<
+            "Audio callback: " << callbacks.callbacks << " periods, " <<
+            callbacks.avgUs << " us avg / " << callbacks.p99Us << " us p99 / " << callbacks.maxUs << " us max, " <<
+            callbacks.load * 100.0 << "% load, " << callbacks.underflows << " underflows, " <<
+            callbacks.shortReads << " short reads, " << callbacks.seeks << " seeks";
+        CuemsLogger::getLogger()->logInfo( stats.str() );
     }
 
-    // Clean up
-    audio.closeStream();
+    if ( RtAllocGuard::getAllocationCount() > 0 ) {
+        CuemsLogger::getLogger()->logWarning( "Heap allocations in the audio callback: " +
+            std::to_string( RtAllocGuard::getAllocationCount() ) + " (" +
+            std::to_string( RtAllocGuard::getNewCount() ) + " from operator new)" );
+    }
 
     // Delete dinamically reserved members
-    delete []volumeMaster;
     delete []intermediate;
 }
 
 //////////////////////////////////////////////////////////
 // RtAudio callback - Static member function
 int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsigned int nBufferFrames,
-            double /*streamTime*/, RtAudioStreamStatus /*status*/, void *data ) {
+            double /*streamTime*/, RtAudioStreamStatus status, void *data ) {
+
+    // Debug builds (CUEMS_RT_ALLOC_CHECK) account any heap allocation from here on
+    RtAllocGuard rtAllocGuard;
 
     AudioPlayer *ap = (AudioPlayer*) data;
 
+    // Timed on every return path, atomics only
+    CallbackStats::Timer callbackTimer( ap->callbackStats );
+
+    if ( status & RTAUDIO_OUTPUT_UNDERFLOW ) {
+        ap->callbackStats.recordUnderflow();
+    }
+
+    // Control changes sent since the last period
+    ap->applyCommands();
+
+    // A /swap takes effect on a period boundary, once the cue is ready
+    if ( ap->swapRequested.load( std::memory_order_acquire ) && !ap->fileSuspended ) {
+        int ready = CUE_READY;
+        if ( ap->cueState.compare_exchange_strong( ready, CUE_SWAPPING, std::memory_order_acq_rel ) ) {
+            ap->switchCue();
+            ap->cueState.store( CUE_EMPTY, std::memory_order_release );
+        }
+    }
+
+    // The slot on air for this whole period
+    AudioFstream& audioFile = *ap->playingFile.load( std::memory_order_relaxed );
+    AudioStreamer& streamer = *ap->playingStreamer.load( std::memory_order_relaxed );
+
+    // The file is read straight into the device buffer, or into the
+    // routing buffer to be spread over the outputs
+    float* fileBuffer = (float*) outputBuffer;
+    if ( ap->routingMode ) {
+        if ( (size_t) nBufferFrames * ap->nChannels > ap->routeBuffer.size() ) {
+            memset( outputBuffer, 0, (size_t) nBufferFrames * ap->outputChannels * ap->headStep );
+            return 0;
+        }
+        fileBuffer = ap->routeBuffer.data();
+    }
+
+    // Our own sample clock, the time base for the MTC clock recovery
+    long long periodStart = ap->sampleClock;
+    ap->sampleClock += nBufferFrames;
+
+    if ( !ap->mtcReceiver.isTimecodeRunning ) {
+        ap->mtcClock.reset();
+    }
+
     // If we are receiving MTC and following it...
     // Or we are not receiving it and we do not stop on its lost
     // And we haven't reached the end of the file...
@@ -451,16 +920,21 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
         unsigned int count = 0;
         unsigned int read = 0;
 
+        // MTC timeline the voices follow this period, if any, in frames
+        bool timelineKnown = false;
+        long long timelineFrame = 0;
+        long long timelineTolerance = 0;
+
         // Check play control flags
         // If there is MTC signal and we haven't started, check it
         if ( ap->mtcReceiver.isTimecodeRunning ) {
             if ( !ap->mtcSignalStarted ) {
-                CuemsLogger::getLogger()->logInfo("MTC -> Play started");
+                ap->rtLogger.log( RtLogger::MTC_PLAY_STARTED );
                 ap->mtcSignalStarted = true;
             }
             else {
                 if ( ap->mtcSignalLost ) {
-                    CuemsLogger::getLogger()->logInfo("MTC -> Play resumed");
+                    ap->rtLogger.log( RtLogger::MTC_PLAY_RESUMED );
                 }
             }
 
@@ -470,7 +944,7 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
         // Either, if there is no MTC signal and we already started, it is lost
         else {
             if ( ap->mtcSignalStarted && !ap->mtcSignalLost ) {
-                CuemsLogger::getLogger()->logInfo("MTC signal lost");
+                ap->rtLogger.log( RtLogger::MTC_SIGNAL_LOST );
                 ap->mtcSignalLost = true;
             }
         }
@@ -486,18 +960,51 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
             unsigned char frameRate = ap->mtcReceiver.curFrameRate.load();
             if (frameRate == 0) {
                 frameRate = 25;  // Default to 25fps
-                CuemsLogger::getLogger()->logWarning("MTC frame rate invalid (0), defaulting to 25fps");
+                ap->rtLogger.log( RtLogger::MTC_FRAMERATE_INVALID, frameRate );
             }
-            long int tolerance = MTC_FRAMES_TOLERANCE * ( 1000 / (float) frameRate ) * ap->audioMillisecondSize;
+            // Quarter frame arrivals are smoothed into a timeline locked to our
+            // sample clock, once locked the tolerance can be tighter
+            long mtcHeadMs = ap->mtcReceiver.mtcHead.load();
+            ap->mtcClock.update( mtcHeadMs, periodStart );
+
+            double headMs = mtcHeadMs;
+            unsigned int toleranceFrames = MTC_FRAMES_TOLERANCE;
+            if ( ap->mtcClock.isLocked() ) {
+                headMs = ap->mtcClock.positionMs( periodStart );
+                toleranceFrames = MTC_LOCKED_FRAMES_TOLERANCE;
+            }
+
+            long int tolerance = toleranceFrames * ( 1000 / (float) frameRate ) * ap->audioMillisecondSize;
             
-            // Use long long to prevent overflow for long files (multi-hour) with high sample rates
-            long long int mtcHeadInBytes = (long long int)ap->mtcReceiver.mtcHead.load() * ap->audioMillisecondSize;
+            // Use long long to prevent overflow for long files (multi-hour) with high sample rates.
+            // Converted through whole frames, audioMillisecondSize is truncated at 44.1 kHz
+            long long int mtcHeadFrames = llround( headMs * ap->sampleRate / 1000.0 );
+            long long int mtcHeadInBytes = mtcHeadFrames * ap->audioFrameSize;
+
+            // Voices are heard with the same output latency as the main
+            // file, its headOffset carries it
+            timelineKnown = true;
+            timelineFrame = mtcHeadFrames + llround( ap->outputLatencyMs_.load() * ap->sampleRate / 1000.0 );
+            timelineTolerance = tolerance / ap->audioFrameSize;
 
             long long int difference = ap->playHead - mtcHeadInBytes;
+            ap->callbackStats.recordDrift( difference * 1000.0 / ( (double) ap->audioFrameSize * ap->sampleRate ) );
+
+            // In varispeed mode drifts are pulled in by the playback rate,
+            // seeks are kept for real jumps in the timecode
+            if ( ap->varispeedMode ) {
+                tolerance = VARISPEED_SEEK_FRAMES * ( 1000 / (float) frameRate ) * ap->audioMillisecondSize;
+            }
 
             // If our audio play head is too late or out of the boundaries of our mtc frame
-            // tolerance... We correct it. Also if the offset changed dynamically via OSC
-            if ( abs(difference) > tolerance || ap->offsetChanged ) {
+            // tolerance... We correct it. Also if the offset changed dynamically via OSC,
+            // or a new file was loaded. Not while the file is being loaded.
+            if ( ap->fileSuspended ) {
+                // Left for when it is back
+            }
+            else if ( abs(difference) > tolerance || ap->offsetChanged || ap->relocate ) {
+                ap->relocate = false;
+
                 // Set new OSC offset if any
                 if ( ap->offsetChanged ) {
                     ap->headOffset.store(ap->headNewOffset.load());
@@ -507,30 +1014,49 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
                 }
 
                 // Calculate the actual seek position in the file (accounting for offset)
-                long long seekPosition = mtcHeadInBytes + ap->headOffset.load();
-                unsigned long long fileSize = ap->audioFile.getFileSize();
+                long long fileOffset = ap->headOffset.load() + ap->cueBase;
+                long long seekPosition = mtcHeadInBytes + fileOffset;
+                unsigned long long fileSize = audioFile.getFileSize();
                 
                 if ( (seekPosition >= 0) && (seekPosition <= (long long)fileSize) ){
 
                     ap->endOfStream = false;
                     ap->outOfFile = false;
-                    if ( ap->audioFile.eof() ) {
-                        ap->audioFile.clear();
+                    ap->callbackStats.recordSeek();
+                    if ( ap->streamingMode ) {
+                        // Handed over to the decoder thread
+                        streamer.seekg( seekPosition , ios_base::beg );
+                    }
+                    else {
+                        if ( audioFile.eof() ) {
+                            audioFile.clear();
+                        }
+                        // Seek to the calculated position
+                        audioFile.seekg( seekPosition , ios_base::beg );
                     }
-                    // Seek to the calculated position
-                    ap->audioFile.seekg( seekPosition , ios_base::beg );
                     // Update playHead to match where we actually are (without offset, as offset is separate)
-                    ap->playHead = seekPosition - ap->headOffset.load();
+                    ap->playHead = seekPosition - fileOffset;
                 }
                 else {
-                    CuemsLogger::getLogger()->logInfo("Out of file boundaries!");
+                    ap->rtLogger.log( RtLogger::OUT_OF_FILE );
                     // Clear error flags to allow responding to future offset changes
                     // (e.g., when OSC offset command moves position back into bounds)
-                    ap->audioFile.clear();
+                    audioFile.clear();
                     ap->endOfStream = true;
                     ap->outOfFile = true;
                 }
 
+                // Start following again from nominal speed
+                if ( ap->varispeedMode ) {
+                    ap->driftController.reset();
+                    ap->setPlaybackRate( 1.0 );
+                    ap->playHeadFraction = 0.0;
+                }
+            }
+            else if ( ap->varispeedMode ) {
+                double errorMs = (double) difference / ap->audioMillisecondSize;
+                double periodMs = nBufferFrames * 1000.0 / ap->sampleRate;
+                ap->setPlaybackRate( ap->driftController.update( errorMs, periodMs ) );
             }
         }
 
@@ -540,33 +1066,63 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
             // Calculate total bytes to read for this buffer
             unsigned long int bytesToRead = nBufferFrames * ap->audioFrameSize;
             
-            if ( (ap->playHead + ap->headOffset.load()) >= 0 ) {
-                // Read entire buffer in ONE call - much more efficient for resampling!
-                ap->audioFile.read((char*) outputBuffer, bytesToRead);
-                count = ap->audioFile.gcount();
-                
-                // Apply volume to each sample
-                float* floatBuffer = (float*)outputBuffer;
-                for ( unsigned int i = 0; i < count / 4; i++ ) {
-                    floatBuffer[i] *= ap->volumeMaster[i % ap->nChannels];
+            if ( (ap->playHead + ap->headOffset.load() + ap->cueBase) >= 0 && !ap->fileSuspended ) {
+                if ( ap->streamingMode ) {
+                    // Just a copy from the decoder thread ring buffer
+                    streamer.read((char*) fileBuffer, bytesToRead);
+                    count = streamer.gcount();
+                }
+                else {
+                    // Read entire buffer in ONE call - much more efficient for resampling!
+                    auto decodeStart = chrono::steady_clock::now();
+                    audioFile.read((char*) fileBuffer, bytesToRead);
+                    count = audioFile.gcount();
+                    ap->callbackStats.recordDecode( chrono::duration_cast<chrono::nanoseconds>(
+                        chrono::steady_clock::now() - decodeStart ).count() );
                 }
+
+                if ( count < bytesToRead ) {
+                    ap->callbackStats.recordShortRead();
+                }
+                
+                // Apply volume to each sample, ramping to any new gains
+                ap->gainStage.process( fileBuffer, count / ap->audioFrameSize, ap->nChannels );
             }
             else {
-                // Before file start - fill with silence
-                memset(outputBuffer, 0, bytesToRead);
+                // Before file start, or file being loaded - fill with silence
+                memset(fileBuffer, 0, bytesToRead);
                 count = bytesToRead;
             }
 
-            ap->playHead += count;
+            if ( ap->varispeedMode ) {
+                // The file moves at the playback rate, not at the output rate.
+                // In streaming mode the ring holds audio made at older rates,
+                // the controller takes care of that small lag.
+                double frames = (double)( count / ap->audioFrameSize ) * ap->playbackRate + ap->playHeadFraction;
+                long long wholeFrames = (long long) floor( frames );
+                ap->playHeadFraction = frames - wholeFrames;
+                ap->playHead += wholeFrames * ap->audioFrameSize;
+            }
+            else {
+                ap->playHead += count;
+            }
         }
 
         // If we didn't read enough bytes to fill the buffer, let's put some
         // silence aferwards copying zeros to the rest of the buffer
-        if ( count < nBufferFrames ) {
-            unsigned long int bytes = (nBufferFrames - count) * ap->audioFrameSize;
-            unsigned long int startByte = count * ap->audioFrameSize;
+        unsigned long int periodBytes = nBufferFrames * ap->audioFrameSize;
+        if ( count < periodBytes ) {
+            memset( (char *)(fileBuffer) + count, 0, periodBytes - count );
+        }
 
-            memset( (char *)(outputBuffer) + startByte, 0, bytes );
+        // File channels to output ports
+        if ( ap->routingMode ) {
+            ap->routingMatrix.route( fileBuffer, (float*) outputBuffer, nBufferFrames );
+        }
+
+        // Voices on top of the main file
+        for ( auto& voice : ap->voices ) {
+            voice->mix( (float*) outputBuffer, nBufferFrames, timelineKnown, timelineFrame, timelineTolerance );
         }
 
         // If we did not read anything, we are out of boundaries, maybe...
@@ -575,7 +1131,7 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
             if ( ap->endWaitTime == 0 ) {
                 // If there is not waiting time, we just finish
                 // and we end the stream by returning a positive value
-                ap->endOfPlay = true;
+                ap->endPlay();
                 
                 return 1;
             }
@@ -585,13 +1141,7 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
                     // We note down our timestamp
                     ap->endTimeStamp.store(chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now().time_since_epoch()).count());
 
-                    std::string str;
-                    if ( ap->endWaitTime == __LONG_MAX__ ) 
-                        str = "for quit command";
-                    else
-                        str = std::to_string( ap->endWaitTime ) + " ms";
-
-                    CuemsLogger::getLogger()->logInfo("Out of file boundaries, waiting " + str);
+                    ap->rtLogger.log( RtLogger::END_WAIT, ap->endWaitTime );
                 }
                 
                 ap->endOfStream = true;
@@ -599,8 +1149,8 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
                 long int timecodeNow = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now().time_since_epoch()).count();
                 
                 if ( ( timecodeNow - ap->endTimeStamp.load() ) > ap->endWaitTime ) {
-                    CuemsLogger::getLogger()->logInfo("Waiting time exceded, ending audioplayer");
-                    ap->endOfPlay = true;
+                    ap->rtLogger.log( RtLogger::END_WAIT_EXCEEDED );
+                    ap->endPlay();
                     return 1;
                 }
                 
@@ -619,41 +1169,379 @@ int AudioPlayer::audioCallback( void *outputBuffer, void * /*inputBuffer*/, unsi
     {
         // MTC signal lost detection is already handled in the main playing branch above (lines 418-422)
         // No need to duplicate it here
-        memset( (char *)(outputBuffer), 0, nBufferFrames * ap->audioFrameSize );
+        memset( (char *)(outputBuffer), 0, nBufferFrames * ap->outputChannels * ap->headStep );
     }
 
     return 0;
 
 }
 
+////////////////////////////////////////////
+// Audio thread: the one system call it makes, once, to wake main()
+void AudioPlayer::endPlay( void ) {
+    endOfPlay = true;
+
+    if ( endOfPlayEvent >= 0 ) {
+        uint64_t one = 1;
+        if ( write( endOfPlayEvent, &one, sizeof( one ) ) < 0 ) {
+            // Counter full, main() is awake anyway
+        }
+    }
+}
+
+////////////////////////////////////////////
+int AudioPlayer::getEndOfPlayEvent( void ) const {
+    return endOfPlayEvent;
+}
+
+////////////////////////////////////////////
+// Varispeed rate, audio thread only
+void AudioPlayer::setPlaybackRate( double rate ) {
+    if ( rate == playbackRate ) {
+        return;
+    }
+
+    playbackRate = rate;
+
+    if ( streamingMode ) {
+        playingStreamer.load()->setPlaybackRate( rate );
+    }
+    else {
+        playingFile.load()->setPlaybackRate( rate );
+    }
+}
+
+////////////////////////////////////////////
+// Resident memory of the process in KB, 0 if unknown
+static long int residentMemoryKb( void ) {
+    std::ifstream statm( "/proc/self/statm" );
+    long int totalPages = 0, residentPages = 0;
+
+    if ( !( statm >> totalPages >> residentPages ) ) {
+        return 0;
+    }
+
+    return residentPages * ( sysconf( _SC_PAGESIZE ) / 1024 );
+}
+
+////////////////////////////////////////////
+// /stats reply: <oscAddress>/stats with, in this order,
+//  i  callbacks        f  load (avg callback / period)
+//  f  avg callback us  f  p99 callback us  f  max callback us
+//  f  buffer fill 0..1 (-1 when not streaming)
+//  i  device underflows  i  streaming underruns  i  short reads  i  seeks
+//  f  decode us per period  f  drift vs MTC ms  i  resident memory KB
+//  then the startup trace: i  phases, and for each  s  name  f  ms from spawn
+void AudioPlayer::sendStats( const IpEndpointName& destination ) {
+    CallbackStats::Snapshot callbacks = callbackStats.snapshot();
+
+    AudioStreamer* stream = playingStreamer.load();
+    bool streaming = streamingMode.load();
+    double bufferFill = streaming ? stream->getBufferFill() : -1.0;
+    double decodeUs = streaming ? stream->getDecodeUs() : callbacks.decodeUs;
+
+    char buffer[STATS_REPLY_BUFFER_SIZE];
+    osc::OutboundPacketStream packet( buffer, STATS_REPLY_BUFFER_SIZE );
+
+    packet << osc::BeginMessage( ( OscReceiver::oscAddress + "/stats" ).c_str() )
+           << (int32_t) callbacks.callbacks
+           << (float) callbacks.load
+           << (float) callbacks.avgUs
+           << (float) callbacks.p99Us
+           << (float) callbacks.maxUs
+           << (float) bufferFill
+           << (int32_t) callbacks.underflows
+           << (int32_t) stream->getUnderruns()
+           << (int32_t) callbacks.shortReads
+           << (int32_t) callbacks.seeks
+           << (float) decodeUs
+           << (float) callbacks.driftMs
+           << (int32_t) residentMemoryKb();
+
+    std::vector<StartupTrace::Phase> phases = startupTrace.phases();
+    packet << (int32_t) phases.size();
+    for ( const auto& phase : phases ) {
+        packet << phase.name.c_str() << (float) phase.ms;
+    }
+    packet << osc::EndMessage;
+
+    UdpTransmitSocket socket( destination );
+    socket.Send( packet.Data(), packet.Size() );
+}
+
+////////////////////////////////////////////
+// <oscAddress>/voice/<id>/ followed by
+//  load <path>  unload  play  stop  vol <gain>  offset <ms>
+// Ids go from 0 to the number of voices - 1
+void AudioPlayer::processVoiceMessage( const osc::ReceivedMessage& m ) {
+    string address = m.AddressPattern();
+    string rest = address.substr( ( OscReceiver::oscAddress + "/voice/" ).size() );
+
+    size_t slash = rest.find( '/' );
+    char* end = nullptr;
+    unsigned long id = strtoul( rest.c_str(), &end, 10 );
+    if ( slash == string::npos || end != rest.c_str() + slash || slash == 0 || id >= voices.size() ) {
+        CuemsLogger::getLogger()->logWarning( "OSC: no such voice -> " + address );
+        return;
+    }
+
+    Voice& voice = *voices[id];
+    string command = rest.substr( slash + 1 );
+    string name = "OSC: voice " + std::to_string( id ) + " ";
+
+    if ( command == "load" ) {
+        const char* path;
+        m.ArgumentStream() >> path >> osc::EndMessage;
+        if ( voice.load( path, outputChannels, sampleRate, bufferFrames, streamingWanted ) ) {
+            CuemsLogger::getLogger()->logInfo( name + "loaded -> " + path );
+        }
+    } else if ( command == "unload" ) {
+        voice.unload();
+        CuemsLogger::getLogger()->logInfo( name + "unloaded" );
+    } else if ( command == "play" ) {
+        if ( !voice.play() ) {
+            CuemsLogger::getLogger()->logWarning( name + "has nothing loaded" );
+        }
+    } else if ( command == "stop" ) {
+        voice.stop();
+    } else if ( command == "vol" ) {
+        float gain;
+        m.ArgumentStream() >> gain >> osc::EndMessage;
+        voice.setVolume( gain );
+        CuemsLogger::getLogger()->logInfo( name + "volume " + std::to_string( gain ) );
+    } else if ( command == "offset" ) {
+        // Like /offset, in milliseconds, the output latency is added by the callback
+        float offsetOSC;
+        m.ArgumentStream() >> offsetOSC >> osc::EndMessage;
+        long long frames = llround( floor( offsetOSC ) * sampleRate / 1000.0 );
+        voice.setOffset( frames );
+        CuemsLogger::getLogger()->logInfo( name + "offset " + std::to_string( (long int) floor( offsetOSC ) ) );
+    } else {
+        CuemsLogger::getLogger()->logWarning( "OSC: unknown voice command -> " + address );
+    }
+}
+
+////////////////////////////////////////////
+// Queue a control change for the audio thread. With wait, returns once
+// it has been applied, false if the queue is full or the audio thread
+// did not get to it in COMMAND_ACK_TIMEOUT_MS (stream stopped).
+bool AudioPlayer::sendCommand( Command command, bool wait ) {
+    command.id = nextCommandId.fetch_add( 1, std::memory_order_relaxed );
+    command.ack = wait;
+
+    if ( !commands.push( command ) ) {
+        CuemsLogger::getLogger()->logWarning( "Command queue full, change dropped" );
+        return false;
+    }
+
+    if ( !wait ) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock( replyMutex );
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds( COMMAND_ACK_TIMEOUT_MS );
+    while ( chrono::steady_clock::now() < deadline ) {
+        Command reply;
+        while ( replies.pop( reply ) ) {
+            // Older ones are acks somebody stopped waiting for
+            if ( reply.id == command.id ) {
+                return true;
+            }
+        }
+        std::this_thread::sleep_for( chrono::milliseconds( 1 ) );
+    }
+
+    CuemsLogger::getLogger()->logWarning( "Audio thread did not acknowledge a command in " +
+                                          std::to_string( COMMAND_ACK_TIMEOUT_MS ) + " ms" );
+    return false;
+}
+
+////////////////////////////////////////////
+// Hand the file back to the audio thread after a SUSPEND_FILE. Losing
+// it would leave the player silent for good, so a full queue is retried
+// for as long as an ack would be waited for.
+bool AudioPlayer::resumeFile( void ) {
+    Command command{ Command::RESUME_FILE };
+    command.id = nextCommandId.fetch_add( 1, std::memory_order_relaxed );
+
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds( COMMAND_ACK_TIMEOUT_MS );
+    while ( !commands.push( command ) ) {
+        if ( chrono::steady_clock::now() >= deadline ) {
+            CuemsLogger::getLogger()->logError( "Command queue full, the file could not be resumed" );
+            return false;
+        }
+        std::this_thread::sleep_for( chrono::milliseconds( 1 ) );
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////
+// Audio thread, start of a period: everything queued so far takes
+// effect from this period on
+void AudioPlayer::applyCommands( void ) {
+    Command command;
+    while ( commands.pop( command ) ) {
+        switch ( command.type ) {
+            case Command::SET_GAIN:
+                gainStage.setGain( command.channel, command.gain );
+                break;
+            case Command::SET_ALL_GAINS:
+                gainStage.setAllGains( command.gain );
+                break;
+            case Command::FADE:
+                gainStage.fade( command.channel, command.gain, command.value, (GainStage::Curve) command.curve );
+                break;
+            case Command::FADE_ALL:
+                gainStage.fadeAll( command.gain, command.value, (GainStage::Curve) command.curve );
+                break;
+            case Command::OFFSET:
+                headNewOffset.store( command.value );
+                offsetChanged = true;
+                break;
+            case Command::END_WAIT:
+                endWaitTime = command.value;
+                break;
+            case Command::PLAY_TOGGLE:
+                playheadControl = ( playheadControl != 0 ) ? 0 : 1;
+                break;
+            case Command::STOP_ON_LOST:
+                stopOnMTCLost = command.value != 0;
+                break;
+            case Command::MTC_FOLLOW:
+                followingMtc = command.value != 0;
+                break;
+            case Command::SUSPEND_FILE:
+                fileSuspended = true;
+                break;
+            case Command::RESUME_FILE:
+                fileSuspended = false;
+                relocate = true;
+                break;
+        }
+
+        // A waiter gone by now finds it stale and drops it
+        if ( command.ack ) {
+            replies.push( command );
+        }
+    }
+}
+
 ////////////////////////////////////////////
 // OSC process message callback
 void AudioPlayer::ProcessMessage( const osc::ReceivedMessage& m, 
-            const IpEndpointName& /*remoteEndpoint*/ )
+            const IpEndpointName& remoteEndpoint )
 {
     try{
         // Parsing OSC audioplayer messages
         // Volume channel 0
         if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/vol0") ) {
-            // osc::ReceivedMessageArgumentStream args = m.ArgumentStream();
-            // args >> volumeMaster[0] >> osc::EndMessage;
-            m.ArgumentStream() >> volumeMaster[0] >> osc::EndMessage;
-            CuemsLogger::getLogger()->logInfo("OSC: new volume channel 0 " + std::to_string(volumeMaster[0]));
+            float gain;
+            m.ArgumentStream() >> gain >> osc::EndMessage;
+            Command command{ Command::SET_GAIN };
+            command.channel = 0;
+            command.gain = gain;
+            sendCommand( command );
+            CuemsLogger::getLogger()->logInfo("OSC: new volume channel 0 " + std::to_string(gain));
             
         // Volume channel 1
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/vol1") ) {
-            // osc::ReceivedMessageArgumentStream args = m.ArgumentStream();
-            // args >> volumeMaster[1] >> osc::EndMessage;
-            m.ArgumentStream() >> volumeMaster[1] >> osc::EndMessage;
-            CuemsLogger::getLogger()->logInfo("OSC: new volume channel 1 " + std::to_string(volumeMaster[1]));
+            float gain;
+            m.ArgumentStream() >> gain >> osc::EndMessage;
+            Command command{ Command::SET_GAIN };
+            command.channel = 1;
+            command.gain = gain;
+            sendCommand( command );
+            CuemsLogger::getLogger()->logInfo("OSC: new volume channel 1 " + std::to_string(gain));
             
         // Volume master
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/volmaster") ) {
-            // osc::ReceivedMessageArgumentStream args = m.ArgumentStream();
-            // args >> volumeMaster[0] >> osc::EndMessage;
-            m.ArgumentStream() >> volumeMaster[0] >> osc::EndMessage;
-            volumeMaster[1] = volumeMaster[0];
-            CuemsLogger::getLogger()->logInfo("OSC: new volume master " + std::to_string(volumeMaster[0]));
+            float gain;
+            m.ArgumentStream() >> gain >> osc::EndMessage;
+            Command command{ Command::SET_ALL_GAINS };
+            command.gain = gain;
+            sendCommand( command );
+            CuemsLogger::getLogger()->logInfo("OSC: new volume master " + std::to_string(gain));
+
+        // Volume of any channel
+        } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/volch") ) {
+            int32_t channel;
+            float gain;
+            m.ArgumentStream() >> channel >> gain >> osc::EndMessage;
+            if ( channel >= 0 && (unsigned int) channel < nChannels ) {
+                Command command{ Command::SET_GAIN };
+                command.channel = channel;
+                command.gain = gain;
+                sendCommand( command );
+                CuemsLogger::getLogger()->logInfo("OSC: new volume channel " + std::to_string(channel) + " " + std::to_string(gain));
+            }
+
+        // Fade of every channel or of one of them, the audio thread runs it
+        } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/fade") ||
+                    (string) m.AddressPattern() == (OscReceiver::oscAddress + "/fadech") ) {
+            bool oneChannel = (string) m.AddressPattern() == (OscReceiver::oscAddress + "/fadech");
+            int32_t channel = 0;
+            float gain;
+            float milliseconds;
+            const char* curveName = "linear";
+
+            osc::ReceivedMessageArgumentStream args = m.ArgumentStream();
+            if ( oneChannel ) {
+                args >> channel;
+            }
+            args >> gain >> milliseconds;
+            if ( m.ArgumentCount() > ( oneChannel ? 3u : 2u ) ) {
+                args >> curveName;
+            }
+            args >> osc::EndMessage;
+
+            GainStage::Curve curve = GainStage::parseCurve( curveName );
+            unsigned long frames = (unsigned long) llround( std::max( milliseconds, 0.0f ) * sampleRate / 1000.0 );
+
+            Command command{ oneChannel ? Command::FADE : Command::FADE_ALL };
+            command.channel = channel;
+            command.gain = gain;
+            command.value = frames;
+            command.curve = curve;
+
+            if ( !oneChannel ) {
+                sendCommand( command );
+                CuemsLogger::getLogger()->logInfo("OSC: fade to " + std::to_string(gain) + " in " +
+                    std::to_string(milliseconds) + " ms, " + curveName);
+            }
+            else if ( channel >= 0 && (unsigned int) channel < nChannels ) {
+                sendCommand( command );
+                CuemsLogger::getLogger()->logInfo("OSC: fade channel " + std::to_string(channel) + " to " +
+                    std::to_string(gain) + " in " + std::to_string(milliseconds) + " ms, " + curveName);
+            }
+
+        // Routing matrix, file channel to output port
+        } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/route") ) {
+            int32_t input;
+            int32_t output;
+            float gain;
+            m.ArgumentStream() >> input >> output >> gain >> osc::EndMessage;
+            if ( !routingMode ) {
+                CuemsLogger::getLogger()->logWarning("OSC: /route needs the player started with --outputs or --route");
+            }
+            else if ( input >= 0 && output >= 0 ) {
+                // RoutingMatrix publishes its own lock-free snapshots
+                routingMatrix.setGain( input, output, gain );
+                CuemsLogger::getLogger()->logInfo("OSC: route " + std::to_string(input) + " -> " +
+                    std::to_string(output) + " gain " + std::to_string(gain));
+            }
+
+        // Back to the routes we started with
+        } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/route/reset") ) {
+            if ( routingMode ) {
+                if ( initialRoutes.empty() ) {
+                    routingMatrix.setDefault();
+                }
+                else {
+                    routingMatrix.setRoutes( initialRoutes );
+                }
+                CuemsLogger::getLogger()->logInfo("OSC: routes reset");
+            }
 
         // Offset
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/offset") ) {
@@ -668,11 +1556,12 @@ void AudioPlayer::ProcessMessage( const osc::ReceivedMessage& m,
             // Offset argument in OSC command is in milliseconds
             // so we need to calculate in bytes in our file
 
-            headNewOffset.store(( offsetOSC + outputLatencyMs_.load() ) * audioMillisecondSize);  // To bytes
+            Command command{ Command::OFFSET };
+            command.value = ( offsetOSC + outputLatencyMs_.load() ) * audioMillisecondSize;  // To bytes
 
             // Note: With FFmpeg, headers are handled internally - no manual offset needed
 
-            offsetChanged = true;
+            sendCommand( command );
 
         // Wait
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/wait") ) {
@@ -684,53 +1573,98 @@ void AudioPlayer::ProcessMessage( const osc::ReceivedMessage& m,
 
             CuemsLogger::getLogger()->logInfo("OSC: new end wait value " + std::to_string((long int)waitOSC));
 
-            endWaitTime = waitOSC;             // In milliseconds
+            Command command{ Command::END_WAIT };
+            command.value = waitOSC;             // In milliseconds
+            sendCommand( command );
         // Load
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/load") ) {
             const char* newPath;
             m.ArgumentStream() >> newPath >> osc::EndMessage;
-            audioPath = newPath;
             CuemsLogger::getLogger()->logInfo("OSC: /load command");
-            audioFile.close();
+            // The audio thread plays silence meanwhile, and the decoder
+            // thread must let go of the file while we swap it. Unless it
+            // said so the file may still be read, leave it alone.
+            if ( !sendCommand( Command{ Command::SUSPEND_FILE }, true ) ) {
+                CuemsLogger::getLogger()->logError("OSC: /load aborted, the file on air could not be suspended");
+                // Undoes the suspend if it is applied late
+                resumeFile();
+                return;
+            }
+            audioPath = newPath;
+            AudioFstream* file = playingFile.load();
+            AudioStreamer* stream = playingStreamer.load();
+            bool restartStreamer = streamingMode && stream->isRunning();
+            if ( restartStreamer ) stream->stop();
+            file->close();
             CuemsLogger::getLogger()->logInfo("OSC: previous file closed");
-            audioFile.loadFile(audioPath);
+            file->loadFile(audioPath);
+            if ( restartStreamer ) {
+                stream->start( bufferFrames, nChannels, sampleRate );
+                stream->flush();
+            }
+            resumeFile();
             CuemsLogger::getLogger()->logInfo("OSC: loaded new path -> " + audioPath);
+        // Preload the next cue in background
+        } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/preload") ) {
+            const char* cuePath;
+            m.ArgumentStream() >> cuePath >> osc::EndMessage;
+            CuemsLogger::getLogger()->logInfo("OSC: /preload command -> " + string(cuePath));
+            preloadCue( cuePath );
+        // Put the preloaded cue on air
+        } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/swap") ) {
+            CuemsLogger::getLogger()->logInfo("OSC: /swap command");
+            swapCue();
         // Play/pause
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/play") ) {
             CuemsLogger::getLogger()->logInfo("OSC: /play command");
-            if ( playheadControl != 0 )
-                playheadControl = 0;
-            else 
-                playheadControl = 1;
+            sendCommand( Command{ Command::PLAY_TOGGLE } );
         // Stop
         } else if ( (string) m.AddressPattern() == (OscReceiver::oscAddress + "/stop") ) {
             // TO DO : right now is the same as play/pause... Don't know if there 
             //          will be other implementations of the command...
             CuemsLogger::getLogger()->logInfo("OSC: /stop command");
-            if ( playheadControl != 0 )
-                playheadControl = 0;
-            else 
-                playheadControl = 1;
+            sendCommand( Command{ Command::PLAY_TOGGLE } );
         // Quit
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/quit") ) {
             CuemsLogger::getLogger()->logInfo("OSC: /quit command");
-            raise(SIGTERM);
+            kill(getpid(), SIGTERM);     // To the process, the main loop reads it
         // Check
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/check") ) {
             CuemsLogger::getLogger()->logInfo("OSC: /check command");
-            raise(SIGUSR1);
+            kill(getpid(), SIGUSR1);
         // Stop on lost - value: 0 = continue playing, non-zero = stop on MTC lost
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/stoponlost") ) {
             int32_t valueOSC;
             m.ArgumentStream() >> valueOSC >> osc::EndMessage;
-            stopOnMTCLost = (valueOSC != 0);
-            CuemsLogger::getLogger()->logInfo("OSC: /stoponlost set to " + std::to_string(stopOnMTCLost));
+            Command command{ Command::STOP_ON_LOST };
+            command.value = (valueOSC != 0);
+            sendCommand( command );
+            CuemsLogger::getLogger()->logInfo("OSC: /stoponlost set to " + std::to_string(valueOSC != 0));
         // MTC Follow - value: 0 = don't follow MTC, non-zero = follow MTC
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/mtcfollow") ) {
             int32_t valueOSC;
             m.ArgumentStream() >> valueOSC >> osc::EndMessage;
-            followingMtc = (valueOSC != 0);
-            CuemsLogger::getLogger()->logInfo("OSC: /mtcfollow set to " + std::to_string(followingMtc));
+            Command command{ Command::MTC_FOLLOW };
+            command.value = (valueOSC != 0);
+            sendCommand( command );
+            CuemsLogger::getLogger()->logInfo("OSC: /mtcfollow set to " + std::to_string(valueOSC != 0));
+        // Stats - optional value: port to reply to on the sender's host,
+        // otherwise the reply goes back to the sender's endpoint
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/stats") ) {
+            IpEndpointName destination = remoteEndpoint;
+            if ( m.ArgumentCount() > 0 ) {
+                int32_t portOSC;
+                m.ArgumentStream() >> portOSC >> osc::EndMessage;
+                if ( portOSC < 1 || portOSC > 65535 ) {
+                    CuemsLogger::getLogger()->logWarning("OSC: /stats port out of range -> " + std::to_string(portOSC));
+                    return;
+                }
+                destination.port = portOSC;
+            }
+            sendStats( destination );
+        // Voices
+        } else if ( ( (string) m.AddressPattern() ).rfind( OscReceiver::oscAddress + "/voice/", 0 ) == 0 ) {
+            processVoiceMessage( m );
         }
         
     } catch ( osc::Exception& error ) {
@@ -741,6 +1675,16 @@ void AudioPlayer::ProcessMessage( const osc::ReceivedMessage& m,
         CuemsLogger::getLogger()->logError(  "OSC ERR : " + 
                                         (std::string) m.AddressPattern() + 
                                         ": " + (std::string) error.what() );
+    } catch ( std::runtime_error& error ) {
+        // Socket errors while replying
+        CuemsLogger::getLogger()->logError(  "OSC ERR : " + 
+                                        (std::string) m.AddressPattern() + 
+                                        ": " + (std::string) error.what() );
+    } catch ( std::invalid_argument& error ) {
+        // Well formed messages with values we do not know, like fade curves
+        CuemsLogger::getLogger()->logError(  "OSC ERR : " + 
+                                        (std::string) m.AddressPattern() + 
+                                        ": " + (std::string) error.what() );
     }
 }
 
@@ -43,16 +43,59 @@
 #define MTC_FRAMES_TOLERANCE 2
 #endif
 
+#ifndef NULL_BACKEND_BUFFER_FRAMES
+#define NULL_BACKEND_BUFFER_FRAMES 512      // Period size when rendering without a device
+#endif
+
+#ifndef RENDER_MTC_FRAMERATE
+#define RENDER_MTC_FRAMERATE 25             // Frame rate of the scripted MTC when rendering
+#endif
+
+#ifndef STATS_REPLY_BUFFER_SIZE
+#define STATS_REPLY_BUFFER_SIZE 1024        // Bytes for the /stats OSC reply packet
+#endif
+
+#ifndef ROUTING_MAX_FRAMES
+#define ROUTING_MAX_FRAMES 8192             // Longest period the routing buffer holds, unless the configured one is longer
+#endif
+
+#ifndef COMMAND_QUEUE_SIZE
+#define COMMAND_QUEUE_SIZE 256              // Control changes waiting for the next audio period
+#endif
+
+#ifndef COMMAND_ACK_TIMEOUT_MS
+#define COMMAND_ACK_TIMEOUT_MS 500          // Longest wait for the audio thread to apply a command
+#endif
+
+#ifndef MTC_LOCKED_FRAMES_TOLERANCE
+#define MTC_LOCKED_FRAMES_TOLERANCE 1       // Tolerance once the MTC clock is locked and smoothed
+#endif
+
 #include <atomic>
 #include <math.h>
 #include <chrono>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <iostream>
 #include <iomanip>
 #include <csignal>
 #include <rtaudio/RtAudio.h>
 #include <rtmidi/RtMidi.h>
 #include "audiofstream.h"
+#include "audiostreamer.h"
+#include "voice.h"
+#include "decoderpool.h"
+#include "gainstage.h"
+#include "routingmatrix.h"
+#include "commandqueue.h"
+#include "driftcontroller.h"
+#include "mtcclock.h"
+#include "callbackstats.h"
+#include "startuptrace.h"
+#include "rtlogger.h"
+#include "wavwriter.h"
+#include "rtallocguard.h"
 #include "cuemslogger.h"
 #include "cuems_errors.h"
 #include "mtcreceiver.h"
@@ -80,7 +123,21 @@ class AudioPlayer : public OscReceiver
                         unsigned int sRate = 44100,
                         RtAudio::Api audioApi = RtAudio::Api::UNIX_JACK,
                         const string &resampleQuality = "hq",
-                        long explicitLatencyMs = -1 );
+                        long explicitLatencyMs = -1,
+                        const bool streamingFlag = false,
+                        const bool varispeedFlag = false,
+                        unsigned int periodFrames = NULL_BACKEND_BUFFER_FRAMES,
+                        const bool preloadFlag = false,
+                        double preloadMaxSeconds = PRELOAD_MAX_SECONDS,
+                        const string &cacheDirectory = "",
+                        const bool sharedMemoryFlag = false,
+                        unsigned int voiceCount = 0,
+                        unsigned int decoderThreads = 0,
+                        const std::vector<int>& decoderCpus = {},
+                        const bool exponentialRampFlag = false,
+                        unsigned int outputPorts = 0,
+                        const string &routeSpec = "",
+                        const bool fastStartFlag = false );
 
         // Set the audio output-pipeline latency compensation in ms.
         // Values outside [0, 500] are clamped. Thread-safe (atomic).
@@ -89,12 +146,31 @@ class AudioPlayer : public OscReceiver
         // must be set before the JACK query runs.
         void setOutputLatencyMs(long ms);
         ~AudioPlayer( void );
+
+        // Null backend (audioApi RTAUDIO_DUMMY): drive the audio callback
+        // from a virtual clock with scripted MTC starting at 0, writing the
+        // output to a WAV file. As fast as possible unless realTime is set.
+        // seconds <= 0 renders until the end of the file. Prints throughput.
+        int renderToFile( const string& outPath, double seconds = 0, bool realTime = false );
+
+        // Next cue: preloadCue opens, probes and starts decoding a file in
+        // the standby slot on a background thread, swapCue arms the switch,
+        // done by the audio callback at the start of a period once the cue
+        // is ready. The new cue plays from its beginning at that period.
+        bool preloadCue( const string& path );
+        bool isCueReady( void ) const;
+        void swapCue( void );
+
+        // Readable (eventfd) once the audio thread sets endOfPlay, -1 if
+        // it could not be made and endOfPlay has to be polled
+        int getEndOfPlayEvent( void ) const;
         //////////////////////////////////////////
 
         // Audio sample data
         string audioPath;
 
         unsigned int nChannels;                         // Our default number of audio channels
+        unsigned int outputChannels;                    // Output ports opened, nChannels unless routing
         unsigned int sampleRate;                        // Our sample rate
         unsigned int bufferFrames;                      // 2048 sample frames
         string deviceName;
@@ -104,12 +180,26 @@ class AudioPlayer : public OscReceiver
         unsigned int audioMillisecondSize;              // Audio millisecond size in bytes
 
         float* intermediate;                            // Audio samples intermediate buffer (32-bit float for JACK)
-        float* volumeMaster;                            // Volumen master multiplier
+        GainStage gainStage;                            // Per channel volume, ramped over each period
+        RoutingMatrix routingMatrix;                    // File channels to output ports, routing mode only
+        std::vector<float> routeBuffer;                 // File audio of a period before routing
 
         // Our midi, osc and audio objects
+        RtLogger rtLogger;                              // Logging from the audio thread, outlives the stream
         RtAudio audio;
         MtcReceiver mtcReceiver;
+        std::unique_ptr<DecoderPool> decoderPool;       // Shared decoder threads, outlives every streamer
         AudioFstream audioFile;
+        AudioStreamer streamer;                         // Decoder thread feeding the callback in streaming mode
+        AudioFstream cueFile;                           // Second slot, /preload fills whichever is not playing
+        AudioStreamer cueStreamer;
+        std::atomic<AudioFstream*> playingFile;         // Slot on air, switched by the audio thread only
+        std::atomic<AudioStreamer*> playingStreamer;
+        DriftController driftController;                // Varispeed rate from the MTC error
+        MtcClock mtcClock;                              // Jitter filtered MTC timeline
+        CallbackStats callbackStats;                    // Callback timing and xruns, lock free
+        StartupTrace startupTrace;                      // Time from spawn to each start phase, for the log and /stats
+        std::vector<std::unique_ptr<Voice>> voices;     // Extra files mixed on top, fixed count, /voice/<id>/...
 
         // Stream and playing control flags and vars
         static std::atomic <bool> endOfStream;                // Is the end of the stream reached already?
@@ -117,6 +207,11 @@ class AudioPlayer : public OscReceiver
         static std::atomic <bool> outOfFile;                  // Is our head out of our file boundaries?
         std::atomic<long int> endTimeStamp{0};  // Our finish timestamp to calculate end wait (atomic for thread safety)
         bool followingMtc;               // Is player following MTC?
+        std::atomic<bool> streamingMode{false};  // Decode on a background thread instead of in the callback?
+        bool streamingWanted = false;    // Streaming as asked for, cues decide again on their own
+        bool varispeedMode = false;      // Follow MTC drift by nudging the playback rate?
+        bool nullBackend = false;        // No audio device, the callback is driven by renderToFile
+        bool routingMode = false;        // File read in its own channels and routed to outputChannels ports
 
         // Playing head vars and flags
         static std::atomic<long long int> playHead; // Current reading head position in bytes
@@ -124,6 +219,9 @@ class AudioPlayer : public OscReceiver
         // float headSpeed;                       // Head speed (TO DO)
         // float headAccel;                       // Head acceleration (TO DO)
         std::atomic<int> playheadControl = 1;       // Head reading direction
+        double playbackRate = 1.0;                  // Varispeed rate, audio thread only
+        double playHeadFraction = 0.0;              // Sub-frame play head remainder at rates != 1
+        long long sampleClock = 0;                  // Frames handed to the device, audio thread only
 
         unsigned int headStep = 4;              // Head step per channel, FLOAT32 format, 4 bytes
         std::atomic<long int> headOffset{0};    // Head offset (atomic: read/written from multiple threads)
@@ -154,11 +252,88 @@ class AudioPlayer : public OscReceiver
         static int audioCallback(   void *outputBuffer, void * inputBuffer, unsigned int nBufferFrames,
                                     double streamTime, RtAudioStreamStatus status, void *data );
 
+        // Set endOfPlay and wake whoever waits on endOfPlayEvent
+        void endPlay( void );
+        int endOfPlayEvent = -1;
+
+        // Apply a varispeed rate to whichever reader feeds the callback
+        void setPlaybackRate( double rate );
+
+        // Output device: the one named if it is there and suitable, else
+        // the default one, else any. Each device is probed once at most,
+        // JACK opens a client for every probe. fastStart takes the named
+        // device as soon as it is seen. Exits when there is none.
+        int findOutputDevice( bool fastStart );
+        RtAudio::DeviceInfo outputDevice;        // As probed by findOutputDevice
+
+        // File setup shared by the device and null backends, once the
+        // output channels and sample rate are known
+        void startDecoding( void );
+        void setupNullBackend( long int initOffset );
+
+        // Answer an OSC /stats request with our live performance counters
+        void sendStats( const IpEndpointName& destination );
+
+        // Control changes, applied by the audio thread at the start of a
+        // period. Any thread sends, waiting if asked until the audio thread
+        // acknowledges it through the reply queue. Only the audio thread
+        // writes the state they change once the stream runs.
+        struct Command {
+            enum Type : uint8_t {
+                SET_GAIN,           // channel, gain
+                SET_ALL_GAINS,      // gain
+                FADE,               // channel, gain, value frames, curve
+                FADE_ALL,           // gain, value frames, curve
+                OFFSET,             // value bytes
+                END_WAIT,           // value milliseconds
+                PLAY_TOGGLE,
+                STOP_ON_LOST,       // value flag
+                MTC_FOLLOW,         // value flag
+                SUSPEND_FILE,       // The file on air is left alone until
+                RESUME_FILE         // resumed, then relocated
+            };
+            Type type;
+            bool ack = false;       // Echoed on the reply queue once applied
+            uint32_t id = 0;
+            int32_t channel = 0;
+            int32_t curve = 0;
+            float gain = 0.0f;
+            long long value = 0;
+        };
+        CommandQueue<Command, COMMAND_QUEUE_SIZE> commands;
+        CommandQueue<Command, COMMAND_QUEUE_SIZE> replies;
+        std::atomic<uint32_t> nextCommandId{1};
+        std::mutex replyMutex;                   // One waiter on the replies at a time
+        bool fileSuspended = false;              // Audio thread only
+        bool relocate = false;                   // Audio thread only, seek to MTC on next period
+
+        bool sendCommand( Command command, bool wait = false );
+        bool resumeFile( void );                 // RESUME_FILE, retried while the queue is full
+        void applyCommands( void );              // Audio thread, period start
+
+        // Routes given at start, what /route/reset goes back to
+        std::vector<RoutingMatrix::Route> initialRoutes;
+
+        // OSC <oscAddress>/voice/<id>/<command>
+        void processVoiceMessage( const osc::ReceivedMessage& m );
+
+        // Standby cue slot. The OSC thread owns it while LOADING, the
+        // audio thread while SWAPPING, nobody writes it while READY.
+        enum CueState { CUE_EMPTY, CUE_LOADING, CUE_READY, CUE_SWAPPING };
+        std::atomic<int> cueState{CUE_EMPTY};
+        std::atomic<bool> swapRequested{false};
+        bool cueStreaming = false;               // Standby cue is read through its streamer
+        long long cueBase = 0;                   // Audio thread only, file position = playHead + headOffset + cueBase
+        std::thread cueThread;
+
+        void prepareCue( const string path );   // Runs on cueThread
+        void switchCue( void );                 // Audio thread, period start
+
     //////////////////////////////////////////////////////////
     // Protected members
     protected:
         virtual void ProcessMessage(    const osc::ReceivedMessage& m, 
-                                    const IpEndpointName& /*remoteEndpoint*/ );
+                                    const IpEndpointName& remoteEndpoint );
 
 
 };
@@ -0,0 +1,415 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems audio streamer class source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "audiostreamer.h"
+#include "decoderpool.h"
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////
+AudioStreamer::AudioStreamer( AudioFstream& file )
+    : audioFile(file)
+{
+}
+
+////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////
+AudioStreamer::~AudioStreamer( void )
+{
+    stop();
+    delete[] scratch;
+}
+
+////////////////////////////////////////////
+// Start the decoder thread
+////////////////////////////////////////////
+bool AudioStreamer::start( unsigned int periodFrames, unsigned int channels,
+                           unsigned int sampleRate, unsigned int periods )
+{
+    if ( running.load() ) {
+        return true;
+    }
+
+    if ( periodFrames == 0 || channels == 0 || sampleRate == 0 ) {
+        CuemsLogger::getLogger()->logError("Streamer: invalid stream geometry, not starting");
+        return false;
+    }
+
+    // The ring is only allocated once: after that the audio thread may be
+    // reading it at any time, so the geometry stays fixed on restarts
+    if ( !started.load( std::memory_order_acquire ) ) {
+        nChannels = channels;
+        chunkFloats = (size_t) periodFrames * channels;
+        scratch = new float[chunkFloats];
+        ring.allocate( chunkFloats * std::max( periods, 2u ) );
+    }
+
+    // When idle, sleep half a period before checking the ring again
+    idleSleepUs = std::max( 250u, (unsigned int)( 500000.0 * periodFrames / sampleRate ) );
+    streamRate = sampleRate;
+
+    running.store( true );
+    started.store( true, std::memory_order_release );
+
+    // The pool's workers produce for us, else a thread of our own
+    pooled = pool != nullptr && pool->add( this );
+    if ( !pooled ) {
+        decoderThread = std::thread( &AudioStreamer::decoderLoop, this );
+    }
+
+    CuemsLogger::getLogger()->logInfo( string( pooled ? "Streamer: decoding in the pool, " : "Streamer: decoder thread started, " ) +
+                                      std::to_string( ring.size() / nChannels ) + " frames buffered ahead");
+    return true;
+}
+
+////////////////////////////////////////////
+// Stop the decoder thread, the ring is kept
+////////////////////////////////////////////
+void AudioStreamer::stop( void )
+{
+    if ( pooled ) {
+        pool->remove( this );
+        pooled = false;
+    }
+
+    running.store( false );
+
+    if ( decoderThread.joinable() ) {
+        decoderThread.join();
+    }
+}
+
+////////////////////////////////////////////
+// Ask the producer to drop everything buffered
+////////////////////////////////////////////
+void AudioStreamer::flush( void )
+{
+    // Note: a seek posted by the callback at the very same time
+    // is downgraded to a flush, the MTC tolerance check redoes it
+    requestTarget.store( -1, std::memory_order_relaxed );
+    requestSerial.fetch_add( 1, std::memory_order_acq_rel );
+
+    if ( pool != nullptr ) {
+        pool->wake();
+    }
+}
+
+////////////////////////////////////////////
+// Start over on a freshly opened file. Only for a streamer nobody
+// reads from, like the standby cue, so no handshake is needed
+////////////////////////////////////////////
+void AudioStreamer::rewind( void )
+{
+    stop();
+
+    ring.reset();
+    endOfFile.store( false );
+
+    unsigned int request = requestSerial.load();
+    parkedSerial.store( request );
+    ackSerial.store( request );
+
+    seekPending = false;
+    pendingFloats = 0;
+    skipFloats = 0;
+    lastBytesRead = 0;
+}
+
+////////////////////////////////////////////
+void AudioStreamer::setPool( DecoderPool* decoderPool )
+{
+    if ( !running.load() ) {
+        pool = decoderPool;
+    }
+}
+
+////////////////////////////////////////////
+bool AudioStreamer::isRunning( void ) const
+{
+    return running.load();
+}
+
+////////////////////////////////////////////
+// Consumer: read interleaved floats
+////////////////////////////////////////////
+void AudioStreamer::read( char* buffer, size_t bytes )
+{
+    float* out = (float*) buffer;
+    size_t floats = bytes / sizeof(float);
+
+    // Whatever happens we give back a full buffer, either audio or
+    // silence, so the play head keeps running in real time. Silence
+    // played in place of audio is dropped later to stay aligned.
+    lastBytesRead = bytes;
+
+    if ( !started.load( std::memory_order_acquire ) ) {
+        memset( buffer, 0, bytes );
+        if ( seekPending ) pendingFloats += floats;
+        else skipFloats += floats;
+        return;
+    }
+
+    // Seek or flush in progress, stay off the ring until acknowledged
+    unsigned int request = requestSerial.load( std::memory_order_acquire );
+    if ( request != ackSerial.load( std::memory_order_acquire ) ) {
+        parkedSerial.store( request, std::memory_order_release );
+        memset( buffer, 0, bytes );
+        if ( seekPending ) pendingFloats += floats;
+        return;
+    }
+
+    if ( seekPending ) {
+        // First period after our seek: the ring starts at the requested
+        // position, but the play head already ran while we waited
+        seekPending = false;
+        skipFloats = pendingFloats;
+        pendingFloats = 0;
+    }
+
+    if ( skipFloats > 0 ) {
+        skipFloats -= ring.skip( skipFloats );
+    }
+
+    size_t got = ring.read( out, floats );
+
+    if ( got < floats && endOfFile.load( std::memory_order_acquire ) ) {
+        // Anything written before the EOF mark is visible now
+        got += ring.read( out + got, floats - got );
+
+        if ( got < floats ) {
+            lastBytesRead = got * sizeof(float);
+            return;
+        }
+    }
+
+    if ( got < floats ) {
+        // Decoder fell behind: play silence and catch up later
+        memset( out + got, 0, ( floats - got ) * sizeof(float) );
+        skipFloats += floats - got;
+        underruns.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+////////////////////////////////////////////
+// Consumer: request an absolute seek
+////////////////////////////////////////////
+void AudioStreamer::seekg( long long pos, ios_base::seekdir dir )
+{
+    // The callback only issues absolute seeks, the consumer does
+    // not track a position of its own to resolve relative ones
+    if ( dir != ios_base::beg ) {
+        return;
+    }
+
+    requestTarget.store( pos, std::memory_order_relaxed );
+    unsigned int request = requestSerial.fetch_add( 1, std::memory_order_acq_rel ) + 1;
+    parkedSerial.store( request, std::memory_order_release );
+
+    seekPending = true;
+    pendingFloats = 0;
+    skipFloats = 0;
+
+    if ( pool != nullptr ) {
+        pool->wake();
+    }
+}
+
+////////////////////////////////////////////
+streamsize AudioStreamer::gcount( void ) const
+{
+    return lastBytesRead;
+}
+
+////////////////////////////////////////////
+bool AudioStreamer::eof( void ) const
+{
+    return endOfFile.load( std::memory_order_acquire ) &&
+           requestSerial.load( std::memory_order_acquire ) == ackSerial.load( std::memory_order_acquire ) &&
+           ring.readAvailable() == 0;
+}
+
+////////////////////////////////////////////
+void AudioStreamer::clear( void )
+{
+    // EOF state belongs to the producer, it is reset on every seek
+}
+
+////////////////////////////////////////////
+// Producer: one unit of decoding work
+////////////////////////////////////////////
+bool AudioStreamer::fill( void )
+{
+    unsigned int request = requestSerial.load( std::memory_order_acquire );
+
+    if ( request != ackSerial.load( std::memory_order_relaxed ) ) {
+        // Wait for the consumer to let go of the ring
+        if ( parkedSerial.load( std::memory_order_acquire ) != request ) {
+            return false;
+        }
+
+        ring.reset();
+
+        long long target = requestTarget.load( std::memory_order_relaxed );
+        if ( target >= 0 ) {
+            if ( audioFile.eof() ) {
+                audioFile.clear();
+            }
+            audioFile.seekg( target, ios_base::beg );
+        }
+
+        endOfFile.store( false, std::memory_order_relaxed );
+        ackSerial.store( request, std::memory_order_release );
+        return true;
+    }
+
+    if ( endOfFile.load( std::memory_order_relaxed ) || ring.writeAvailable() < chunkFloats ) {
+        return false;
+    }
+
+    // Varispeed: the rate takes effect from the next decoded period
+    audioFile.setPlaybackRate( playbackRate.load( std::memory_order_relaxed ) );
+
+    auto decodeStart = std::chrono::steady_clock::now();
+    audioFile.read( (char*) scratch, chunkFloats * sizeof(float) );
+    size_t got = audioFile.gcount() / sizeof(float);
+
+    decodeTotalNs.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - decodeStart ).count(), std::memory_order_relaxed );
+    decodes.fetch_add( 1, std::memory_order_relaxed );
+
+    ring.write( scratch, got );
+
+    // AudioFstream only returns short reads at the end of the file or on error
+    if ( got < chunkFloats ) {
+        endOfFile.store( true, std::memory_order_release );
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////
+// Consumer: lets an offline driver wait for the producer
+////////////////////////////////////////////
+bool AudioStreamer::isBuffered( size_t floats ) const
+{
+    if ( !started.load( std::memory_order_acquire ) ) {
+        return true;
+    }
+
+    unsigned int request = requestSerial.load( std::memory_order_acquire );
+    if ( request != ackSerial.load( std::memory_order_acquire ) ) {
+        // Only worth waiting once we are parked, else we must read to park
+        return parkedSerial.load( std::memory_order_acquire ) != request;
+    }
+
+    // After a seek the silence played meanwhile is skipped first
+    size_t skip = seekPending ? pendingFloats : skipFloats;
+    return endOfFile.load( std::memory_order_acquire ) ||
+           ring.readAvailable() >= floats + skip;
+}
+
+////////////////////////////////////////////
+void AudioStreamer::setPlaybackRate( double rate )
+{
+    playbackRate.store( rate, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+unsigned long long AudioStreamer::getUnderruns( void ) const
+{
+    return underruns.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+double AudioStreamer::getBufferFill( void ) const
+{
+    if ( !started.load( std::memory_order_acquire ) || ring.size() == 0 ) {
+        return 0.0;
+    }
+
+    return std::min( 1.0, (double) ring.readAvailable() / ring.size() );
+}
+
+////////////////////////////////////////////
+long long AudioStreamer::getDeadlineUs( void ) const
+{
+    if ( !started.load( std::memory_order_acquire ) || streamRate == 0 ) {
+        return -1;
+    }
+
+    // A seek can only be served once the consumer is parked
+    unsigned int request = requestSerial.load( std::memory_order_acquire );
+    if ( request != ackSerial.load( std::memory_order_acquire ) ) {
+        return parkedSerial.load( std::memory_order_acquire ) == request ? 0 : -1;
+    }
+
+    if ( endOfFile.load( std::memory_order_acquire ) || ring.writeAvailable() < chunkFloats ) {
+        return -1;
+    }
+
+    return (long long)( ring.readAvailable() / nChannels ) * 1000000LL / streamRate;
+}
+
+////////////////////////////////////////////
+unsigned int AudioStreamer::getIdleSleepUs( void ) const
+{
+    return idleSleepUs;
+}
+
+////////////////////////////////////////////
+double AudioStreamer::getDecodeUs( void ) const
+{
+    unsigned long long count = decodes.load( std::memory_order_relaxed );
+    if ( count == 0 ) {
+        return 0.0;
+    }
+
+    return decodeTotalNs.load( std::memory_order_relaxed ) / 1000.0 / count;
+}
+
+////////////////////////////////////////////
+// Decoder thread main loop
+////////////////////////////////////////////
+void AudioStreamer::decoderLoop( void )
+{
+    while ( running.load() ) {
+        if ( !fill() ) {
+            std::this_thread::sleep_for( std::chrono::microseconds( idleSleepUs ) );
+        }
+    }
+}
@@ -0,0 +1,134 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems audio streamer class header file
+// Background decoding of an AudioFstream into a ring buffer
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef AUDIOSTREAMER_H
+#define AUDIOSTREAMER_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef STREAMER_BUFFER_PERIODS
+#define STREAMER_BUFFER_PERIODS 8           // Audio periods decoded ahead of the callback
+#endif
+
+#include <atomic>
+#include <thread>
+#include <iostream>
+#include "audiofstream.h"
+#include "ringbuffer.h"
+#include "cuemslogger.h"
+
+using namespace std;
+
+class DecoderPool;
+
+class AudioStreamer
+{
+    public:
+        AudioStreamer( AudioFstream& file );
+        ~AudioStreamer( void );
+
+        // Control side (not real-time safe)
+        bool start( unsigned int periodFrames, unsigned int channels,
+                    unsigned int sampleRate, unsigned int periods = STREAMER_BUFFER_PERIODS );
+        void stop( void );
+        void flush( void );                 // Drop buffered audio, e.g. after reloading the file
+        void rewind( void );                // Forget all state, only while stopped and not being read
+        bool isRunning( void ) const;
+        void setPool( DecoderPool* decoderPool );   // Before start: produced by the pool, no thread of our own
+
+        // Consumer side, audio thread only. Same stream-like interface
+        // as AudioFstream so the callback can use either of them.
+        void read( char* buffer, size_t bytes );
+        void seekg( long long pos, ios_base::seekdir dir );
+        streamsize gcount( void ) const;
+        bool eof( void ) const;
+        void clear( void );
+        void setPlaybackRate( double rate );    // Varispeed, applied by the producer
+        bool isBuffered( size_t floats ) const; // Would a read of that size be served without underrun?
+
+        // Producer side: decodes one period into the ring if there is
+        // room or services a pending seek. Returns true if it did work.
+        bool fill( void );
+
+        // Microseconds of audio buffered ahead of the consumer, the time
+        // left to the next underrun. 0 with a seek ready to be served, -1
+        // when there is nothing to do. Any thread, schedules the producer.
+        long long getDeadlineUs( void ) const;
+        unsigned int getIdleSleepUs( void ) const;  // Half a period, how long to wait with nothing to do
+
+        unsigned long long getUnderruns( void ) const;
+        double getBufferFill( void ) const;     // Ring fill level 0..1, any thread
+        double getDecodeUs( void ) const;       // Average time to decode one period
+
+    private:
+        AudioFstream& audioFile;
+        RingBuffer<float> ring;
+
+        std::thread decoderThread;
+        DecoderPool* pool = nullptr;
+        bool pooled = false;                    // Registered in the pool right now
+        std::atomic<bool> running{false};
+        std::atomic<bool> started{false};       // Ring allocated and producer alive
+
+        // Producer scratch, one period of interleaved floats
+        float* scratch = nullptr;
+        size_t chunkFloats = 0;
+        unsigned int nChannels = 0;
+        unsigned int streamRate = 0;
+        unsigned int idleSleepUs = 1000;
+
+        // Seek / flush handshake. The consumer posts a request and parks
+        // (stops touching the ring), the producer waits for the park,
+        // repositions the file, empties the ring and acknowledges.
+        std::atomic<long long> requestTarget{-1};   // Byte position, -1 = flush only
+        std::atomic<unsigned int> requestSerial{0};
+        std::atomic<unsigned int> parkedSerial{0};
+        std::atomic<unsigned int> ackSerial{0};
+        std::atomic<bool> endOfFile{false};         // Producer has written the last sample
+        std::atomic<double> playbackRate{1.0};
+
+        // Consumer only state
+        bool seekPending = false;
+        size_t pendingFloats = 0;           // Silence played while a seek was pending
+        size_t skipFloats = 0;              // Samples to drop to stay aligned with the play head
+        streamsize lastBytesRead = 0;
+
+        std::atomic<unsigned long long> underruns{0};
+        std::atomic<unsigned long long> decodes{0};
+        std::atomic<unsigned long long> decodeTotalNs{0};
+
+        void decoderLoop( void );
+};
+
+#endif // AUDIOSTREAMER_H
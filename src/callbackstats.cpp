@@ -0,0 +1,191 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems audio callback statistics source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "callbackstats.h"
+
+////////////////////////////////////////////
+// Log-linear buckets: values below CALLBACK_STATS_SUBBUCKETS get their
+// own bucket, above that every octave is split in SUBBUCKETS parts
+////////////////////////////////////////////
+unsigned int CallbackStats::bucketFor( uint32_t microseconds )
+{
+    if ( microseconds < CALLBACK_STATS_SUBBUCKETS ) {
+        return microseconds;
+    }
+
+    unsigned int msb = 31 - __builtin_clz( microseconds );      // >= 2
+    unsigned int sub = ( microseconds >> ( msb - 2 ) ) & ( CALLBACK_STATS_SUBBUCKETS - 1 );
+    unsigned int bucket = ( msb - 1 ) * CALLBACK_STATS_SUBBUCKETS + sub;
+
+    return bucket < CALLBACK_STATS_BUCKETS ? bucket : CALLBACK_STATS_BUCKETS - 1;
+}
+
+////////////////////////////////////////////
+uint32_t CallbackStats::bucketUpperBound( unsigned int bucket )
+{
+    if ( bucket < CALLBACK_STATS_SUBBUCKETS ) {
+        return bucket + 1;
+    }
+
+    unsigned int msb = bucket / CALLBACK_STATS_SUBBUCKETS + 1;
+    unsigned int sub = bucket % CALLBACK_STATS_SUBBUCKETS;
+
+    return ( (uint32_t)( CALLBACK_STATS_SUBBUCKETS + sub + 1 ) << ( msb - 2 ) );
+}
+
+////////////////////////////////////////////
+void CallbackStats::recordCallback( uint32_t microseconds )
+{
+    histogram[bucketFor( microseconds )].fetch_add( 1, std::memory_order_relaxed );
+    totalUs.fetch_add( microseconds, std::memory_order_relaxed );
+    lastUs.store( microseconds, std::memory_order_relaxed );
+
+    // Single writer, no compare and swap needed
+    if ( microseconds > maxUs.load( std::memory_order_relaxed ) ) {
+        maxUs.store( microseconds, std::memory_order_relaxed );
+    }
+
+    callbacks.fetch_add( 1, std::memory_order_release );
+}
+
+////////////////////////////////////////////
+void CallbackStats::recordUnderflow( void )
+{
+    underflows.fetch_add( 1, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void CallbackStats::recordShortRead( void )
+{
+    shortReads.fetch_add( 1, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void CallbackStats::recordSeek( void )
+{
+    seeks.fetch_add( 1, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void CallbackStats::recordDecode( uint64_t nanoseconds )
+{
+    decodeTotalNs.fetch_add( nanoseconds, std::memory_order_relaxed );
+    decodes.fetch_add( 1, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void CallbackStats::recordDrift( double milliseconds )
+{
+    driftMs.store( milliseconds, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void CallbackStats::setPeriod( unsigned int frames, unsigned int sampleRate )
+{
+    if ( sampleRate > 0 ) {
+        periodUs.store( frames * 1000000.0 / sampleRate, std::memory_order_relaxed );
+    }
+}
+
+////////////////////////////////////////////
+CallbackStats::Snapshot CallbackStats::snapshot( void ) const
+{
+    Snapshot snap;
+
+    snap.callbacks = callbacks.load( std::memory_order_acquire );
+    snap.underflows = underflows.load( std::memory_order_relaxed );
+    snap.shortReads = shortReads.load( std::memory_order_relaxed );
+    snap.seeks = seeks.load( std::memory_order_relaxed );
+    snap.lastUs = lastUs.load( std::memory_order_relaxed );
+    snap.maxUs = maxUs.load( std::memory_order_relaxed );
+    snap.periodUs = periodUs.load( std::memory_order_relaxed );
+    snap.driftMs = driftMs.load( std::memory_order_relaxed );
+
+    uint64_t decodeCount = decodes.load( std::memory_order_relaxed );
+    if ( decodeCount > 0 ) {
+        snap.decodeUs = decodeTotalNs.load( std::memory_order_relaxed ) / 1000.0 / decodeCount;
+    }
+
+    if ( snap.callbacks == 0 ) {
+        return snap;
+    }
+
+    snap.avgUs = (double) totalUs.load( std::memory_order_relaxed ) / snap.callbacks;
+    if ( snap.periodUs > 0.0 ) {
+        snap.load = snap.avgUs / snap.periodUs;
+    }
+
+    // Percentiles from a local copy of the histogram
+    uint64_t counts[CALLBACK_STATS_BUCKETS];
+    uint64_t total = 0;
+    for ( unsigned int i = 0; i < CALLBACK_STATS_BUCKETS; i++ ) {
+        counts[i] = histogram[i].load( std::memory_order_relaxed );
+        total += counts[i];
+    }
+
+    const double ranks[3] = { 0.50, 0.95, 0.99 };
+    double* targets[3] = { &snap.p50Us, &snap.p95Us, &snap.p99Us };
+    for ( int r = 0; r < 3; r++ ) {
+        uint64_t needed = (uint64_t)( ranks[r] * total + 0.5 );
+        uint64_t seen = 0;
+        for ( unsigned int i = 0; i < CALLBACK_STATS_BUCKETS; i++ ) {
+            seen += counts[i];
+            if ( seen >= needed && seen > 0 ) {
+                *targets[r] = bucketUpperBound( i );
+                break;
+            }
+        }
+    }
+
+    return snap;
+}
+
+////////////////////////////////////////////
+void CallbackStats::reset( void )
+{
+    for ( auto& bucket : histogram ) {
+        bucket.store( 0, std::memory_order_relaxed );
+    }
+    totalUs.store( 0, std::memory_order_relaxed );
+    lastUs.store( 0, std::memory_order_relaxed );
+    maxUs.store( 0, std::memory_order_relaxed );
+    underflows.store( 0, std::memory_order_relaxed );
+    shortReads.store( 0, std::memory_order_relaxed );
+    seeks.store( 0, std::memory_order_relaxed );
+    decodes.store( 0, std::memory_order_relaxed );
+    decodeTotalNs.store( 0, std::memory_order_relaxed );
+    driftMs.store( 0.0, std::memory_order_relaxed );
+    callbacks.store( 0, std::memory_order_release );
+}
@@ -0,0 +1,119 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems audio callback statistics header file
+//
+// Written from the audio thread with relaxed atomics only (single
+// writer), readable from any thread at any time without disturbing
+// playback. Readers get a consistent enough snapshot, counters may be
+// one callback apart from each other.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef CALLBACKSTATS_H
+#define CALLBACKSTATS_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#define CALLBACK_STATS_SUBBUCKETS 4         // Histogram buckets per octave of microseconds
+#define CALLBACK_STATS_BUCKETS 72           // Covers up to ~130 ms
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class CallbackStats
+{
+    public:
+        struct Snapshot {
+            uint64_t callbacks = 0;
+            uint64_t underflows = 0;        // Device reported output underflows (xruns)
+            uint64_t shortReads = 0;        // Periods the file gave less than asked
+            uint64_t seeks = 0;             // Corrective seeks issued by the callback
+            double lastUs = 0.0;
+            double avgUs = 0.0;
+            double maxUs = 0.0;
+            double p50Us = 0.0;             // Percentiles are bucket upper bounds
+            double p95Us = 0.0;
+            double p99Us = 0.0;
+            double periodUs = 0.0;          // Time budget of one period
+            double load = 0.0;              // Average callback time / period, 0..1+
+            double decodeUs = 0.0;          // Average file read time inside the callback
+            double driftMs = 0.0;           // Last play head minus MTC head
+        };
+
+        // Audio thread
+        void recordCallback( uint32_t microseconds );
+        void recordUnderflow( void );
+        void recordShortRead( void );
+        void recordSeek( void );
+        void recordDecode( uint64_t nanoseconds );
+        void recordDrift( double milliseconds );
+
+        // Any thread
+        void setPeriod( unsigned int frames, unsigned int sampleRate );
+        Snapshot snapshot( void ) const;
+        void reset( void );                 // Approximate while the callback runs
+
+        static unsigned int bucketFor( uint32_t microseconds );
+        static uint32_t bucketUpperBound( unsigned int bucket );
+
+        // Scope timer for the callback, records on every return path
+        class Timer
+        {
+            public:
+                Timer( CallbackStats& stats )
+                    : stats(stats), start(std::chrono::steady_clock::now()) {}
+                ~Timer( void ) {
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+                    stats.recordCallback( (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>( elapsed ).count() );
+                }
+
+            private:
+                CallbackStats& stats;
+                std::chrono::steady_clock::time_point start;
+        };
+
+    private:
+        std::atomic<uint64_t> histogram[CALLBACK_STATS_BUCKETS] = {};
+        std::atomic<uint64_t> callbacks{0};
+        std::atomic<uint64_t> totalUs{0};
+        std::atomic<uint32_t> lastUs{0};
+        std::atomic<uint32_t> maxUs{0};
+        std::atomic<uint64_t> underflows{0};
+        std::atomic<uint64_t> shortReads{0};
+        std::atomic<uint64_t> seeks{0};
+        std::atomic<uint64_t> decodes{0};
+        std::atomic<uint64_t> decodeTotalNs{0};
+        std::atomic<double> driftMs{0.0};
+        std::atomic<double> periodUs{0.0};
+};
+
+#endif // CALLBACKSTATS_H
@@ -0,0 +1,134 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems multiple producer / single consumer
+// lock-free command queue template header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+////////////////////////////////////////////
+// Bounded queue of small plain structs, any number of threads push and
+// one thread pops, none of them ever blocks or allocates. Each cell has
+// a sequence number telling whose turn it is (D. Vyukov's bounded
+// queue): a producer claims a position with a CAS on the push counter,
+// fills the cell and then hands it over through the sequence.
+//
+// push() fails when the queue is full. pop() fails when it is empty,
+// and also while the oldest push is still being written; the item
+// comes out on the next pop.
+////////////////////////////////////////////
+template <typename T, size_t Capacity>
+class CommandQueue
+{
+    static_assert( Capacity >= 2 && ( Capacity & ( Capacity - 1 ) ) == 0,
+                   "CommandQueue capacity must be a power of two" );
+    static_assert( std::is_trivially_copyable<T>::value,
+                   "CommandQueue items are copied around as plain data" );
+
+    public:
+        CommandQueue( void ) {
+            for ( size_t i = 0; i < Capacity; i++ ) {
+                cells[i].sequence.store( i, std::memory_order_relaxed );
+            }
+        }
+
+        CommandQueue( const CommandQueue& ) = delete;
+        CommandQueue& operator=( const CommandQueue& ) = delete;
+
+        // Any thread
+        bool push( const T& item ) {
+            size_t position = pushPosition.load( std::memory_order_relaxed );
+            Cell* cell;
+
+            for ( ;; ) {
+                cell = &cells[position & ( Capacity - 1 )];
+                size_t sequence = cell->sequence.load( std::memory_order_acquire );
+                intptr_t turn = (intptr_t) sequence - (intptr_t) position;
+
+                if ( turn == 0 ) {
+                    // Free and ours if nobody claims it first
+                    if ( pushPosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) ) {
+                        break;
+                    }
+                }
+                else if ( turn < 0 ) {
+                    // Still holds an item from one lap ago
+                    return false;
+                }
+                else {
+                    // Another producer got it, try the next one
+                    position = pushPosition.load( std::memory_order_relaxed );
+                }
+            }
+
+            cell->item = item;
+            cell->sequence.store( position + 1, std::memory_order_release );
+            return true;
+        }
+
+        // Consumer thread only
+        bool pop( T& item ) {
+            Cell* cell = &cells[popPosition & ( Capacity - 1 )];
+            size_t sequence = cell->sequence.load( std::memory_order_acquire );
+
+            if ( sequence != popPosition + 1 ) {
+                return false;
+            }
+
+            item = cell->item;
+            cell->sequence.store( popPosition + Capacity, std::memory_order_release );
+            popPosition++;
+            return true;
+        }
+
+        static constexpr size_t size( void ) { return Capacity; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T item;
+        };
+
+        Cell cells[Capacity];
+
+        // Separate cache lines so producers and the consumer don't false share
+        alignas(64) std::atomic<size_t> pushPosition{0};
+        alignas(64) size_t popPosition = 0;
+};
+
+#endif // COMMANDQUEUE_H
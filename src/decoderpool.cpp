@@ -0,0 +1,288 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems decoder pool source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "decoderpool.h"
+#include "audiostreamer.h"
+#include "cuemslogger.h"
+#include <sstream>
+#include <stdexcept>
+#include <climits>
+#include <pthread.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert( sizeof( std::atomic<int> ) == sizeof( int ), "futex word must be a plain int" );
+
+////////////////////////////////////////////
+// Constructor, the workers start right away
+////////////////////////////////////////////
+DecoderPool::DecoderPool( unsigned int workers, const std::vector<int>& cpus )
+    : workerCount( std::max( workers, 1u ) ),
+      cpuList( cpus )
+{
+    for ( unsigned int i = 0; i < workerCount; i++ ) {
+        threads.emplace_back( &DecoderPool::workerLoop, this, i );
+
+        if ( !cpuList.empty() ) {
+            cpu_set_t set;
+            CPU_ZERO( &set );
+            CPU_SET( cpuList[ i % cpuList.size() ], &set );
+
+            if ( pthread_setaffinity_np( threads.back().native_handle(), sizeof(set), &set ) != 0 ) {
+                CuemsLogger::getLogger()->logWarning( "Decoder pool: could not pin worker " + std::to_string(i) +
+                                                      " to CPU " + std::to_string( cpuList[ i % cpuList.size() ] ) );
+            }
+        }
+    }
+
+    CuemsLogger::getLogger()->logInfo( "Decoder pool: " + std::to_string( workerCount ) + " workers" );
+}
+
+////////////////////////////////////////////
+// Destructor, streams still registered are dropped
+////////////////////////////////////////////
+DecoderPool::~DecoderPool( void )
+{
+    running.store( false );
+    wake();
+
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    CuemsLogger::getLogger()->logInfo( "Decoder pool: " + std::to_string( fills.load() ) + " periods decoded, " +
+                                       std::to_string( steals.load() ) + " stolen" );
+}
+
+////////////////////////////////////////////
+bool DecoderPool::add( AudioStreamer* stream )
+{
+    for ( auto& slot : slots ) {
+        AudioStreamer* empty = nullptr;
+        if ( slot.stream.compare_exchange_strong( empty, stream ) ) {
+            wake();
+            return true;
+        }
+    }
+
+    CuemsLogger::getLogger()->logWarning( "Decoder pool: full, stream not added" );
+    return false;
+}
+
+////////////////////////////////////////////
+// Workers raise busy (to fill) or readers (to scan) before loading the
+// stream again, so once we see both down with the slot already cleared
+// nobody will touch it
+////////////////////////////////////////////
+void DecoderPool::remove( AudioStreamer* stream )
+{
+    for ( auto& slot : slots ) {
+        AudioStreamer* current = stream;
+        if ( slot.stream.compare_exchange_strong( current, nullptr ) ) {
+            while ( slot.busy.load() || slot.readers.load() != 0 ) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////
+// A single syscall, and only when some worker is parked
+////////////////////////////////////////////
+void DecoderPool::wake( void )
+{
+    wakeSerial.fetch_add( 1 );
+    if ( sleepers.load() != 0 ) {
+        syscall( SYS_futex, (int*) &wakeSerial, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0 );
+    }
+}
+
+////////////////////////////////////////////
+// Sleep until woken or timeoutUs (0 for no timeout), unless a wake()
+// came after serial was read
+////////////////////////////////////////////
+void DecoderPool::park( int serial, unsigned int timeoutUs )
+{
+    struct timespec timeout = { (time_t)( timeoutUs / 1000000 ), (long)( timeoutUs % 1000000 ) * 1000 };
+
+    sleepers.fetch_add( 1 );
+    syscall( SYS_futex, (int*) &wakeSerial, FUTEX_WAIT_PRIVATE, serial,
+             timeoutUs > 0 ? &timeout : nullptr, nullptr, 0 );
+    sleepers.fetch_sub( 1 );
+}
+
+////////////////////////////////////////////
+unsigned int DecoderPool::getWorkers( void ) const
+{
+    return workerCount;
+}
+
+////////////////////////////////////////////
+unsigned long long DecoderPool::getFills( void ) const
+{
+    return fills.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+unsigned long long DecoderPool::getSteals( void ) const
+{
+    return steals.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+std::vector<int> DecoderPool::parseCpuList( const std::string& list )
+{
+    std::vector<int> cpus;
+    std::stringstream items( list );
+    std::string item;
+
+    while ( std::getline( items, item, ',' ) ) {
+        size_t used = 0;
+        size_t dash = item.find( '-' );
+
+        int first = std::stoi( item.substr( 0, dash ), &used );
+        int last = first;
+        if ( used != item.substr( 0, dash ).size() ) {
+            throw std::invalid_argument( "bad CPU " + item );
+        }
+
+        if ( dash != std::string::npos ) {
+            last = std::stoi( item.substr( dash + 1 ), &used );
+            if ( used != item.size() - dash - 1 ) {
+                throw std::invalid_argument( "bad CPU range " + item );
+            }
+        }
+
+        if ( first < 0 || last < first || last >= CPU_SETSIZE ) {
+            throw std::invalid_argument( "bad CPU range " + item );
+        }
+
+        for ( int cpu = first; cpu <= last; cpu++ ) {
+            cpus.push_back( cpu );
+        }
+    }
+
+    return cpus;
+}
+
+////////////////////////////////////////////
+// Fill one period of a stream if no other worker is at it
+////////////////////////////////////////////
+bool DecoderPool::service( unsigned int index, AudioStreamer* stream )
+{
+    Slot& slot = slots[index];
+
+    if ( slot.busy.exchange( true ) ) {
+        return false;
+    }
+
+    bool worked = false;
+    if ( slot.stream.load() == stream ) {
+        worked = stream->fill();
+    }
+
+    slot.busy.store( false, std::memory_order_release );
+    return worked;
+}
+
+////////////////////////////////////////////
+// Earliest deadline first, own streams before the others' unless
+// we have nothing to do or theirs are about to run dry
+////////////////////////////////////////////
+void DecoderPool::workerLoop( unsigned int index )
+{
+    while ( running.load() ) {
+        // Read before the scan, a wake() during it cancels the park
+        int serial = wakeSerial.load();
+        unsigned int idleUs = 0;
+
+        int own = -1, other = -1;
+        long long ownDeadline = 0, otherDeadline = 0;
+        AudioStreamer* ownStream = nullptr;
+        AudioStreamer* otherStream = nullptr;
+
+        for ( unsigned int i = 0; i < DECODER_POOL_MAX_STREAMS; i++ ) {
+            Slot& slot = slots[i];
+            if ( slot.stream.load( std::memory_order_relaxed ) == nullptr ||
+                 slot.busy.load( std::memory_order_relaxed ) ) {
+                continue;
+            }
+
+            // Pinned while we read the deadline, remove() waits for us
+            slot.readers.fetch_add( 1 );
+            AudioStreamer* stream = slot.stream.load();
+            long long deadline = -1;
+            if ( stream != nullptr ) {
+                deadline = stream->getDeadlineUs();
+                unsigned int streamIdleUs = stream->getIdleSleepUs();
+                if ( idleUs == 0 || streamIdleUs < idleUs ) {
+                    idleUs = streamIdleUs;
+                }
+            }
+            slot.readers.fetch_sub( 1, std::memory_order_release );
+
+            if ( deadline < 0 ) {
+                continue;
+            }
+
+            if ( i % workerCount == index ) {
+                if ( own < 0 || deadline < ownDeadline ) {
+                    own = i; ownDeadline = deadline; ownStream = stream;
+                }
+            }
+            else if ( other < 0 || deadline < otherDeadline ) {
+                other = i; otherDeadline = deadline; otherStream = stream;
+            }
+        }
+
+        bool steal = other >= 0 &&
+                     ( own < 0 || ( otherDeadline < DECODER_POOL_URGENT_US && otherDeadline < ownDeadline ) );
+
+        if ( steal && service( other, otherStream ) ) {
+            fills.fetch_add( 1, std::memory_order_relaxed );
+            steals.fetch_add( 1, std::memory_order_relaxed );
+            continue;
+        }
+
+        if ( own >= 0 && service( own, ownStream ) ) {
+            fills.fetch_add( 1, std::memory_order_relaxed );
+            continue;
+        }
+
+        park( serial, idleUs );
+    }
+}
@@ -0,0 +1,113 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems decoder pool header file
+//
+// A fixed set of worker threads producing for many AudioStreamers,
+// instead of one decoder thread each. Every stream has a home worker,
+// workers serve the stream closest to running dry (its deadline) and
+// take streams from the others when idle or when one of those is about
+// to underrun. A stream is only ever filled by one worker at a time.
+// With nothing to decode workers park on a futex: woken by new streams
+// and seek or flush requests, else after half the shortest period of
+// the streams they serve (so when a period has been played), or never
+// while the pool has no streams at all.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef DECODERPOOL_H
+#define DECODERPOOL_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef DECODER_POOL_MAX_STREAMS
+#define DECODER_POOL_MAX_STREAMS 160        // Streams one pool can serve
+#endif
+
+#ifndef DECODER_POOL_URGENT_US
+#define DECODER_POOL_URGENT_US 10000        // Deadline under which other workers' streams are stolen
+#endif
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+
+class AudioStreamer;
+
+class DecoderPool
+{
+    public:
+        // cpus: worker i is pinned to cpus[i % size], none when empty
+        DecoderPool( unsigned int workers, const std::vector<int>& cpus = {} );
+        ~DecoderPool( void );
+
+        // Control side. remove() returns once no worker is filling the
+        // stream or reading its deadline, it can be destroyed right after.
+        bool add( AudioStreamer* stream );
+        void remove( AudioStreamer* stream );
+
+        // Any thread, real-time safe: a stream has work right now, like
+        // a seek or flush request, parked workers look again
+        void wake( void );
+
+        unsigned int getWorkers( void ) const;
+        unsigned long long getFills( void ) const;
+        unsigned long long getSteals( void ) const;     // Fills done away from the home worker
+
+        // "0,2,4-7" -> 0 2 4 5 6 7, throws std::invalid_argument
+        static std::vector<int> parseCpuList( const std::string& list );
+
+    private:
+        struct Slot {
+            std::atomic<AudioStreamer*> stream{nullptr};
+            std::atomic<bool> busy{false};      // A worker is filling it
+            std::atomic<unsigned int> readers{0};   // Workers looking at its deadline
+        };
+
+        Slot slots[DECODER_POOL_MAX_STREAMS];
+        const unsigned int workerCount;
+        std::vector<std::thread> threads;
+        std::vector<int> cpuList;
+        std::atomic<bool> running{true};
+
+        // Futex word, bumped on every wake(), and the workers waiting on it
+        std::atomic<int> wakeSerial{0};
+        std::atomic<unsigned int> sleepers{0};
+
+        std::atomic<unsigned long long> fills{0};
+        std::atomic<unsigned long long> steals{0};
+
+        void workerLoop( unsigned int index );
+        bool service( unsigned int slot, AudioStreamer* stream );
+        void park( int serial, unsigned int timeoutUs );
+};
+
+#endif // DECODERPOOL_H
@@ -0,0 +1,97 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems varispeed drift controller source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "driftcontroller.h"
+
+#include <algorithm>
+#include <cmath>
+
+//////////////////////////////////////////////////////////
+DriftController::DriftController(   double gain,
+                                    double maxDeviation,
+                                    double deadbandMs,
+                                    double smoothingMs )
+                                    :   gain(gain),
+                                        maxDeviation(maxDeviation),
+                                        deadbandMs(deadbandMs),
+                                        smoothingMs(smoothingMs)
+{
+}
+
+//////////////////////////////////////////////////////////
+double DriftController::update( double errorMs, double periodMs )
+{
+    // One pole low pass, MTC quarter frames come in steps of several
+    // milliseconds and network transport adds its own jitter on top
+    if ( !primed ) {
+        filteredErrorMs = errorMs;
+        primed = true;
+    }
+    else {
+        double alpha = periodMs / ( smoothingMs + periodMs );
+        filteredErrorMs += alpha * ( errorMs - filteredErrorMs );
+    }
+
+    if ( std::fabs( filteredErrorMs ) <= deadbandMs ) {
+        rate = 1.0;
+    }
+    else {
+        // Ahead of the clock means slowing down
+        double deviation = -gain * ( filteredErrorMs / 1000.0 );
+        deviation = std::min( std::max( deviation, -maxDeviation ), maxDeviation );
+        rate = 1.0 + deviation;
+    }
+
+    return rate;
+}
+
+//////////////////////////////////////////////////////////
+void DriftController::reset( void )
+{
+    filteredErrorMs = 0.0;
+    rate = 1.0;
+    primed = false;
+}
+
+//////////////////////////////////////////////////////////
+double DriftController::getRate( void ) const
+{
+    return rate;
+}
+
+//////////////////////////////////////////////////////////
+double DriftController::getFilteredErrorMs( void ) const
+{
+    return filteredErrorMs;
+}
@@ -0,0 +1,91 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems varispeed drift controller header file
+//
+// Turns the play head error against MTC into a playback rate close
+// to 1.0, so small drifts are pulled in smoothly by the variable-rate
+// resampler instead of with a hard seek.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef DRIFTCONTROLLER_H
+#define DRIFTCONTROLLER_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef VARISPEED_GAIN
+#define VARISPEED_GAIN 0.5                  // Rate deviation per second of error
+#endif
+
+#ifndef VARISPEED_MAX_DEVIATION
+#define VARISPEED_MAX_DEVIATION 0.005       // +-0.5 %, well below audible pitch change
+#endif
+
+#ifndef VARISPEED_DEADBAND_MS
+#define VARISPEED_DEADBAND_MS 1.0           // Errors below this are left alone
+#endif
+
+#ifndef VARISPEED_SMOOTHING_MS
+#define VARISPEED_SMOOTHING_MS 250.0        // Error low pass time constant against MTC jitter
+#endif
+
+#ifndef VARISPEED_SEEK_FRAMES
+#define VARISPEED_SEEK_FRAMES 10            // MTC frames of error before falling back to a seek
+#endif
+
+class DriftController
+{
+    public:
+        DriftController(    double gain = VARISPEED_GAIN,
+                            double maxDeviation = VARISPEED_MAX_DEVIATION,
+                            double deadbandMs = VARISPEED_DEADBAND_MS,
+                            double smoothingMs = VARISPEED_SMOOTHING_MS );
+
+        // Feed the play head error (positive = ahead of the master clock)
+        // once per period and get back the playback rate to use.
+        // Real-time safe, no locks nor allocations.
+        double update( double errorMs, double periodMs );
+        void reset( void );
+
+        double getRate( void ) const;
+        double getFilteredErrorMs( void ) const;
+
+    private:
+        double gain;
+        double maxDeviation;
+        double deadbandMs;
+        double smoothingMs;
+
+        double filteredErrorMs = 0.0;
+        double rate = 1.0;
+        bool primed = false;                // First error seeds the filter
+};
+
+#endif // DRIFTCONTROLLER_H
@@ -0,0 +1,459 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems gain stage source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "gainstage.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GAIN_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GAIN_NEON
+#endif
+
+////////////////////////////////////////////
+// Kernels: buffer holds `blocks` blocks of `width` floats (GAIN_BLOCK_FRAMES
+// frames, so width is a multiple of 8). Each block is multiplied by
+// pattern, which then moves on to the next block's gains: unchanged,
+// plus step (linear ramp) or times step (exponential ramp).
+////////////////////////////////////////////
+enum KernelMode { KERNEL_CONSTANT, KERNEL_ADD, KERNEL_MULTIPLY };
+
+typedef void (*GainKernel)( float* buffer, size_t blocks, size_t width,
+                            float* pattern, const float* step, int mode );
+
+static void scalarKernel( float* buffer, size_t blocks, size_t width,
+                          float* pattern, const float* step, int mode )
+{
+    for ( size_t b = 0; b < blocks; b++, buffer += width ) {
+        for ( size_t i = 0; i < width; i++ ) {
+            buffer[i] *= pattern[i];
+        }
+
+        if ( mode == KERNEL_ADD ) {
+            for ( size_t i = 0; i < width; i++ ) pattern[i] += step[i];
+        }
+        else if ( mode == KERNEL_MULTIPLY ) {
+            for ( size_t i = 0; i < width; i++ ) pattern[i] *= step[i];
+        }
+    }
+}
+
+#ifdef GAIN_X86
+static void sseKernel( float* buffer, size_t blocks, size_t width,
+                       float* pattern, const float* step, int mode )
+{
+    for ( size_t b = 0; b < blocks; b++, buffer += width ) {
+        for ( size_t i = 0; i < width; i += 4 ) {
+            __m128 gains = _mm_load_ps( pattern + i );
+            _mm_storeu_ps( buffer + i, _mm_mul_ps( _mm_loadu_ps( buffer + i ), gains ) );
+
+            if ( mode == KERNEL_ADD ) {
+                _mm_store_ps( pattern + i, _mm_add_ps( gains, _mm_load_ps( step + i ) ) );
+            }
+            else if ( mode == KERNEL_MULTIPLY ) {
+                _mm_store_ps( pattern + i, _mm_mul_ps( gains, _mm_load_ps( step + i ) ) );
+            }
+        }
+    }
+}
+
+__attribute__((target("avx")))
+static void avxKernel( float* buffer, size_t blocks, size_t width,
+                       float* pattern, const float* step, int mode )
+{
+    for ( size_t b = 0; b < blocks; b++, buffer += width ) {
+        for ( size_t i = 0; i < width; i += 8 ) {
+            __m256 gains = _mm256_load_ps( pattern + i );
+            _mm256_storeu_ps( buffer + i, _mm256_mul_ps( _mm256_loadu_ps( buffer + i ), gains ) );
+
+            if ( mode == KERNEL_ADD ) {
+                _mm256_store_ps( pattern + i, _mm256_add_ps( gains, _mm256_load_ps( step + i ) ) );
+            }
+            else if ( mode == KERNEL_MULTIPLY ) {
+                _mm256_store_ps( pattern + i, _mm256_mul_ps( gains, _mm256_load_ps( step + i ) ) );
+            }
+        }
+    }
+}
+#endif
+
+#ifdef GAIN_NEON
+static void neonKernel( float* buffer, size_t blocks, size_t width,
+                        float* pattern, const float* step, int mode )
+{
+    for ( size_t b = 0; b < blocks; b++, buffer += width ) {
+        for ( size_t i = 0; i < width; i += 4 ) {
+            float32x4_t gains = vld1q_f32( pattern + i );
+            vst1q_f32( buffer + i, vmulq_f32( vld1q_f32( buffer + i ), gains ) );
+
+            if ( mode == KERNEL_ADD ) {
+                vst1q_f32( pattern + i, vaddq_f32( gains, vld1q_f32( step + i ) ) );
+            }
+            else if ( mode == KERNEL_MULTIPLY ) {
+                vst1q_f32( pattern + i, vmulq_f32( gains, vld1q_f32( step + i ) ) );
+            }
+        }
+    }
+}
+#endif
+
+////////////////////////////////////////////
+// Picked once, on first use
+////////////////////////////////////////////
+struct KernelChoice {
+    GainKernel kernel;
+    const char* name;
+};
+
+static KernelChoice chooseKernel( void )
+{
+#if defined(GAIN_X86)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx" ) ) {
+        return { avxKernel, "avx" };
+    }
+    if ( __builtin_cpu_supports( "sse" ) ) {
+        return { sseKernel, "sse" };
+    }
+#elif defined(GAIN_NEON)
+    return { neonKernel, "neon" };
+#endif
+    return { scalarKernel, "scalar" };
+}
+
+static const KernelChoice& kernelChoice( void )
+{
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+////////////////////////////////////////////
+// Constructor, unity gain
+////////////////////////////////////////////
+GainStage::GainStage( void )
+{
+    for ( unsigned int i = 0; i < GAIN_MAX_CHANNELS; i++ ) {
+        current[i] = 1.0f;
+    }
+
+    // Resolve the kernel now rather than in the audio thread
+    kernelChoice();
+}
+
+////////////////////////////////////////////
+void GainStage::setGain( unsigned int channel, float gain )
+{
+    post( channel, gain, 0, CURVE_LINEAR );
+}
+
+////////////////////////////////////////////
+void GainStage::setAllGains( float gain )
+{
+    for ( unsigned int i = 0; i < GAIN_MAX_CHANNELS; i++ ) {
+        post( i, gain, 0, CURVE_LINEAR );
+    }
+}
+
+////////////////////////////////////////////
+void GainStage::fade( unsigned int channel, float gain, unsigned long frames, Curve curve )
+{
+    post( channel, gain, frames, curve );
+}
+
+////////////////////////////////////////////
+void GainStage::fadeAll( float gain, unsigned long frames, Curve curve )
+{
+    for ( unsigned int i = 0; i < GAIN_MAX_CHANNELS; i++ ) {
+        post( i, gain, frames, curve );
+    }
+}
+
+////////////////////////////////////////////
+float GainStage::getGain( unsigned int channel ) const
+{
+    return channel < GAIN_MAX_CHANNELS ? moves[channel].gain.load( std::memory_order_relaxed ) : 0.0f;
+}
+
+////////////////////////////////////////////
+void GainStage::setRamp( Ramp ramp )
+{
+    rampType.store( ramp, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+const char* GainStage::getKernelName( void )
+{
+    return kernelChoice().name;
+}
+
+////////////////////////////////////////////
+GainStage::Curve GainStage::parseCurve( const char* name )
+{
+    std::string curve( name );
+
+    if ( curve == "linear" || curve == "lin" ) {
+        return CURVE_LINEAR;
+    }
+    if ( curve == "equalpower" || curve == "eqp" ) {
+        return CURVE_EQUAL_POWER;
+    }
+    if ( curve == "log" || curve == "logarithmic" ) {
+        return CURVE_LOGARITHMIC;
+    }
+
+    throw std::invalid_argument( "Unknown fade curve: " + curve );
+}
+
+////////////////////////////////////////////
+// Control thread: publish a move for the audio thread to pick up
+////////////////////////////////////////////
+void GainStage::post( unsigned int channel, float gain, unsigned long frames, Curve curve )
+{
+    if ( channel >= GAIN_MAX_CHANNELS ) {
+        return;
+    }
+
+    Move& move = moves[channel];
+    unsigned int sequence = move.sequence.load( std::memory_order_relaxed );
+
+    move.sequence.store( sequence + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    move.gain.store( gain, std::memory_order_relaxed );
+    move.frames.store( frames, std::memory_order_relaxed );
+    move.curve.store( curve, std::memory_order_relaxed );
+
+    move.sequence.store( sequence + 2, std::memory_order_release );
+}
+
+////////////////////////////////////////////
+// Audio thread: take the moves posted since the last buffer. One caught
+// while being written is left for the next buffer, never waited on.
+////////////////////////////////////////////
+void GainStage::poll( unsigned int channels )
+{
+    for ( unsigned int c = 0; c < channels; c++ ) {
+        Move& move = moves[c];
+        Envelope& envelope = envelopes[c];
+
+        unsigned int sequence = move.sequence.load( std::memory_order_acquire );
+        if ( sequence == envelope.sequence || ( sequence & 1 ) ) {
+            continue;
+        }
+
+        float gain = move.gain.load( std::memory_order_relaxed );
+        unsigned long frames = move.frames.load( std::memory_order_relaxed );
+        int curve = move.curve.load( std::memory_order_relaxed );
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if ( move.sequence.load( std::memory_order_relaxed ) != sequence ) {
+            continue;
+        }
+
+        envelope.sequence = sequence;
+        envelope.from = current[c];
+        envelope.to = gain;
+        envelope.length = frames;
+        envelope.position = 0;
+        envelope.curve = curve;
+        envelope.fading = frames > 0;
+    }
+}
+
+////////////////////////////////////////////
+// Gain of a fade at its current position
+////////////////////////////////////////////
+float GainStage::envelopeAt( const Envelope& envelope )
+{
+    if ( envelope.position >= envelope.length ) {
+        return envelope.to;
+    }
+
+    double x = (double) envelope.position / envelope.length;
+    double from = envelope.from;
+    double to = envelope.to;
+
+    switch ( envelope.curve ) {
+        case CURVE_EQUAL_POWER:
+            // Quarter sine, steep at the quiet end
+            if ( to > from ) {
+                return from + ( to - from ) * std::sin( x * M_PI / 2 );
+            }
+            return to + ( from - to ) * std::cos( x * M_PI / 2 );
+
+        case CURVE_LOGARITHMIC:
+            // Even steps in dB, silence stands for GAIN_RAMP_FLOOR
+            from = std::max( from, (double) GAIN_RAMP_FLOOR );
+            to = std::max( to, (double) GAIN_RAMP_FLOOR );
+            return from * std::pow( to / from, x );
+
+        default:
+            return from + ( to - from ) * x;
+    }
+}
+
+////////////////////////////////////////////
+// Audio thread
+////////////////////////////////////////////
+void GainStage::process( float* buffer, unsigned int frames, unsigned int channels )
+{
+    if ( frames == 0 || channels == 0 || channels > GAIN_MAX_CHANNELS ) {
+        return;
+    }
+
+    poll( channels );
+
+    bool fading = false;
+    bool moving = false;
+    bool unity = true;
+    float goal[GAIN_MAX_CHANNELS];
+    for ( unsigned int c = 0; c < channels; c++ ) {
+        fading = fading || envelopes[c].fading;
+        goal[c] = envelopes[c].to;
+        moving = moving || goal[c] != current[c];
+        unity = unity && goal[c] == 1.0f;
+    }
+
+    if ( !fading ) {
+        // Nothing to do at all, the common case
+        if ( !moving && unity ) {
+            return;
+        }
+
+        apply( buffer, frames, channels, goal,
+               moving && rampType.load( std::memory_order_relaxed ) == RAMP_EXPONENTIAL );
+        return;
+    }
+
+    // Fades go along their curves in straight segments, cut where one of
+    // them ends so it lands on its gain on the exact frame. Plain changes
+    // on the other channels ramp over the first segment.
+    unsigned int done = 0;
+    while ( done < frames ) {
+        unsigned int length = std::min( frames - done, (unsigned int) GAIN_FADE_SEGMENT_FRAMES );
+        for ( unsigned int c = 0; c < channels; c++ ) {
+            if ( envelopes[c].fading ) {
+                length = (unsigned int) std::min( (unsigned long) length, envelopes[c].length - envelopes[c].position );
+            }
+        }
+
+        for ( unsigned int c = 0; c < channels; c++ ) {
+            Envelope& envelope = envelopes[c];
+            if ( envelope.fading ) {
+                envelope.position += length;
+                envelope.fading = envelope.position < envelope.length;
+                goal[c] = envelopeAt( envelope );
+            }
+            else {
+                goal[c] = envelope.to;
+            }
+        }
+
+        apply( buffer + (size_t) done * channels, length, channels, goal, false );
+        done += length;
+    }
+}
+
+////////////////////////////////////////////
+// Ramp every channel from its current gain to goal over frames
+////////////////////////////////////////////
+void GainStage::apply( float* buffer, unsigned int frames, unsigned int channels,
+                       const float* goal, bool exponential )
+{
+    bool ramping = false;
+    for ( unsigned int c = 0; c < channels; c++ ) {
+        ramping = ramping || goal[c] != current[c];
+    }
+
+    size_t width = (size_t) channels * GAIN_BLOCK_FRAMES;
+
+    // Gain of frame f (1 based) of the buffer is current + (goal - current)
+    // * f / frames, or current * (goal / current) ^ (f / frames)
+    for ( unsigned int c = 0; c < channels; c++ ) {
+        float from = current[c];
+        float to = goal[c];
+
+        if ( from == to ) {
+            for ( unsigned int f = 0; f < GAIN_BLOCK_FRAMES; f++ ) {
+                pattern[f * channels + c] = to;
+                step[f * channels + c] = exponential ? 1.0f : 0.0f;
+            }
+        }
+        else if ( exponential ) {
+            from = std::max( from, GAIN_RAMP_FLOOR );
+            to = std::max( to, GAIN_RAMP_FLOOR );
+            float ratio = std::pow( to / from, 1.0f / frames );
+            float blockRatio = std::pow( ratio, (float) GAIN_BLOCK_FRAMES );
+            for ( unsigned int f = 0; f < GAIN_BLOCK_FRAMES; f++ ) {
+                pattern[f * channels + c] = from * std::pow( ratio, (float)( f + 1 ) );
+                step[f * channels + c] = blockRatio;
+            }
+        }
+        else {
+            float increment = ( to - from ) / frames;
+            for ( unsigned int f = 0; f < GAIN_BLOCK_FRAMES; f++ ) {
+                pattern[f * channels + c] = from + increment * ( f + 1 );
+                step[f * channels + c] = increment * GAIN_BLOCK_FRAMES;
+            }
+        }
+
+        current[c] = goal[c];
+    }
+
+    // The very last frame gets the goal itself, free of rounding from the
+    // accumulated steps
+    unsigned int stepped = frames - 1;
+    int mode = !ramping ? KERNEL_CONSTANT : ( exponential ? KERNEL_MULTIPLY : KERNEL_ADD );
+    size_t blocks = stepped / GAIN_BLOCK_FRAMES;
+    kernelChoice().kernel( buffer, blocks, width, pattern, step, mode );
+
+    // Frames after the last block, pattern already holds their gains
+    float* tail = buffer + blocks * width;
+    size_t tailFloats = (size_t)( stepped % GAIN_BLOCK_FRAMES ) * channels;
+    for ( size_t i = 0; i < tailFloats; i++ ) {
+        tail[i] *= pattern[i];
+    }
+
+    float* last = buffer + (size_t) stepped * channels;
+    for ( unsigned int c = 0; c < channels; c++ ) {
+        last[c] *= goal[c];
+    }
+}
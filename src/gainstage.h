@@ -0,0 +1,126 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems gain stage header file
+//
+// Per channel gains applied to interleaved float buffers. Gains are set
+// from the control thread and reached over the next processed buffer with
+// a linear or exponential ramp, sample by sample, so changes never step.
+// Fades run over any length with a linear, equal power or logarithmic
+// curve, advanced by the audio thread itself from a single request.
+// The inner loop is vectorised (AVX, SSE or NEON) with a scalar
+// fallback, chosen once at run time from what the CPU supports.
+//////////////////////////////////////////////////////////
+#ifndef GAINSTAGE_H
+#define GAINSTAGE_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef GAIN_MAX_CHANNELS
+#define GAIN_MAX_CHANNELS 64                // Channels a gain stage can handle
+#endif
+
+#define GAIN_BLOCK_FRAMES 8                 // Frames per vector block, any channel count fits SIMD widths
+
+#ifndef GAIN_RAMP_FLOOR
+#define GAIN_RAMP_FLOOR 1e-5f               // -100 dB, where exponential ramps start from or end at silence
+#endif
+
+#ifndef GAIN_FADE_SEGMENT_FRAMES
+#define GAIN_FADE_SEGMENT_FRAMES 64         // Fades follow their curve in straight lines this long
+#endif
+
+#include <atomic>
+
+class GainStage
+{
+    public:
+        enum Ramp { RAMP_LINEAR, RAMP_EXPONENTIAL };
+        enum Curve { CURVE_LINEAR, CURVE_EQUAL_POWER, CURVE_LOGARITHMIC };
+
+        GainStage( void );
+
+        // Control thread, one at a time. A new gain or fade on a channel
+        // replaces the one in progress, starting from where it got to.
+        void setGain( unsigned int channel, float gain );
+        void setAllGains( float gain );
+        void fade( unsigned int channel, float gain, unsigned long frames, Curve curve = CURVE_LINEAR );
+        void fadeAll( float gain, unsigned long frames, Curve curve = CURVE_LINEAR );
+        float getGain( unsigned int channel ) const;    // Last gain set or faded to
+        void setRamp( Ramp ramp );
+
+        // Audio thread: applies the gains to frames of interleaved audio,
+        // ramping from the gains of the previous call to the current ones.
+        // Buffers with more than GAIN_MAX_CHANNELS channels are left alone.
+        void process( float* buffer, unsigned int frames, unsigned int channels );
+
+        static const char* getKernelName( void );  // "avx", "sse", "neon" or "scalar"
+
+        // "linear", "equalpower" or "log", throws std::invalid_argument
+        static Curve parseCurve( const char* name );
+
+    private:
+        // Gain change requested by the control thread, sequence locked:
+        // odd while being written
+        struct Move {
+            std::atomic<unsigned int> sequence{0};
+            std::atomic<float> gain{1.0f};
+            std::atomic<unsigned long> frames{0};   // 0 for a plain gain change
+            std::atomic<int> curve{CURVE_LINEAR};
+        };
+
+        // Move being carried out, audio thread only
+        struct Envelope {
+            unsigned int sequence = 0;
+            float from = 1.0f;
+            float to = 1.0f;
+            unsigned long length = 0;
+            unsigned long position = 0;
+            int curve = CURVE_LINEAR;
+            bool fading = false;
+        };
+
+        void post( unsigned int channel, float gain, unsigned long frames, Curve curve );
+        void poll( unsigned int channels );
+        static float envelopeAt( const Envelope& envelope );
+        void apply( float* buffer, unsigned int frames, unsigned int channels,
+                    const float* goal, bool exponential );
+
+        Move moves[GAIN_MAX_CHANNELS];
+        Envelope envelopes[GAIN_MAX_CHANNELS];
+        std::atomic<int> rampType{RAMP_LINEAR};
+        float current[GAIN_MAX_CHANNELS];
+
+        // Gains for the next block of frames and their change per block
+        alignas(32) float pattern[GAIN_MAX_CHANNELS * GAIN_BLOCK_FRAMES];
+        alignas(32) float step[GAIN_MAX_CHANNELS * GAIN_BLOCK_FRAMES];
+};
+
+#endif // GAINSTAGE_H
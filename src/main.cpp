@@ -46,9 +46,16 @@ CuemsLogger* logger = NULL;
 // Main application function
 int main( int argc, char *argv[] ) {
 
-    signal(SIGTERM, sigTermHandler);
-    signal(SIGUSR1, sigUsr1Handler);
-    signal(SIGINT, sigIntHandler);
+    // Our signals are blocked from the start, so every thread made from
+    // here on inherits it, and read from a signalfd by the main loop
+    // instead of interrupting whatever thread they land on
+    sigset_t handledSignals;
+    sigemptyset( &handledSignals );
+    sigaddset( &handledSignals, SIGTERM );
+    sigaddset( &handledSignals, SIGUSR1 );
+    sigaddset( &handledSignals, SIGINT );
+    pthread_sigmask( SIG_BLOCK, &handledSignals, NULL );
+    int signalFd = signalfd( -1, &handledSignals, SFD_CLOEXEC );
 
     // We instantiate here our singleton logger object to be accessed
     // via the CuemsLogger::getLogger() function across the app
@@ -288,6 +295,189 @@ int main( int argc, char *argv[] ) {
         }
     }
 
+    // --streaming flag: decode on a background thread feeding a ring
+    // buffer, the audio callback only copies from it
+    bool streamingFlag = false;
+    if ( argParser->optionExists("--streaming") ) {
+            streamingFlag = true ;
+    }
+
+    // --varispeed flag: follow small MTC drifts by adjusting the playback
+    // rate, only seeking when the timecode really jumps
+    bool varispeedFlag = false;
+    if ( argParser->optionExists("--varispeed") ) {
+            varispeedFlag = true ;
+    }
+
+    // --preload flag: decode the whole file into memory whatever its length.
+    // --preload-max <s>: files up to that long are preloaded anyway, 0 = never
+    bool preloadFlag = false;
+    double preloadMaxSeconds = PRELOAD_MAX_SECONDS;
+    if ( argParser->optionExists("--preload") ) {
+            preloadFlag = true ;
+    }
+    if ( argParser->optionExists("--preload-max") ) {
+        try {
+            preloadMaxSeconds = std::stod( argParser->getParam("--preload-max") );
+        } catch ( const std::exception& e ) {
+            std::cout << "Invalid number of seconds after --preload-max option." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+    }
+
+    // --cache-dir <path>: keep decoded renditions of the files there and
+    // play them from a memory mapping on later runs
+    string cacheDirectory = "";
+    if ( argParser->optionExists("--cache-dir") ) {
+        cacheDirectory = argParser->getParam("--cache-dir");
+
+        if ( cacheDirectory.empty() ) {
+            std::cout << "Directory not specified after --cache-dir option." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+    }
+
+    // --shm-cache flag: share decoded renditions with the other players
+    // of the node through POSIX shared memory
+    bool sharedMemoryFlag = false;
+    if ( argParser->optionExists("--shm-cache") ) {
+            sharedMemoryFlag = true ;
+    }
+
+    // --voices <n>: extra voices mixed by this same player, driven
+    // through <osc_route>/voice/<id>/...
+    unsigned int voiceCount = 0;
+    if ( argParser->optionExists("--voices") ) {
+        try {
+            voiceCount = std::stoul( argParser->getParam("--voices") );
+        } catch ( const std::exception& e ) {
+            std::cout << "Invalid number of voices after --voices option." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+
+        if ( voiceCount > MAX_VOICES ) {
+            std::cout << "At most " << MAX_VOICES << " voices per player." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+    }
+
+    // --decoders <n>: decode every stream of this player in a pool of n
+    // threads. --decoder-cpus <list>: pin them, e.g. 2,3 or 4-7
+    unsigned int decoderThreads = 0;
+    std::vector<int> decoderCpus;
+    try {
+        if ( argParser->optionExists("--decoders") ) {
+            decoderThreads = std::stoul( argParser->getParam("--decoders") );
+        }
+        if ( argParser->optionExists("--decoder-cpus") ) {
+            decoderCpus = DecoderPool::parseCpuList( argParser->getParam("--decoder-cpus") );
+        }
+    } catch ( const std::exception& e ) {
+        std::cout << "Invalid value after --decoders or --decoder-cpus option." << endl;
+
+        logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+        exit( CUEMS_EXIT_WRONG_PARAMETERS );
+    }
+
+    // --exp-ramps: volume changes follow an exponential curve over the
+    // period instead of a linear one
+    bool exponentialRampFlag = false;
+    if ( argParser->optionExists("--exp-ramps") ) {
+            exponentialRampFlag = true ;
+    }
+
+    // --fast-start: take the --device device without checking it first,
+    // open the file while looking for it and start without pausing
+    bool fastStartFlag = false;
+    if ( argParser->optionExists("--fast-start") ) {
+            fastStartFlag = true ;
+    }
+
+    // --outputs <n>: open n output ports and keep the file in its own
+    // channels. --route <in:out[:gain],...>: which file channel goes to
+    // which port, instead of spreading them over every port in turn
+    unsigned int outputPorts = 0;
+    string routeSpec = "";
+    try {
+        if ( argParser->optionExists("--outputs") ) {
+            outputPorts = std::stoul( argParser->getParam("--outputs") );
+            if ( outputPorts == 0 || outputPorts > ROUTING_MAX_CHANNELS ) {
+                throw std::out_of_range( "outputs" );
+            }
+        }
+        if ( argParser->optionExists("--route") ) {
+            routeSpec = argParser->getParam("--route");
+            RoutingMatrix::parseRoutes( routeSpec );
+        }
+    } catch ( const std::exception& e ) {
+        std::cout << "Invalid value after --outputs (1 to " << ROUTING_MAX_CHANNELS << ") or --route option." << endl;
+
+        logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+        exit( CUEMS_EXIT_WRONG_PARAMETERS );
+    }
+
+    // --render <out.wav>: no audio device, drive the player from a virtual
+    // clock with scripted MTC and write the output to a WAV file
+    string renderPath = "";
+    double renderSeconds = 0;
+    bool renderRealTime = false;
+    unsigned int renderRate = 44100;
+    unsigned int renderBufferFrames = NULL_BACKEND_BUFFER_FRAMES;
+
+    if ( argParser->optionExists("--render") ) {
+        renderPath = argParser->getParam("--render");
+
+        if ( renderPath.empty() ) {
+            std::cout << "Output file not specified after --render option." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+
+        try {
+            if ( argParser->optionExists("--render-seconds") ) {
+                renderSeconds = std::stod( argParser->getParam("--render-seconds") );
+            }
+            if ( argParser->optionExists("--render-rate") ) {
+                renderRate = std::stoul( argParser->getParam("--render-rate") );
+            }
+            if ( argParser->optionExists("--render-buffer") ) {
+                renderBufferFrames = std::stoul( argParser->getParam("--render-buffer") );
+            }
+        } catch ( const std::exception& e ) {
+            std::cout << "Invalid number after --render-seconds, --render-rate or --render-buffer option." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+
+        if ( renderRate == 0 || renderBufferFrames == 0 ) {
+            std::cout << "Render sample rate and buffer size must be positive." << endl;
+
+            logger->getLogger()->logError( "Exiting with result code: " + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS) );
+
+            exit( CUEMS_EXIT_WRONG_PARAMETERS );
+        }
+
+        renderRealTime = argParser->optionExists("--render-realtime");
+    }
+
     delete argParser;
 
     // End of command line parsing
@@ -318,6 +508,15 @@ int main( int argc, char *argv[] ) {
         exit ( CUEMS_EXIT_WRONG_PARAMETERS );
     }
     else {
+        // The offline render runs in this thread and there is no signalfd
+        // without the main loop, back to handlers there
+        if ( !renderPath.empty() || signalFd < 0 ) {
+            signal(SIGTERM, sigTermHandler);
+            signal(SIGUSR1, sigUsr1Handler);
+            signal(SIGINT, sigIntHandler);
+            pthread_sigmask( SIG_UNBLOCK, &handledSignals, NULL );
+        }
+
         try {
             myAudioPlayer = new AudioPlayer(
                 portNumber,
@@ -330,10 +529,24 @@ int main( int argc, char *argv[] ) {
                 stopOnLostFlag,
                 mtcFollowFlag,
                 2,  // Default 2 channels
-                44100,  // Default sample rate (will be overridden by JACK)
-                RtAudio::Api::UNIX_JACK,
+                renderPath.empty() ? 44100 : renderRate,  // Default sample rate (will be overridden by JACK)
+                renderPath.empty() ? RtAudio::Api::UNIX_JACK : RtAudio::Api::RTAUDIO_DUMMY,
                 resampleQuality,
-                explicitLatencyMs
+                explicitLatencyMs,
+                streamingFlag,
+                varispeedFlag,
+                renderBufferFrames,
+                preloadFlag,
+                preloadMaxSeconds,
+                cacheDirectory,
+                sharedMemoryFlag,
+                voiceCount,
+                decoderThreads,
+                decoderCpus,
+                exponentialRampFlag,
+                outputPorts,
+                routeSpec,
+                fastStartFlag
             );
         }
         catch ( const std::exception& e ) {
@@ -345,8 +558,23 @@ int main( int argc, char *argv[] ) {
         logger->logOK("AudioPlayer object created OK!");
     }
 
+    //////////////////////////////////////////////////////////
+    // Offline render, no device and no waiting for the end of play
+    if ( !renderPath.empty() ) {
+        int result = myAudioPlayer->renderToFile( renderPath, renderSeconds, renderRealTime );
+
+        logger->logInfo( "Exiting with result code: " + std::to_string( result ) );
+
+        delete myAudioPlayer;
+        delete logger;
+
+        exit( result );
+    }
+
     // Micro pause to let everything get in place
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if ( !fastStartFlag ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
 
     string str;
     str = "Starting object with " + std::to_string(myAudioPlayer->nChannels) + " channels" +
@@ -359,12 +587,44 @@ int main( int argc, char *argv[] ) {
     //////////////////////////////////////////////////////////
     // We are running!! Let's check the USR1 signal handler
     // to let everyone know that we are running
+    myAudioPlayer->startupTrace.mark( "running" );
     sigUsr1Handler( SIGUSR1 );
+    logger->logInfo( myAudioPlayer->startupTrace.summary() );
 
     //////////////////////////////////////////////////////////
-    // Wait for it to finnish somehow
+    // Wait for it to finnish somehow: sleep until the audio thread ends
+    // the play or a signal comes. /quit and /check are signals too.
+    struct pollfd events[2] = {
+        { signalFd, POLLIN, 0 },
+        { myAudioPlayer->getEndOfPlayEvent(), POLLIN, 0 }
+    };
+    int timeout = ( events[1].fd < 0 ) ? 10 : -1;      // Polling the flag if no eventfd
+
     while ( !myAudioPlayer->endOfPlay ) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if ( poll( events, 2, timeout ) < 0 ) {
+            if ( errno != EINTR ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
+        }
+
+        if ( events[0].revents & POLLIN ) {
+            struct signalfd_siginfo info;
+            if ( read( signalFd, &info, sizeof( info ) ) == (ssize_t) sizeof( info ) ) {
+                switch ( info.ssi_signo ) {
+                    case SIGTERM: sigTermHandler( SIGTERM ); break;
+                    case SIGINT:  sigIntHandler( SIGINT ); break;
+                    case SIGUSR1: sigUsr1Handler( SIGUSR1 ); break;
+                }
+            }
+        }
+
+        if ( events[1].revents & POLLIN ) {
+            uint64_t count;
+            if ( read( events[1].fd, &count, sizeof( count ) ) < 0 ) {
+                // Nothing to read, the flag says it all
+            }
+        }
     }
 
     logger->logInfo( "End of playing reached, finishing" );
@@ -425,10 +685,20 @@ void showusage( void ) {
         "               File name can also be stated as the last argument with no option indicator." << endl << endl <<
         "           --port , -p <port_number> : OSC port to listen to." << endl << endl <<
         "           OPTIONAL OPTIONS:" << endl << 
+        "           --cache-dir <path> : keep a decoded float32 copy of each file there, at the output rate" << endl <<
+        "               and channels, and play it from a memory mapping on later runs. Copies are made in" << endl <<
+        "               background the first time. Stale copies are not removed." << endl << endl <<
         "           --ciml , -c : Continue If Mtc is Lost, flag to define that the player should continue" << endl <<
         "               if the MTC sync signal is lost. If not specified (standard mode) it stops on lost." << endl << endl <<
         "           --device , -d : Audio device name to connect the player to. If not stated it will" << endl <<
         "               try to connect to the default device." << endl << endl <<
+        "           --decoders <n> : with --streaming, decode the file, cues and voices in a pool of n threads" << endl <<
+        "               that serve first whichever stream is closest to running dry." << endl <<
+        "               --decoder-cpus <list> : pin the decoder threads to these CPUs, e.g. 2,3 or 4-7." << endl << endl <<
+        "           --exp-ramps : volume changes ramp exponentially (evenly in dB) over one period instead" << endl <<
+        "               of linearly." << endl << endl <<
+        "           --fast-start : start as soon as possible. The --device device is taken without checking" << endl <<
+        "               it first, the file is opened while looking for it and there is no pause before running." << endl << endl <<
         "           --mtcfollow , -m : Start the player following MTC directly. Default is not to follow until" << endl <<
         "               it is indicated to the player through OSC." << endl << endl <<
         "           --offset , -o <milliseconds> : playing time offset in milliseconds." << endl <<
@@ -438,11 +708,34 @@ void showusage( void ) {
         "               output latency compensation (0-500). When provided, the JACK" << endl <<
         "               query is skipped and this value is used instead. Typically fed" << endl <<
         "               by the engine from settings.xml; set on a per-node basis." << endl << endl <<
+        "           --outputs <n> : open n output ports and route the file to them in its own channels," << endl <<
+        "               by default file channel k to every port k, k + channels, ... (see --route)." << endl << endl <<
+        "           --preload : decode and resample the whole file into memory before playing, so reads" << endl <<
+        "               are copies and MTC relocations are free. Files up to 30 s are preloaded anyway." << endl <<
+        "               --preload-max <s> : longest file preloaded automatically, 0 disables it." << endl << endl <<
+        "           --render <out_wav_path> : offline render with no audio device. The player follows a" << endl <<
+        "               scripted MTC from 0 driven by a virtual clock and writes its output to a 32 bit" << endl <<
+        "               float WAV file, then prints throughput figures (periods/s, callback time)." << endl <<
+        "               --render-seconds <s> : length to render, default is the whole file." << endl <<
+        "               --render-rate <Hz> : output sample rate, default 44100." << endl <<
+        "               --render-buffer <frames> : period size, default 512." << endl <<
+        "               --render-realtime : pace the render in real time instead of as fast as possible." << endl << endl <<
         "           --resample-quality , -r <quality> : resampling quality when file sample rate differs from" << endl <<
         "               JACK sample rate. Options: vhq (very high), hq (high, default), mq (medium), lq (low)." << endl <<
         "               Higher quality = better audio but more CPU usage. Default is 'hq'." << endl << endl <<
+        "           --route <in:out[:gain],...> : file channel to output port routes, e.g. 0:0,1:1,0:2:0.7,1:2:0.7." << endl <<
+        "               Unlisted pairs are silent. Opens as many ports as the highest one unless --outputs." << endl << endl <<
+        "           --shm-cache : decode each file once per node. The first player to open a file renders" << endl <<
+        "               it into shared memory, the others map the same pages read-only." << endl << endl <<
+        "           --streaming : decode the file on a background thread that keeps a ring buffer" << endl <<
+        "               several periods ahead, so the audio callback only copies samples." << endl << endl <<
         "           --uuid , -u <uuid_string> : indicates a unique identifier for the process to be recognized" << endl <<
         "               in different internal identification porpouses such as Jack streams in use." << endl << endl <<
+        "           --varispeed : follow MTC drift by nudging the playback rate (up to +-0.5%) through a" << endl <<
+        "               variable-rate resampler. Hard seeks only happen when the timecode jumps." << endl << endl <<
+        "           --voices <n> : host n more voices in this player, each playing its own file with its own" << endl <<
+        "               offset and volume, mixed into the same output and following the same MTC. Driven" << endl <<
+        "               through <osc_route>/voice/<id>/ load <path>, unload, play, stop, vol <gain>, offset <ms>." << endl << endl <<
         "           --wait , -w <milliseconds> : waiting time after reaching the end of the file and before" << endl <<
         "               quiting the program. Default is 0. -1 indicates the program remains" << endl <<
         "               running till SIG-TERM or OSC quit is received." << endl << endl <<
@@ -462,14 +755,14 @@ void sigTermHandler( int signum ) {
 
     logger->getLogger()->logInfo( str );
 
+    logger->getLogger()->logInfo( "Exiting with result code: " + std::to_string(signum) );
+
     if ( myAudioPlayer != NULL )
         delete myAudioPlayer;
 
     if ( logger != NULL )
         delete logger;
 
-    logger->getLogger()->logInfo( "Exiting with result code: " + std::to_string(signum) );
-
     exit(signum);
 
 }
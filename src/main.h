@@ -34,6 +34,8 @@
 
 #include <string>
 #include <csignal>
+#include <poll.h>
+#include <sys/signalfd.h>
 #include <filesystem>
 #include "cuems_audioplayerConfig.h"
 #include "commandlineparser.h"
@@ -49,7 +51,8 @@ void showusage( void );
 void showwarrantydisclaimer( void );
 void showcopydisclaimer( void );
 
-// System signal handlers
+// System signal handlers, called from the main loop as signals are read
+// from a signalfd (or as plain handlers when rendering)
 void sigTermHandler( int signum );
 void sigUsr1Handler( int signum );
 void sigIntHandler( int signum );
\ No newline at end of file
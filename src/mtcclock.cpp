@@ -0,0 +1,147 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems MTC clock recovery source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "mtcclock.h"
+
+#include <algorithm>
+#include <cmath>
+
+//////////////////////////////////////////////////////////
+MtcClock::MtcClock( double alpha, double beta )
+                    :   alpha(alpha),
+                        beta(beta)
+{
+}
+
+//////////////////////////////////////////////////////////
+void MtcClock::setSampleRate( unsigned int rate )
+{
+    if ( rate > 0 ) {
+        msPerFrame = 1000.0 / rate;
+    }
+}
+
+//////////////////////////////////////////////////////////
+void MtcClock::update( long mtcHeadMs, long long sampleTime )
+{
+    if ( !primed ) {
+        estimateMs = mtcHeadMs;
+        refTime = sampleTime;
+        speed = 1.0;
+        lastRawMs = mtcHeadMs;
+        primed = true;
+        return;
+    }
+
+    // Quarter frames arrive every few periods, nothing new in between
+    if ( mtcHeadMs == lastRawMs ) {
+        return;
+    }
+    lastRawMs = mtcHeadMs;
+
+    double elapsedMs = ( sampleTime - refTime ) * msPerFrame;
+    double predictedMs = estimateMs + speed * elapsedMs;
+    double residualMs = mtcHeadMs - predictedMs;
+    lastResidualMs = residualMs;
+
+    // Locate, rewind or a restart: start tracking from scratch
+    if ( std::fabs( residualMs ) > MTC_PLL_RELOCK_MS ) {
+        estimateMs = mtcHeadMs;
+        refTime = sampleTime;
+        speed = 1.0;
+        lockCount = 0;
+        locked.store( false, std::memory_order_relaxed );
+        return;
+    }
+
+    // Speed is corrected over the average update interval: dividing by
+    // each interval would weight early arrivals more and bias the speed
+    intervalMs = ( intervalMs > 0.0 ) ? intervalMs + 0.05 * ( elapsedMs - intervalMs ) : elapsedMs;
+
+    estimateMs = predictedMs + alpha * residualMs;
+    refTime = sampleTime;
+    if ( intervalMs > 0.0 ) {
+        speed += beta * residualMs / intervalMs;
+        speed = std::min( std::max( speed, 0.9 ), 1.1 );
+    }
+
+    if ( std::fabs( residualMs ) <= MTC_PLL_LOCK_MS ) {
+        if ( lockCount < MTC_PLL_LOCK_COUNT ) {
+            lockCount++;
+        }
+    }
+    else {
+        lockCount = 0;
+    }
+    locked.store( lockCount >= MTC_PLL_LOCK_COUNT, std::memory_order_relaxed );
+}
+
+//////////////////////////////////////////////////////////
+void MtcClock::reset( void )
+{
+    estimateMs = 0.0;
+    refTime = 0;
+    speed = 1.0;
+    lastRawMs = 0;
+    lastResidualMs = 0.0;
+    intervalMs = 0.0;
+    primed = false;
+    lockCount = 0;
+    locked.store( false, std::memory_order_relaxed );
+}
+
+//////////////////////////////////////////////////////////
+double MtcClock::positionMs( long long sampleTime ) const
+{
+    return estimateMs + speed * ( sampleTime - refTime ) * msPerFrame;
+}
+
+//////////////////////////////////////////////////////////
+bool MtcClock::isLocked( void ) const
+{
+    return locked.load( std::memory_order_relaxed );
+}
+
+//////////////////////////////////////////////////////////
+double MtcClock::getSpeed( void ) const
+{
+    return speed;
+}
+
+//////////////////////////////////////////////////////////
+double MtcClock::getLastResidualMs( void ) const
+{
+    return lastResidualMs;
+}
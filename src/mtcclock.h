@@ -0,0 +1,107 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems MTC clock recovery header file
+//
+// Alpha-beta tracking loop locking the raw MTC head (quarter frame
+// updates with network arrival jitter) to the audio sample clock. It
+// gives back a smooth timeline that can be queried at any sample time.
+// Owned by the audio thread: no locks, no allocations.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef MTCCLOCK_H
+#define MTCCLOCK_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef MTC_PLL_ALPHA
+#define MTC_PLL_ALPHA 0.05                  // Phase correction per update
+#endif
+
+#ifndef MTC_PLL_BETA
+#define MTC_PLL_BETA 0.0013                 // Speed correction per update, ~critically damped
+#endif
+
+#ifndef MTC_PLL_RELOCK_MS
+#define MTC_PLL_RELOCK_MS 100.0             // Residuals above this are a timecode jump
+#endif
+
+#ifndef MTC_PLL_LOCK_MS
+#define MTC_PLL_LOCK_MS 15.0                // Residual considered in lock
+#endif
+
+#ifndef MTC_PLL_LOCK_COUNT
+#define MTC_PLL_LOCK_COUNT 8                // Consecutive updates in lock to trust the estimate
+#endif
+
+#include <atomic>
+
+class MtcClock
+{
+    public:
+        MtcClock(   double alpha = MTC_PLL_ALPHA,
+                    double beta = MTC_PLL_BETA );
+
+        // Sample rate of the clock used to timestamp updates
+        void setSampleRate( unsigned int rate );
+
+        // Feed the raw MTC head once per period, sampleTime being the
+        // audio frame counter at the start of the period. Only changed
+        // values are treated as new measurements.
+        void update( long mtcHeadMs, long long sampleTime );
+        void reset( void );
+
+        // Smoothed MTC position at the given sample time, O(1)
+        double positionMs( long long sampleTime ) const;
+
+        bool isLocked( void ) const;
+        double getSpeed( void ) const;              // MTC ms per sample clock ms
+        double getLastResidualMs( void ) const;
+
+    private:
+        double alpha;
+        double beta;
+        double msPerFrame = 1000.0 / 44100;
+
+        // Estimate: position at refTime and speed
+        double estimateMs = 0.0;
+        long long refTime = 0;
+        double speed = 1.0;
+
+        long lastRawMs = 0;
+        double lastResidualMs = 0.0;
+        double intervalMs = 0.0;                    // Average time between updates
+        bool primed = false;
+        unsigned int lockCount = 0;
+        std::atomic<bool> locked{false};            // Can be polled from other threads
+};
+
+#endif // MTCCLOCK_H
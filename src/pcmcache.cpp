@@ -0,0 +1,265 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems decoded PCM cache source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "pcmcache.h"
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static const char pcmCacheMagic[8] = { 'C', 'U', 'E', 'M', 'S', 'P', 'C', 'M' };
+
+////////////////////////////////////////////
+// FNV-1a, good enough to name files
+////////////////////////////////////////////
+static uint64_t fnv1a( const string& text )
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for ( unsigned char c : text ) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+////////////////////////////////////////////
+string PcmCache::keyFor(    const string& mediaPath, unsigned int sampleRate,
+                            unsigned int channels, const string& quality )
+{
+    struct stat info;
+    if ( stat( mediaPath.c_str(), &info ) != 0 ) {
+        return "";
+    }
+
+    std::error_code error;
+    string absolute = fs::absolute( mediaPath, error ).string();
+    if ( error ) {
+        absolute = mediaPath;
+    }
+
+    string identity = absolute + "|" +
+                      std::to_string( (long long) info.st_mtim.tv_sec ) + "." +
+                      std::to_string( (long long) info.st_mtim.tv_nsec ) + "|" +
+                      std::to_string( (long long) info.st_size ) + "|" +
+                      std::to_string( sampleRate ) + "|" +
+                      std::to_string( channels ) + "|" + quality + "|" +
+                      std::to_string( PCM_CACHE_VERSION );
+
+    char name[32];
+    snprintf( name, sizeof(name), "%016llx", (unsigned long long) fnv1a( identity ) );
+
+    // Readable prefix to find a file's renditions by hand
+    string stem = fs::path( mediaPath ).stem().string().substr( 0, 32 );
+    return stem + "-" + name + "-" + std::to_string( sampleRate ) + "-" + std::to_string( channels );
+}
+
+////////////////////////////////////////////
+string PcmCache::pathFor( const string& directory, const string& key )
+{
+    return ( fs::path( directory ) / ( key + ".pcm" ) ).string();
+}
+
+////////////////////////////////////////////
+// Mapping
+////////////////////////////////////////////
+PcmCache::Mapping::~Mapping( void )
+{
+    close();
+}
+
+////////////////////////////////////////////
+bool PcmCache::Mapping::open( const string& path, unsigned int channels, unsigned int sampleRate )
+{
+    close();
+
+    int fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 ) {
+        return false;
+    }
+
+    struct stat info;
+    if ( fstat( fd, &info ) != 0 || info.st_size < PCM_CACHE_HEADER_SIZE ) {
+        ::close( fd );
+        return false;
+    }
+
+    void* map = mmap( nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    ::close( fd );
+    if ( map == MAP_FAILED ) {
+        return false;
+    }
+
+    const char* header = (const char*) map;
+    uint32_t version, fileChannels, fileRate;
+    uint64_t frames;
+    memcpy( &version, header + 8, 4 );
+    memcpy( &fileChannels, header + 12, 4 );
+    memcpy( &fileRate, header + 16, 4 );
+    memcpy( &frames, header + 24, 8 );
+
+    bool valid = memcmp( header, pcmCacheMagic, 8 ) == 0 &&
+                 version == PCM_CACHE_VERSION &&
+                 fileChannels == channels && fileRate == sampleRate &&
+                 (uint64_t) info.st_size == PCM_CACHE_HEADER_SIZE + frames * channels * sizeof(float);
+
+    if ( !valid ) {
+        munmap( map, info.st_size );
+        return false;
+    }
+
+    // Played front to back, let the kernel read ahead
+    madvise( map, info.st_size, MADV_SEQUENTIAL );
+
+    base = map;
+    length = info.st_size;
+    nFloats = frames * channels;
+    return true;
+}
+
+////////////////////////////////////////////
+void PcmCache::Mapping::close( void )
+{
+    if ( base != nullptr ) {
+        munmap( base, length );
+    }
+    base = nullptr;
+    length = 0;
+    nFloats = 0;
+}
+
+////////////////////////////////////////////
+const float* PcmCache::Mapping::data( void ) const
+{
+    return base != nullptr ? (const float*)( (const char*) base + PCM_CACHE_HEADER_SIZE ) : nullptr;
+}
+
+////////////////////////////////////////////
+// Writer
+////////////////////////////////////////////
+PcmCache::Writer::~Writer( void )
+{
+    abort();
+}
+
+////////////////////////////////////////////
+bool PcmCache::Writer::open( const string& path, unsigned int channels, unsigned int sampleRate )
+{
+    abort();
+
+    std::error_code error;
+    fs::create_directories( fs::path( path ).parent_path(), error );
+
+    // Unique per process, several players may render the same file
+    finalPath = path;
+    tempPath = path + ".tmp" + std::to_string( getpid() );
+    nChannels = channels;
+    floatsWritten = 0;
+
+    out.open( tempPath, ios::binary | ios::trunc );
+    if ( !out.is_open() ) {
+        return false;
+    }
+
+    uint32_t version = PCM_CACHE_VERSION, reserved = 0;
+    uint64_t frames = 0;
+    out.write( pcmCacheMagic, 8 );
+    out.write( (const char*) &version, 4 );
+    out.write( (const char*) &channels, 4 );
+    out.write( (const char*) &sampleRate, 4 );
+    out.write( (const char*) &reserved, 4 );
+    out.write( (const char*) &frames, 8 );
+
+    return out.good();
+}
+
+////////////////////////////////////////////
+bool PcmCache::Writer::write( const float* samples, size_t floats )
+{
+    if ( !out.is_open() ) {
+        return false;
+    }
+
+    out.write( (const char*) samples, floats * sizeof(float) );
+    floatsWritten += floats;
+    return out.good();
+}
+
+////////////////////////////////////////////
+bool PcmCache::Writer::commit( void )
+{
+    if ( !out.is_open() || nChannels == 0 ) {
+        return false;
+    }
+
+    // Whole frames only, the header says how many
+    uint64_t frames = floatsWritten / nChannels;
+    out.seekp( 24 );
+    out.write( (const char*) &frames, 8 );
+    out.close();
+
+    if ( out.fail() || floatsWritten % nChannels != 0 ) {
+        abort();
+        return false;
+    }
+
+    std::error_code error;
+    fs::rename( tempPath, finalPath, error );
+    if ( error ) {
+        abort();
+        return false;
+    }
+
+    tempPath.clear();
+    return true;
+}
+
+////////////////////////////////////////////
+void PcmCache::Writer::abort( void )
+{
+    if ( out.is_open() ) {
+        out.close();
+    }
+
+    if ( !tempPath.empty() ) {
+        std::error_code error;
+        fs::remove( tempPath, error );
+        tempPath.clear();
+    }
+}
@@ -0,0 +1,115 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems decoded PCM cache header file
+//
+// Float32 renditions of media files, at the output rate and
+// channel layout, kept in a directory and played back from a
+// read-only memory mapping. One file per rendition:
+//
+//   "CUEMSPCM" | u32 version | u32 channels | u32 rate | u32 0 |
+//   u64 frames | interleaved float32 samples
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef PCMCACHE_H
+#define PCMCACHE_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#define PCM_CACHE_VERSION 1
+#define PCM_CACHE_HEADER_SIZE 32
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+class PcmCache
+{
+    public:
+        // Cache key of a media file rendition: changes whenever the file
+        // (path, mtime, size) or the rendering (rate, channels, resampling
+        // quality) does. Empty if the file can't be stat'ed.
+        static string keyFor(   const string& mediaPath, unsigned int sampleRate,
+                                unsigned int channels, const string& quality );
+        static string pathFor( const string& directory, const string& key );
+
+        //////////////////////////////////////////
+        // Read-only mapping of a cached rendition
+        class Mapping
+        {
+            public:
+                Mapping( void ) {}
+                ~Mapping( void );
+
+                Mapping( const Mapping& ) = delete;
+                Mapping& operator=( const Mapping& ) = delete;
+
+                // Fails on missing, truncated or foreign files
+                bool open( const string& path, unsigned int channels, unsigned int sampleRate );
+                void close( void );
+
+                bool isOpen( void ) const { return base != nullptr; }
+                const float* data( void ) const;
+                size_t floats( void ) const { return nFloats; }
+
+            private:
+                void* base = nullptr;
+                size_t length = 0;
+                size_t nFloats = 0;
+        };
+
+        //////////////////////////////////////////
+        // Streams a rendition to a temporary file, only visible to
+        // others once commit() renames it into place
+        class Writer
+        {
+            public:
+                Writer( void ) {}
+                ~Writer( void );
+
+                bool open( const string& path, unsigned int channels, unsigned int sampleRate );
+                bool write( const float* samples, size_t floats );
+                bool commit( void );
+                void abort( void );
+
+            private:
+                ofstream out;
+                string finalPath;
+                string tempPath;
+                unsigned int nChannels = 0;
+                uint64_t floatsWritten = 0;
+        };
+};
+
+#endif // PCMCACHE_H
@@ -0,0 +1,691 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems native PCM reader source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "pcmreader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PCM_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PCM_NEON
+#endif
+
+#define INT16_SCALE ( 1.0f / 32768.0f )
+#define INT24_SCALE ( 1.0f / 8388608.0f )
+#define INT32_SCALE ( 1.0f / 2147483648.0f )
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_IEEE_FLOAT  0x0003
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+// Sony Wave64 chunk GUIDs, the first four bytes spell the RIFF name
+static const unsigned char w64Riff[16] = { 'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11,
+                                           0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00 };
+static const unsigned char w64Wave[16] = { 'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11,
+                                           0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+static const unsigned char w64Fmt[16]  = { 'f', 'm', 't', ' ', 0xF3, 0xAC, 0xD3, 0x11,
+                                           0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+static const unsigned char w64Data[16] = { 'd', 'a', 't', 'a', 0xF3, 0xAC, 0xD3, 0x11,
+                                           0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+
+////////////////////////////////////////////
+// Byte order helpers, whatever the host's
+////////////////////////////////////////////
+static inline uint16_t le16( const unsigned char* p ) { return p[0] | p[1] << 8; }
+static inline uint32_t le32( const unsigned char* p ) { return le16( p ) | (uint32_t) le16( p + 2 ) << 16; }
+static inline uint64_t le64( const unsigned char* p ) { return le32( p ) | (uint64_t) le32( p + 4 ) << 32; }
+static inline uint16_t be16( const unsigned char* p ) { return p[0] << 8 | p[1]; }
+static inline uint32_t be32( const unsigned char* p ) { return (uint32_t) be16( p ) << 16 | be16( p + 2 ); }
+
+////////////////////////////////////////////
+// Scalar kernels, also the tails of the vector ones
+////////////////////////////////////////////
+typedef void (*ConvertKernel)( const unsigned char* in, float* out, size_t samples );
+
+static void scalarInt16( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 2 ) {
+        out[i] = (int16_t) le16( in ) * INT16_SCALE;
+    }
+}
+
+static void scalarInt24( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 3 ) {
+        out[i] = ( (int32_t) ( (uint32_t) in[0] << 8 | (uint32_t) in[1] << 16 | (uint32_t) in[2] << 24 ) >> 8 ) * INT24_SCALE;
+    }
+}
+
+static void scalarInt32( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 4 ) {
+        out[i] = (int32_t) le32( in ) * INT32_SCALE;
+    }
+}
+
+static void scalarFloat32( const unsigned char* in, float* out, size_t samples )
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy( out, in, samples * sizeof(float) );
+#else
+    for ( size_t i = 0; i < samples; i++, in += 4 ) {
+        uint32_t bits = le32( in );
+        memcpy( out + i, &bits, sizeof(float) );
+    }
+#endif
+}
+
+static void scalarInt16Be( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 2 ) {
+        out[i] = (int16_t) be16( in ) * INT16_SCALE;
+    }
+}
+
+static void scalarInt24Be( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 3 ) {
+        out[i] = ( (int32_t) ( (uint32_t) in[2] << 8 | (uint32_t) in[1] << 16 | (uint32_t) in[0] << 24 ) >> 8 ) * INT24_SCALE;
+    }
+}
+
+static void scalarInt32Be( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 4 ) {
+        out[i] = (int32_t) be32( in ) * INT32_SCALE;
+    }
+}
+
+static void scalarFloat32Be( const unsigned char* in, float* out, size_t samples )
+{
+    for ( size_t i = 0; i < samples; i++, in += 4 ) {
+        uint32_t bits = be32( in );
+        memcpy( out + i, &bits, sizeof(float) );
+    }
+}
+
+#ifdef PCM_X86
+////////////////////////////////////////////
+// SSE2 (SSSE3 for 24 bit): 4 samples a step
+////////////////////////////////////////////
+__attribute__((target("sse2")))
+static void sseInt16( const unsigned char* in, float* out, size_t samples )
+{
+    const __m128 scale = _mm_set1_ps( INT16_SCALE );
+    size_t i = 0;
+    for ( ; i + 8 <= samples; i += 8 ) {
+        __m128i v = _mm_loadu_si128( (const __m128i*) ( in + i * 2 ) );
+        __m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 );
+        __m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 );
+        _mm_storeu_ps( out + i, _mm_mul_ps( _mm_cvtepi32_ps( lo ), scale ) );
+        _mm_storeu_ps( out + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( hi ), scale ) );
+    }
+    scalarInt16( in + i * 2, out + i, samples - i );
+}
+
+// Each sample's three bytes go to the top of a 32 bit lane, an
+// arithmetic shift then sign extends them
+__attribute__((target("ssse3")))
+static void sseInt24( const unsigned char* in, float* out, size_t samples )
+{
+    const __m128 scale = _mm_set1_ps( INT24_SCALE );
+    const __m128i spread = _mm_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 );
+    size_t i = 0;
+    // 16 byte loads for 12 bytes of samples, stop before reading past the end
+    for ( ; i + 6 <= samples; i += 4 ) {
+        __m128i v = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) ( in + i * 3 ) ), spread );
+        _mm_storeu_ps( out + i, _mm_mul_ps( _mm_cvtepi32_ps( _mm_srai_epi32( v, 8 ) ), scale ) );
+    }
+    scalarInt24( in + i * 3, out + i, samples - i );
+}
+
+__attribute__((target("sse2")))
+static void sseInt32( const unsigned char* in, float* out, size_t samples )
+{
+    const __m128 scale = _mm_set1_ps( INT32_SCALE );
+    size_t i = 0;
+    for ( ; i + 4 <= samples; i += 4 ) {
+        __m128i v = _mm_loadu_si128( (const __m128i*) ( in + i * 4 ) );
+        _mm_storeu_ps( out + i, _mm_mul_ps( _mm_cvtepi32_ps( v ), scale ) );
+    }
+    scalarInt32( in + i * 4, out + i, samples - i );
+}
+
+////////////////////////////////////////////
+// AVX2: 8 samples a step
+////////////////////////////////////////////
+__attribute__((target("avx2")))
+static void avx2Int16( const unsigned char* in, float* out, size_t samples )
+{
+    const __m256 scale = _mm256_set1_ps( INT16_SCALE );
+    size_t i = 0;
+    for ( ; i + 8 <= samples; i += 8 ) {
+        __m256i v = _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i*) ( in + i * 2 ) ) );
+        _mm256_storeu_ps( out + i, _mm256_mul_ps( _mm256_cvtepi32_ps( v ), scale ) );
+    }
+    scalarInt16( in + i * 2, out + i, samples - i );
+}
+
+__attribute__((target("avx2")))
+static void avx2Int24( const unsigned char* in, float* out, size_t samples )
+{
+    const __m256 scale = _mm256_set1_ps( INT24_SCALE );
+    const __m256i spread = _mm256_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                             -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 );
+    size_t i = 0;
+    // Two 16 byte loads, 12 bytes apart, the second ends 28 bytes in
+    for ( ; i + 10 <= samples; i += 8 ) {
+        const unsigned char* p = in + i * 3;
+        __m256i v = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*) p ) ),
+                                             _mm_loadu_si128( (const __m128i*) ( p + 12 ) ), 1 );
+        v = _mm256_srai_epi32( _mm256_shuffle_epi8( v, spread ), 8 );
+        _mm256_storeu_ps( out + i, _mm256_mul_ps( _mm256_cvtepi32_ps( v ), scale ) );
+    }
+    scalarInt24( in + i * 3, out + i, samples - i );
+}
+
+__attribute__((target("avx2")))
+static void avx2Int32( const unsigned char* in, float* out, size_t samples )
+{
+    const __m256 scale = _mm256_set1_ps( INT32_SCALE );
+    size_t i = 0;
+    for ( ; i + 8 <= samples; i += 8 ) {
+        __m256i v = _mm256_loadu_si256( (const __m256i*) ( in + i * 4 ) );
+        _mm256_storeu_ps( out + i, _mm256_mul_ps( _mm256_cvtepi32_ps( v ), scale ) );
+    }
+    scalarInt32( in + i * 4, out + i, samples - i );
+}
+#endif
+
+#ifdef PCM_NEON
+////////////////////////////////////////////
+// NEON: 8 samples a step
+////////////////////////////////////////////
+static void neonInt16( const unsigned char* in, float* out, size_t samples )
+{
+    size_t i = 0;
+    for ( ; i + 8 <= samples; i += 8 ) {
+        int16x8_t v = vld1q_s16( (const int16_t*) ( in + i * 2 ) );
+        vst1q_f32( out + i, vmulq_n_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( v ) ) ), INT16_SCALE ) );
+        vst1q_f32( out + i + 4, vmulq_n_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( v ) ) ), INT16_SCALE ) );
+    }
+    scalarInt16( in + i * 2, out + i, samples - i );
+}
+
+// Deinterleaved into low, middle and (signed) high bytes, then put
+// back together 32 bits wide
+static void neonInt24( const unsigned char* in, float* out, size_t samples )
+{
+    size_t i = 0;
+    for ( ; i + 8 <= samples; i += 8 ) {
+        uint8x8x3_t b = vld3_u8( in + i * 3 );
+        uint16x8_t low = vorrq_u16( vmovl_u8( b.val[0] ), vshll_n_u8( b.val[1], 8 ) );
+        int16x8_t high = vmovl_s8( vreinterpret_s8_u8( b.val[2] ) );
+        int32x4_t v0 = vorrq_s32( vshlq_n_s32( vmovl_s16( vget_low_s16( high ) ), 16 ),
+                                  vreinterpretq_s32_u32( vmovl_u16( vget_low_u16( low ) ) ) );
+        int32x4_t v1 = vorrq_s32( vshlq_n_s32( vmovl_s16( vget_high_s16( high ) ), 16 ),
+                                  vreinterpretq_s32_u32( vmovl_u16( vget_high_u16( low ) ) ) );
+        vst1q_f32( out + i, vmulq_n_f32( vcvtq_f32_s32( v0 ), INT24_SCALE ) );
+        vst1q_f32( out + i + 4, vmulq_n_f32( vcvtq_f32_s32( v1 ), INT24_SCALE ) );
+    }
+    scalarInt24( in + i * 3, out + i, samples - i );
+}
+
+static void neonInt32( const unsigned char* in, float* out, size_t samples )
+{
+    size_t i = 0;
+    for ( ; i + 4 <= samples; i += 4 ) {
+        int32x4_t v = vld1q_s32( (const int32_t*) ( in + i * 4 ) );
+        vst1q_f32( out + i, vmulq_n_f32( vcvtq_f32_s32( v ), INT32_SCALE ) );
+    }
+    scalarInt32( in + i * 4, out + i, samples - i );
+}
+#endif
+
+////////////////////////////////////////////
+// Picked once, on first use. Big endian and float samples always go
+// through the scalar kernels: float is a copy, big endian is rare.
+////////////////////////////////////////////
+struct KernelChoice {
+    ConvertKernel int16;
+    ConvertKernel int24;
+    ConvertKernel int32;
+    const char* name;
+};
+
+static KernelChoice chooseKernels( void )
+{
+#if defined(PCM_X86)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx2" ) ) {
+        return { avx2Int16, avx2Int24, avx2Int32, "avx2" };
+    }
+    if ( __builtin_cpu_supports( "sse2" ) ) {
+        return { sseInt16, __builtin_cpu_supports( "ssse3" ) ? sseInt24 : scalarInt24, sseInt32, "sse" };
+    }
+#elif defined(PCM_NEON)
+    return { neonInt16, neonInt24, neonInt32, "neon" };
+#endif
+    return { scalarInt16, scalarInt24, scalarInt32, "scalar" };
+}
+
+static const KernelChoice& kernelChoice( void )
+{
+    static const KernelChoice choice = chooseKernels();
+    return choice;
+}
+
+////////////////////////////////////////////
+void PcmReader::convert( const unsigned char* in, float* out, size_t samples, Encoding encoding )
+{
+    switch ( encoding ) {
+        case INT16_LE:      kernelChoice().int16( in, out, samples ); break;
+        case INT24_LE:      kernelChoice().int24( in, out, samples ); break;
+        case INT32_LE:      kernelChoice().int32( in, out, samples ); break;
+        case FLOAT32_LE:    scalarFloat32( in, out, samples ); break;
+        case INT16_BE:      scalarInt16Be( in, out, samples ); break;
+        case INT24_BE:      scalarInt24Be( in, out, samples ); break;
+        case INT32_BE:      scalarInt32Be( in, out, samples ); break;
+        case FLOAT32_BE:    scalarFloat32Be( in, out, samples ); break;
+    }
+}
+
+////////////////////////////////////////////
+unsigned int PcmReader::bytesPerSample( Encoding encoding )
+{
+    switch ( encoding ) {
+        case INT16_LE: case INT16_BE: return 2;
+        case INT24_LE: case INT24_BE: return 3;
+        default: return 4;
+    }
+}
+
+////////////////////////////////////////////
+const char* PcmReader::getKernelName( void )
+{
+    return kernelChoice().name;
+}
+
+////////////////////////////////////////////
+const char* PcmReader::getFormatName( void ) const
+{
+    static const char* names[] = { "s16le", "s16be", "s24le", "s24be", "s32le", "s32be", "f32le", "f32be" };
+    return names[encoding];
+}
+
+////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////
+PcmReader::~PcmReader( void )
+{
+    close();
+}
+
+////////////////////////////////////////////
+// Map the file and find its format and sample data
+////////////////////////////////////////////
+bool PcmReader::open( const string& path )
+{
+    close();
+
+    int fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 ) {
+        return false;
+    }
+
+    struct stat info;
+    if ( fstat( fd, &info ) != 0 || info.st_size < 12 ) {
+        ::close( fd );
+        return false;
+    }
+
+    void* map = mmap( nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    ::close( fd );
+    if ( map == MAP_FAILED ) {
+        return false;
+    }
+
+    base = map;
+    length = info.st_size;
+
+    const unsigned char* file = (const unsigned char*) map;
+    size_t size = length;
+    bool found = false;
+
+    if ( ( memcmp( file, "RIFF", 4 ) == 0 || memcmp( file, "RF64", 4 ) == 0 ) && memcmp( file + 8, "WAVE", 4 ) == 0 ) {
+        found = parseRiff( file, size, file[1] == 'F' );
+    }
+    else if ( size >= 40 && memcmp( file, w64Riff, 16 ) == 0 && memcmp( file + 24, w64Wave, 16 ) == 0 ) {
+        found = parseWave64( file, size );
+    }
+    else if ( memcmp( file, "FORM", 4 ) == 0 &&
+              ( memcmp( file + 8, "AIFF", 4 ) == 0 || memcmp( file + 8, "AIFC", 4 ) == 0 ) ) {
+        found = parseAiff( file, size, file[11] == 'C' );
+    }
+
+    if ( !found ) {
+        close();
+        return false;
+    }
+
+    // Played front to back, let the kernel read ahead
+    madvise( map, size, MADV_SEQUENTIAL );
+
+    position = 0;
+    return true;
+}
+
+////////////////////////////////////////////
+void PcmReader::close( void )
+{
+    if ( base != nullptr ) {
+        munmap( base, length );
+    }
+    base = nullptr;
+    length = 0;
+    data = nullptr;
+    nChannels = 0;
+    sampleRate = 0;
+    frameBytes = 0;
+    nFrames = 0;
+    position = 0;
+}
+
+////////////////////////////////////////////
+size_t PcmReader::read( float* out, size_t frames )
+{
+    if ( !isOpen() || position >= nFrames ) {
+        return 0;
+    }
+
+    size_t count = (size_t) std::min( (int64_t) frames, nFrames - position );
+    convert( data + position * frameBytes, out, count * nChannels, encoding );
+    position += count;
+    return count;
+}
+
+////////////////////////////////////////////
+void PcmReader::seek( int64_t frame )
+{
+    position = std::max( (int64_t) 0, std::min( frame, nFrames ) );
+}
+
+////////////////////////////////////////////
+// Shared by every container: the sample layout from the format chunk
+////////////////////////////////////////////
+bool PcmReader::setFormat( unsigned int channels, unsigned int rate, unsigned int bits,
+                           bool isFloat, bool bigEndian )
+{
+    if ( channels == 0 || rate == 0 ) {
+        return false;
+    }
+
+    if ( isFloat && bits == 32 ) {
+        encoding = bigEndian ? FLOAT32_BE : FLOAT32_LE;
+    }
+    else if ( !isFloat && bits == 16 ) {
+        encoding = bigEndian ? INT16_BE : INT16_LE;
+    }
+    else if ( !isFloat && bits == 24 ) {
+        encoding = bigEndian ? INT24_BE : INT24_LE;
+    }
+    else if ( !isFloat && bits == 32 ) {
+        encoding = bigEndian ? INT32_BE : INT32_LE;
+    }
+    else {
+        return false;
+    }
+
+    nChannels = channels;
+    sampleRate = rate;
+    frameBytes = channels * bytesPerSample( encoding );
+    return true;
+}
+
+////////////////////////////////////////////
+// Sample data at offset, as long as the file has it: a chunk cut short
+// (or with an unknown size, from a recorder that never finished) plays
+// up to the end of the file
+////////////////////////////////////////////
+bool PcmReader::setData( size_t offset, uint64_t bytes, size_t size )
+{
+    if ( frameBytes == 0 || offset >= size ) {
+        return false;
+    }
+
+    bytes = std::min( bytes, (uint64_t) ( size - offset ) );
+    nFrames = bytes / frameBytes;
+    data = (const unsigned char*) base + offset;
+    return nFrames > 0;
+}
+
+////////////////////////////////////////////
+// fmt chunk of WAV and Wave64, WAVE_FORMAT_EXTENSIBLE included. The
+// block alignment has to match, padded containers are left to FFmpeg.
+////////////////////////////////////////////
+static bool waveFormat( const unsigned char* fmt, uint64_t size, unsigned int& channels,
+                        unsigned int& rate, unsigned int& bits, bool& isFloat )
+{
+    if ( size < 16 ) {
+        return false;
+    }
+
+    unsigned int tag = le16( fmt );
+    channels = le16( fmt + 2 );
+    rate = le32( fmt + 4 );
+    unsigned int blockAlign = le16( fmt + 12 );
+    bits = le16( fmt + 14 );
+
+    // The sub format GUID starts with the format tag
+    if ( tag == WAVE_FORMAT_EXTENSIBLE ) {
+        if ( size < 40 ) {
+            return false;
+        }
+        tag = le16( fmt + 24 );
+    }
+
+    isFloat = tag == WAVE_FORMAT_IEEE_FLOAT;
+    return ( tag == WAVE_FORMAT_PCM || isFloat ) && blockAlign == channels * ( bits / 8 ) && bits % 8 == 0;
+}
+
+////////////////////////////////////////////
+// RIFF/WAVE, and RF64 with its 64 bit sizes in the ds64 chunk
+////////////////////////////////////////////
+bool PcmReader::parseRiff( const unsigned char* file, size_t size, bool rf64 )
+{
+    unsigned int channels = 0, rate = 0, bits = 0;
+    bool isFloat = false, haveFormat = false;
+    uint64_t rf64DataBytes = 0;
+    size_t dataOffset = 0;
+    uint64_t dataBytes = 0;
+    bool haveData = false;
+
+    size_t offset = 12;
+    while ( offset + 8 <= size && !( haveFormat && haveData ) ) {
+        const unsigned char* chunk = file + offset;
+        uint64_t chunkSize = le32( chunk + 4 );
+        size_t body = offset + 8;
+
+        if ( memcmp( chunk, "ds64", 4 ) == 0 && rf64 && body + 16 <= size ) {
+            rf64DataBytes = le64( file + body + 8 );
+        }
+        else if ( memcmp( chunk, "fmt ", 4 ) == 0 && body + chunkSize <= size ) {
+            haveFormat = waveFormat( file + body, chunkSize, channels, rate, bits, isFloat );
+            if ( !haveFormat ) {
+                return false;
+            }
+        }
+        else if ( memcmp( chunk, "data", 4 ) == 0 ) {
+            dataOffset = body;
+            dataBytes = ( rf64 && chunkSize == 0xFFFFFFFF ) ? rf64DataBytes : chunkSize;
+            // Unknown length from a streaming writer
+            if ( dataBytes == 0xFFFFFFFF || dataBytes == 0 ) {
+                dataBytes = size - body;
+            }
+            haveData = true;
+        }
+
+        offset = body + chunkSize + ( chunkSize & 1 );
+    }
+
+    return haveFormat && haveData &&
+           setFormat( channels, rate, bits, isFloat, false ) &&
+           setData( dataOffset, dataBytes, size );
+}
+
+////////////////////////////////////////////
+// Sony Wave64: GUID chunk names, 64 bit sizes counting the 24 byte
+// chunk header, chunks aligned to 8 bytes
+////////////////////////////////////////////
+bool PcmReader::parseWave64( const unsigned char* file, size_t size )
+{
+    unsigned int channels = 0, rate = 0, bits = 0;
+    bool isFloat = false, haveFormat = false;
+
+    size_t offset = 40;
+    while ( offset + 24 <= size ) {
+        const unsigned char* chunk = file + offset;
+        uint64_t chunkSize = le64( chunk + 16 );
+        if ( chunkSize < 24 ) {
+            return false;
+        }
+        size_t body = offset + 24;
+
+        if ( memcmp( chunk, w64Fmt, 16 ) == 0 && offset + chunkSize <= size ) {
+            haveFormat = waveFormat( file + body, chunkSize - 24, channels, rate, bits, isFloat );
+            if ( !haveFormat ) {
+                return false;
+            }
+        }
+        else if ( memcmp( chunk, w64Data, 16 ) == 0 ) {
+            return haveFormat &&
+                   setFormat( channels, rate, bits, isFloat, false ) &&
+                   setData( body, chunkSize - 24, size );
+        }
+
+        if ( chunkSize > size - offset ) {
+            break;
+        }
+        offset += ( chunkSize + 7 ) & ~(uint64_t) 7;
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////
+// IEEE 754 80 bit extended, the AIFF sample rate
+////////////////////////////////////////////
+static double extendedToDouble( const unsigned char* p )
+{
+    int exponent = ( ( p[0] & 0x7F ) << 8 | p[1] ) - 16383 - 63;
+    uint64_t mantissa = (uint64_t) be32( p + 2 ) << 32 | be32( p + 6 );
+    double value = std::ldexp( (double) mantissa, exponent );
+    return ( p[0] & 0x80 ) ? -value : value;
+}
+
+////////////////////////////////////////////
+// AIFF (big endian integers) and AIFF-C with no compression, byte
+// swapped integers ("sowt") or 32 bit float
+////////////////////////////////////////////
+bool PcmReader::parseAiff( const unsigned char* file, size_t size, bool aifc )
+{
+    unsigned int channels = 0, rate = 0, bits = 0;
+    uint64_t frames = 0;
+    bool isFloat = false, bigEndian = true, haveFormat = false;
+    size_t dataOffset = 0;
+    uint64_t dataBytes = 0;
+    bool haveData = false;
+
+    size_t offset = 12;
+    while ( offset + 8 <= size && !( haveFormat && haveData ) ) {
+        const unsigned char* chunk = file + offset;
+        uint64_t chunkSize = be32( chunk + 4 );
+        size_t body = offset + 8;
+
+        if ( memcmp( chunk, "COMM", 4 ) == 0 && chunkSize >= 18 && body + chunkSize <= size ) {
+            const unsigned char* comm = file + body;
+            channels = be16( comm );
+            frames = be32( comm + 2 );
+            bits = be16( comm + 6 );
+            double sampleRate = extendedToDouble( comm + 8 );
+            if ( sampleRate < 1.0 || sampleRate > 1e7 ) {
+                return false;
+            }
+            rate = (unsigned int) std::lround( sampleRate );
+
+            if ( aifc ) {
+                if ( chunkSize < 22 ) {
+                    return false;
+                }
+                const unsigned char* compression = comm + 18;
+                if ( memcmp( compression, "sowt", 4 ) == 0 ) {
+                    bigEndian = false;
+                }
+                else if ( memcmp( compression, "fl32", 4 ) == 0 || memcmp( compression, "FL32", 4 ) == 0 ) {
+                    isFloat = true;
+                }
+                else if ( memcmp( compression, "NONE", 4 ) != 0 && memcmp( compression, "twos", 4 ) != 0 ) {
+                    return false;
+                }
+            }
+            haveFormat = true;
+        }
+        else if ( memcmp( chunk, "SSND", 4 ) == 0 && chunkSize >= 8 && body + 8 <= size ) {
+            uint32_t dataStart = be32( file + body );
+            if ( chunkSize < 8 + (uint64_t) dataStart ) {
+                return false;
+            }
+            dataOffset = body + 8 + dataStart;
+            dataBytes = chunkSize - 8 - dataStart;
+            haveData = true;
+        }
+
+        offset = body + chunkSize + ( chunkSize & 1 );
+    }
+
+    if ( !haveFormat || !haveData || !setFormat( channels, rate, bits, isFloat, bigEndian ) ) {
+        return false;
+    }
+
+    // COMM has the authoritative frame count
+    return setData( dataOffset, std::min( dataBytes, frames * frameBytes ), size );
+}
@@ -0,0 +1,111 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems native PCM reader header file
+//
+// Uncompressed PCM files (WAV, RF64, Sony Wave64, AIFF and AIFF-C)
+// read straight from a memory mapping of their sample data, without
+// going through a demuxer and a decoder. 16, 24 and 32 bit integer
+// and 32 bit float samples, either byte order, are converted to
+// interleaved float by vectorised kernels (AVX2, SSE2/SSSE3 or NEON,
+// chosen once at run time) with a scalar fallback. Seeking is an
+// offset into the mapping, exact and constant time.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef PCMREADER_H
+#define PCMREADER_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+class PcmReader
+{
+    public:
+        enum Encoding {
+            INT16_LE, INT16_BE,
+            INT24_LE, INT24_BE,
+            INT32_LE, INT32_BE,
+            FLOAT32_LE, FLOAT32_BE
+        };
+
+        PcmReader( void ) {}
+        ~PcmReader( void );
+
+        PcmReader( const PcmReader& ) = delete;
+        PcmReader& operator=( const PcmReader& ) = delete;
+
+        // Fails on anything that is not one of the formats above, which
+        // is left to FFmpeg: compressed codecs, 8 or 64 bit samples...
+        bool open( const string& path );
+        void close( void );
+        bool isOpen( void ) const { return base != nullptr; }
+
+        // Reads up to frames interleaved frames as float from the current
+        // position. Returns the frames read, fewer only at the end.
+        size_t read( float* out, size_t frames );
+
+        // Moves to a frame, clamped to the end of the file
+        void seek( int64_t frame );
+        int64_t tell( void ) const { return position; }
+
+        unsigned int getChannels( void ) const { return nChannels; }
+        unsigned int getSampleRate( void ) const { return sampleRate; }
+        int64_t getFrames( void ) const { return nFrames; }
+        Encoding getEncoding( void ) const { return encoding; }
+        const char* getFormatName( void ) const;    // "s16le", "s24be", "f32le"...
+
+        // Sample conversion on its own, samples is frames * channels
+        static void convert( const unsigned char* in, float* out, size_t samples, Encoding encoding );
+        static unsigned int bytesPerSample( Encoding encoding );
+        static const char* getKernelName( void );  // "avx2", "sse", "neon" or "scalar"
+
+    private:
+        bool parseRiff( const unsigned char* file, size_t size, bool rf64 );
+        bool parseWave64( const unsigned char* file, size_t size );
+        bool parseAiff( const unsigned char* file, size_t size, bool aifc );
+        bool setFormat( unsigned int channels, unsigned int rate, unsigned int bits,
+                        bool isFloat, bool bigEndian );
+        bool setData( size_t offset, uint64_t bytes, size_t size );
+
+        void* base = nullptr;
+        size_t length = 0;
+        const unsigned char* data = nullptr;    // First sample in the mapping
+        unsigned int nChannels = 0;
+        unsigned int sampleRate = 0;
+        Encoding encoding = INT16_LE;
+        size_t frameBytes = 0;
+        int64_t nFrames = 0;
+        int64_t position = 0;
+};
+
+#endif // PCMREADER_H
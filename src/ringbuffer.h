@@ -0,0 +1,143 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems single producer / single consumer
+// lock-free ring buffer template header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+////////////////////////////////////////////
+// Wait-free ring buffer for exactly one writer thread and one
+// reader thread. Indexes are free running counters, capacity is
+// rounded up to a power of two so wrapping is a mask.
+//
+// Memory is only (re)allocated in allocate(), which must not run
+// concurrently with read() / write(). reset() is only safe while
+// the consumer is known not to be touching the buffer.
+////////////////////////////////////////////
+template <typename T>
+class RingBuffer
+{
+    public:
+        RingBuffer( void ) {}
+        ~RingBuffer( void ) { delete[] data; }
+
+        RingBuffer( const RingBuffer& ) = delete;
+        RingBuffer& operator=( const RingBuffer& ) = delete;
+
+        // Allocates at least minCapacity elements (not real-time safe)
+        void allocate( size_t minCapacity ) {
+            size_t newCapacity = 1;
+            while ( newCapacity < minCapacity ) newCapacity <<= 1;
+
+            delete[] data;
+            data = new T[newCapacity]();
+            capacity = newCapacity;
+            mask = newCapacity - 1;
+            writeIndex.store( 0, std::memory_order_relaxed );
+            readIndex.store( 0, std::memory_order_relaxed );
+        }
+
+        size_t size( void ) const { return capacity; }
+
+        // Elements ready to be read (consumer side)
+        size_t readAvailable( void ) const {
+            return writeIndex.load( std::memory_order_acquire ) -
+                   readIndex.load( std::memory_order_relaxed );
+        }
+
+        // Free room for writing (producer side)
+        size_t writeAvailable( void ) const {
+            return capacity - ( writeIndex.load( std::memory_order_relaxed ) -
+                                readIndex.load( std::memory_order_acquire ) );
+        }
+
+        // Producer: copies up to count elements, returns how many were written
+        size_t write( const T* src, size_t count ) {
+            size_t w = writeIndex.load( std::memory_order_relaxed );
+            size_t r = readIndex.load( std::memory_order_acquire );
+            size_t n = std::min( count, capacity - ( w - r ) );
+
+            size_t first = std::min( n, capacity - ( w & mask ) );
+            memcpy( data + ( w & mask ), src, first * sizeof(T) );
+            memcpy( data, src + first, ( n - first ) * sizeof(T) );
+
+            writeIndex.store( w + n, std::memory_order_release );
+            return n;
+        }
+
+        // Consumer: copies up to count elements, returns how many were read
+        size_t read( T* dst, size_t count ) {
+            size_t r = readIndex.load( std::memory_order_relaxed );
+            size_t w = writeIndex.load( std::memory_order_acquire );
+            size_t n = std::min( count, w - r );
+
+            size_t first = std::min( n, capacity - ( r & mask ) );
+            memcpy( dst, data + ( r & mask ), first * sizeof(T) );
+            memcpy( dst + first, data, ( n - first ) * sizeof(T) );
+
+            readIndex.store( r + n, std::memory_order_release );
+            return n;
+        }
+
+        // Consumer: drops up to count elements, returns how many were dropped
+        size_t skip( size_t count ) {
+            size_t r = readIndex.load( std::memory_order_relaxed );
+            size_t w = writeIndex.load( std::memory_order_acquire );
+            size_t n = std::min( count, w - r );
+
+            readIndex.store( r + n, std::memory_order_release );
+            return n;
+        }
+
+        // Empties the buffer, only with the consumer parked
+        void reset( void ) {
+            readIndex.store( writeIndex.load( std::memory_order_relaxed ),
+                             std::memory_order_release );
+        }
+
+    private:
+        T* data = nullptr;
+        size_t capacity = 0;
+        size_t mask = 0;
+
+        // Separate cache lines so producer and consumer don't false share
+        alignas(64) std::atomic<size_t> writeIndex{0};
+        alignas(64) std::atomic<size_t> readIndex{0};
+};
+
+#endif // RINGBUFFER_H
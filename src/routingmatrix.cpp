@@ -0,0 +1,364 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems routing matrix source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "routingmatrix.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROUTING_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ROUTING_NEON
+#endif
+
+////////////////////////////////////////////
+// Kernels: for each frame and each vector of outputs, add up the
+// columns of the routed inputs scaled by their samples. Whole vectors
+// are stored even past the last output of a frame, the next frame
+// overwrites them; only stores that would pass the end of the buffer go
+// through a scratch vector.
+////////////////////////////////////////////
+typedef void (*RoutingKernel)( const float* in, float* out, unsigned int frames,
+                               unsigned int inputs, unsigned int outputs, unsigned int stride,
+                               const unsigned int* active, unsigned int activeCount,
+                               const float (*columns)[ROUTING_MAX_CHANNELS] );
+
+static void scalarKernel( const float* in, float* out, unsigned int frames,
+                          unsigned int inputs, unsigned int outputs, unsigned int /*stride*/,
+                          const unsigned int* active, unsigned int activeCount,
+                          const float (*columns)[ROUTING_MAX_CHANNELS] )
+{
+    for ( unsigned int f = 0; f < frames; f++, in += inputs, out += outputs ) {
+        for ( unsigned int o = 0; o < outputs; o++ ) {
+            out[o] = 0.0f;
+        }
+
+        for ( unsigned int a = 0; a < activeCount; a++ ) {
+            float sample = in[active[a]];
+            const float* column = columns[active[a]];
+            for ( unsigned int o = 0; o < outputs; o++ ) {
+                out[o] += sample * column[o];
+            }
+        }
+    }
+}
+
+#ifdef ROUTING_X86
+static void sseKernel( const float* in, float* out, unsigned int frames,
+                       unsigned int inputs, unsigned int outputs, unsigned int stride,
+                       const unsigned int* active, unsigned int activeCount,
+                       const float (*columns)[ROUTING_MAX_CHANNELS] )
+{
+    float* end = out + (size_t) frames * outputs;
+    alignas(16) float scratch[4];
+
+    for ( unsigned int f = 0; f < frames; f++, in += inputs, out += outputs ) {
+        for ( unsigned int o = 0; o < stride; o += 4 ) {
+            __m128 sum = _mm_setzero_ps();
+            for ( unsigned int a = 0; a < activeCount; a++ ) {
+                sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( in[active[a]] ), _mm_load_ps( columns[active[a]] + o ) ) );
+            }
+
+            if ( out + o + 4 <= end ) {
+                _mm_storeu_ps( out + o, sum );
+            }
+            else if ( o < outputs ) {
+                _mm_store_ps( scratch, sum );
+                memcpy( out + o, scratch, std::min( 4u, outputs - o ) * sizeof( float ) );
+            }
+        }
+    }
+}
+
+__attribute__((target("avx")))
+static void avxKernel( const float* in, float* out, unsigned int frames,
+                       unsigned int inputs, unsigned int outputs, unsigned int stride,
+                       const unsigned int* active, unsigned int activeCount,
+                       const float (*columns)[ROUTING_MAX_CHANNELS] )
+{
+    float* end = out + (size_t) frames * outputs;
+    alignas(32) float scratch[8];
+
+    for ( unsigned int f = 0; f < frames; f++, in += inputs, out += outputs ) {
+        for ( unsigned int o = 0; o < stride; o += 8 ) {
+            __m256 sum = _mm256_setzero_ps();
+            for ( unsigned int a = 0; a < activeCount; a++ ) {
+                sum = _mm256_add_ps( sum, _mm256_mul_ps( _mm256_set1_ps( in[active[a]] ), _mm256_load_ps( columns[active[a]] + o ) ) );
+            }
+
+            if ( out + o + 8 <= end ) {
+                _mm256_storeu_ps( out + o, sum );
+            }
+            else if ( o < outputs ) {
+                _mm256_store_ps( scratch, sum );
+                memcpy( out + o, scratch, std::min( 8u, outputs - o ) * sizeof( float ) );
+            }
+        }
+    }
+}
+#endif
+
+#ifdef ROUTING_NEON
+static void neonKernel( const float* in, float* out, unsigned int frames,
+                        unsigned int inputs, unsigned int outputs, unsigned int stride,
+                        const unsigned int* active, unsigned int activeCount,
+                        const float (*columns)[ROUTING_MAX_CHANNELS] )
+{
+    float* end = out + (size_t) frames * outputs;
+    float scratch[4];
+
+    for ( unsigned int f = 0; f < frames; f++, in += inputs, out += outputs ) {
+        for ( unsigned int o = 0; o < stride; o += 4 ) {
+            float32x4_t sum = vdupq_n_f32( 0.0f );
+            for ( unsigned int a = 0; a < activeCount; a++ ) {
+                sum = vmlaq_n_f32( sum, vld1q_f32( columns[active[a]] + o ), in[active[a]] );
+            }
+
+            if ( out + o + 4 <= end ) {
+                vst1q_f32( out + o, sum );
+            }
+            else if ( o < outputs ) {
+                vst1q_f32( scratch, sum );
+                memcpy( out + o, scratch, std::min( 4u, outputs - o ) * sizeof( float ) );
+            }
+        }
+    }
+}
+#endif
+
+////////////////////////////////////////////
+// Picked once, on first use
+////////////////////////////////////////////
+struct KernelChoice {
+    RoutingKernel kernel;
+    const char* name;
+};
+
+static KernelChoice chooseKernel( void )
+{
+#if defined(ROUTING_X86)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx" ) ) {
+        return { avxKernel, "avx" };
+    }
+    if ( __builtin_cpu_supports( "sse" ) ) {
+        return { sseKernel, "sse" };
+    }
+#elif defined(ROUTING_NEON)
+    return { neonKernel, "neon" };
+#endif
+    return { scalarKernel, "scalar" };
+}
+
+static const KernelChoice& kernelChoice( void )
+{
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+////////////////////////////////////////////
+// Constructor, empty matrix
+////////////////////////////////////////////
+RoutingMatrix::RoutingMatrix( void )
+{
+    memset( edit.columns, 0, sizeof( edit.columns ) );
+    for ( Matrix& buffer : buffers ) {
+        memset( buffer.columns, 0, sizeof( buffer.columns ) );
+    }
+
+    // Resolve the kernel now rather than in the audio thread
+    kernelChoice();
+}
+
+////////////////////////////////////////////
+void RoutingMatrix::setSize( unsigned int inputs, unsigned int outputs )
+{
+    edit.inputs = std::min( inputs, (unsigned int) ROUTING_MAX_CHANNELS );
+    edit.outputs = std::min( outputs, (unsigned int) ROUTING_MAX_CHANNELS );
+    edit.stride = ( edit.outputs + ROUTING_VECTOR_FLOATS - 1 ) / ROUTING_VECTOR_FLOATS * ROUTING_VECTOR_FLOATS;
+
+    setDefault();
+}
+
+////////////////////////////////////////////
+void RoutingMatrix::setDefault( void )
+{
+    memset( edit.columns, 0, sizeof( edit.columns ) );
+
+    if ( edit.inputs > 0 && edit.outputs > 0 ) {
+        if ( edit.outputs >= edit.inputs ) {
+            for ( unsigned int o = 0; o < edit.outputs; o++ ) {
+                edit.columns[o % edit.inputs][o] = 1.0f;
+            }
+        }
+        else {
+            for ( unsigned int i = 0; i < edit.inputs; i++ ) {
+                edit.columns[i][i % edit.outputs] = 1.0f;
+            }
+        }
+    }
+
+    publish();
+}
+
+////////////////////////////////////////////
+void RoutingMatrix::setRoutes( const std::vector<Route>& routes )
+{
+    memset( edit.columns, 0, sizeof( edit.columns ) );
+
+    for ( const Route& route : routes ) {
+        if ( route.input < edit.inputs && route.output < edit.outputs ) {
+            edit.columns[route.input][route.output] = route.gain;
+        }
+    }
+
+    publish();
+}
+
+////////////////////////////////////////////
+void RoutingMatrix::setGain( unsigned int input, unsigned int output, float gain )
+{
+    if ( input < edit.inputs && output < edit.outputs ) {
+        edit.columns[input][output] = gain;
+        publish();
+    }
+}
+
+////////////////////////////////////////////
+float RoutingMatrix::getGain( unsigned int input, unsigned int output ) const
+{
+    return ( input < edit.inputs && output < edit.outputs ) ? edit.columns[input][output] : 0.0f;
+}
+
+////////////////////////////////////////////
+unsigned int RoutingMatrix::getInputs( void ) const
+{
+    return edit.inputs;
+}
+
+////////////////////////////////////////////
+unsigned int RoutingMatrix::getOutputs( void ) const
+{
+    return edit.outputs;
+}
+
+////////////////////////////////////////////
+const char* RoutingMatrix::getKernelName( void )
+{
+    return kernelChoice().name;
+}
+
+////////////////////////////////////////////
+std::vector<RoutingMatrix::Route> RoutingMatrix::parseRoutes( const std::string& spec )
+{
+    std::vector<Route> routes;
+    std::stringstream entries( spec );
+    std::string entry;
+
+    while ( std::getline( entries, entry, ',' ) ) {
+        Route route;
+        route.gain = 1.0f;
+
+        std::stringstream fields( entry );
+        char colon;
+        if ( !( fields >> route.input >> colon ) || colon != ':' || !( fields >> route.output ) ) {
+            throw std::invalid_argument( "Bad route: " + entry );
+        }
+        if ( fields >> colon ) {
+            if ( colon != ':' || !( fields >> route.gain ) ) {
+                throw std::invalid_argument( "Bad route gain: " + entry );
+            }
+        }
+        if ( !fields.eof() || route.input >= ROUTING_MAX_CHANNELS || route.output >= ROUTING_MAX_CHANNELS ) {
+            throw std::invalid_argument( "Bad route: " + entry );
+        }
+
+        routes.push_back( route );
+    }
+
+    if ( routes.empty() ) {
+        throw std::invalid_argument( "No routes in: " + spec );
+    }
+
+    return routes;
+}
+
+////////////////////////////////////////////
+// Control thread: hand the working copy to the audio thread
+////////////////////////////////////////////
+void RoutingMatrix::publish( void )
+{
+    edit.activeCount = 0;
+    edit.identity = edit.inputs == edit.outputs;
+
+    for ( unsigned int i = 0; i < edit.inputs; i++ ) {
+        bool routed = false;
+        for ( unsigned int o = 0; o < edit.outputs; o++ ) {
+            routed = routed || edit.columns[i][o] != 0.0f;
+            edit.identity = edit.identity && edit.columns[i][o] == ( i == o ? 1.0f : 0.0f );
+        }
+
+        if ( routed ) {
+            edit.active[edit.activeCount++] = i;
+        }
+    }
+
+    buffers[writeIndex] = edit;
+    writeIndex = middle.exchange( writeIndex | FRESH, std::memory_order_acq_rel ) & ~FRESH;
+}
+
+////////////////////////////////////////////
+// Audio thread
+////////////////////////////////////////////
+void RoutingMatrix::route( const float* in, float* out, unsigned int frames )
+{
+    if ( middle.load( std::memory_order_relaxed ) & FRESH ) {
+        readIndex = middle.exchange( readIndex, std::memory_order_acq_rel ) & ~FRESH;
+    }
+
+    const Matrix& matrix = buffers[readIndex];
+
+    if ( matrix.identity ) {
+        memcpy( out, in, (size_t) frames * matrix.outputs * sizeof( float ) );
+        return;
+    }
+
+    kernelChoice().kernel( in, out, frames, matrix.inputs, matrix.outputs, matrix.stride,
+                           matrix.active, matrix.activeCount, matrix.columns );
+}
@@ -0,0 +1,112 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems routing matrix header file
+//
+// Gain matrix from the channels of a file to the output ports of the
+// player, so a stereo file can feed six speakers with no second player
+// and no remix of the file. Routes are edited from the control thread
+// and reach the audio thread whole, through a triple buffer, at its next
+// period. Each output frame is computed as a sum of matrix columns
+// scaled by the input samples, vectorised over the outputs (AVX, SSE or
+// NEON, scalar fallback, chosen at run time).
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef ROUTINGMATRIX_H
+#define ROUTINGMATRIX_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef ROUTING_MAX_CHANNELS
+#define ROUTING_MAX_CHANNELS 64             // Inputs and outputs a matrix can have
+#endif
+
+#define ROUTING_VECTOR_FLOATS 8             // Columns are padded to whole vectors of this size
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+class RoutingMatrix
+{
+    public:
+        struct Route {
+            unsigned int input;
+            unsigned int output;
+            float gain;
+        };
+
+        RoutingMatrix( void );
+
+        // Control thread, one at a time
+        void setSize( unsigned int inputs, unsigned int outputs );  // Also resets the default routes
+        void setDefault( void );        // Channel k of the wider side to k modulo the narrower one
+        void setRoutes( const std::vector<Route>& routes );         // Only these, the rest silent
+        void setGain( unsigned int input, unsigned int output, float gain );
+        float getGain( unsigned int input, unsigned int output ) const;
+        unsigned int getInputs( void ) const;
+        unsigned int getOutputs( void ) const;
+
+        // Audio thread: out (frames x outputs) = matrix x in (frames x inputs),
+        // both interleaved and not overlapping. Takes the latest routes first.
+        void route( const float* in, float* out, unsigned int frames );
+
+        static const char* getKernelName( void );  // "avx", "sse", "neon" or "scalar"
+
+        // "in:out[:gain],..." e.g. "0:0,1:1,0:2:0.5", throws std::invalid_argument
+        static std::vector<Route> parseRoutes( const std::string& spec );
+
+    private:
+        struct Matrix {
+            unsigned int inputs = 0;
+            unsigned int outputs = 0;
+            unsigned int stride = 0;                    // outputs rounded up to whole vectors
+            bool identity = false;                      // Same counts, input k to output k at unity
+            unsigned int activeCount = 0;               // Inputs routed anywhere
+            unsigned int active[ROUTING_MAX_CHANNELS];
+            alignas(32) float columns[ROUTING_MAX_CHANNELS][ROUTING_MAX_CHANNELS];  // [input][output]
+        };
+
+        void publish( void );
+
+        Matrix edit;                                    // Control thread working copy
+
+        // Triple buffer: the control thread fills buffers[writeIndex] and
+        // swaps it with middle, the audio thread swaps middle with
+        // buffers[readIndex] when it holds a fresher matrix
+        static const unsigned int FRESH = 4;
+        Matrix buffers[3];
+        unsigned int writeIndex = 0;
+        std::atomic<unsigned int> middle{1};
+        unsigned int readIndex = 2;
+};
+
+#endif // ROUTINGMATRIX_H
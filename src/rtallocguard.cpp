@@ -0,0 +1,180 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems real-time allocation guard source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "rtallocguard.h"
+
+#ifdef CUEMS_RT_ALLOC_CHECK
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <unistd.h>
+
+// glibc entry points we forward to once the allocation is accounted
+extern "C" {
+    void* __libc_malloc( size_t size );
+    void* __libc_calloc( size_t count, size_t size );
+    void* __libc_realloc( void* ptr, size_t size );
+    void* __libc_memalign( size_t alignment, size_t size );
+}
+
+////////////////////////////////////////////
+// Guard state
+////////////////////////////////////////////
+static __thread int rtDepth = 0;
+static std::atomic<unsigned long long> allocationCount{0};
+static std::atomic<unsigned long long> newCount{0};
+static int abortOnAllocation = -1;      // Lazily read from the environment
+
+static void rtAllocationHit( void )
+{
+    allocationCount.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( abortOnAllocation < 0 ) {
+        abortOnAllocation = ( getenv( "CUEMS_RT_ALLOC_ABORT" ) != nullptr ) ? 1 : 0;
+    }
+
+    if ( abortOnAllocation ) {
+        // No stdio here, we are inside the allocator
+        static const char msg[] = "RtAllocGuard: heap allocation on a real-time thread\n";
+        ssize_t ignored = write( STDERR_FILENO, msg, sizeof(msg) - 1 );
+        (void) ignored;
+        abort();
+    }
+}
+
+////////////////////////////////////////////
+RtAllocGuard::RtAllocGuard( void )
+{
+    rtDepth++;
+}
+
+////////////////////////////////////////////
+RtAllocGuard::~RtAllocGuard( void )
+{
+    rtDepth--;
+}
+
+////////////////////////////////////////////
+unsigned long long RtAllocGuard::getAllocationCount( void )
+{
+    return allocationCount.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+unsigned long long RtAllocGuard::getNewCount( void )
+{
+    return newCount.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void RtAllocGuard::resetCounts( void )
+{
+    allocationCount.store( 0 );
+    newCount.store( 0 );
+}
+
+////////////////////////////////////////////
+// malloc family interposition
+////////////////////////////////////////////
+extern "C" void* malloc( size_t size )
+{
+    if ( rtDepth ) rtAllocationHit();
+    return __libc_malloc( size );
+}
+
+extern "C" void* calloc( size_t count, size_t size )
+{
+    if ( rtDepth ) rtAllocationHit();
+    return __libc_calloc( count, size );
+}
+
+extern "C" void* realloc( void* ptr, size_t size )
+{
+    if ( rtDepth ) rtAllocationHit();
+    return __libc_realloc( ptr, size );
+}
+
+extern "C" void* aligned_alloc( size_t alignment, size_t size )
+{
+    if ( rtDepth ) rtAllocationHit();
+    return __libc_memalign( alignment, size );
+}
+
+extern "C" int posix_memalign( void** ptr, size_t alignment, size_t size )
+{
+    if ( rtDepth ) rtAllocationHit();
+    *ptr = __libc_memalign( alignment, size );
+    return ( *ptr == nullptr && size != 0 ) ? 12 /* ENOMEM */ : 0;
+}
+
+////////////////////////////////////////////
+// C++ allocation operators, counted on their own so tests can tell
+// our code apart from allocations made inside FFmpeg
+////////////////////////////////////////////
+void* operator new( size_t size )
+{
+    if ( rtDepth ) newCount.fetch_add( 1, std::memory_order_relaxed );
+
+    void* ptr = malloc( size ? size : 1 );
+    if ( !ptr ) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    free( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+    free( ptr );
+}
+
+void operator delete( void* ptr, size_t ) noexcept
+{
+    free( ptr );
+}
+
+void operator delete[]( void* ptr, size_t ) noexcept
+{
+    free( ptr );
+}
+
+#endif // CUEMS_RT_ALLOC_CHECK
@@ -0,0 +1,77 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems real-time allocation guard header file
+//
+// Debug aid: built with -DCUEMS_RT_ALLOC_CHECK=ON, every heap
+// allocation made while a guard is alive on the current thread is
+// counted (and aborts the process if CUEMS_RT_ALLOC_ABORT is set in
+// the environment). Without the option the guard compiles to nothing.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef RTALLOCGUARD_H
+#define RTALLOCGUARD_H
+
+#ifdef CUEMS_RT_ALLOC_CHECK
+
+class RtAllocGuard
+{
+    public:
+        RtAllocGuard( void );       // Marks the current thread as real-time
+        ~RtAllocGuard( void );
+
+        RtAllocGuard( const RtAllocGuard& ) = delete;
+        RtAllocGuard& operator=( const RtAllocGuard& ) = delete;
+
+        static bool enabled( void ) { return true; }
+
+        // Any malloc family call (FFmpeg included) on a guarded thread
+        static unsigned long long getAllocationCount( void );
+        // Only C++ operator new calls, i.e. our own code
+        static unsigned long long getNewCount( void );
+        static void resetCounts( void );
+};
+
+#else
+
+class RtAllocGuard
+{
+    public:
+        RtAllocGuard( void ) {}
+
+        static bool enabled( void ) { return false; }
+        static unsigned long long getAllocationCount( void ) { return 0; }
+        static unsigned long long getNewCount( void ) { return 0; }
+        static void resetCounts( void ) {}
+};
+
+#endif // CUEMS_RT_ALLOC_CHECK
+
+#endif // RTALLOCGUARD_H
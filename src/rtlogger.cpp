@@ -0,0 +1,184 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems real-time safe logger source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "rtlogger.h"
+#include "cuemslogger.h"
+#include <climits>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+////////////////////////////////////////////
+RtLogger::RtLogger( Sink sink ) : sink( sink )
+{
+    if ( !this->sink ) {
+        this->sink = []( Level level, const std::string& text ) {
+            switch ( level ) {
+                case LEVEL_INFO:    CuemsLogger::getLogger()->logInfo( text ); break;
+                case LEVEL_WARNING: CuemsLogger::getLogger()->logWarning( text ); break;
+                case LEVEL_ERROR:   CuemsLogger::getLogger()->logError( text ); break;
+            }
+        };
+    }
+
+    wakeEvent = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+    thread = std::thread( &RtLogger::run, this );
+}
+
+////////////////////////////////////////////
+RtLogger::~RtLogger( void )
+{
+    stopping.store( true, std::memory_order_release );
+    signal();
+    thread.join();
+
+    if ( wakeEvent >= 0 ) {
+        ::close( wakeEvent );
+    }
+
+    flush();
+}
+
+////////////////////////////////////////////
+// Audio thread: a copy into a free cell, and a non-blocking eventfd
+// write unless the log thread has been woken already
+////////////////////////////////////////////
+void RtLogger::log( Event event, long long arg )
+{
+    if ( !queue.push( { event, arg } ) ) {
+        // Full, the log thread has a wake pending
+        dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    if ( !signalled.exchange( true, std::memory_order_acq_rel ) ) {
+        signal();
+    }
+}
+
+////////////////////////////////////////////
+void RtLogger::signal( void )
+{
+    if ( wakeEvent >= 0 ) {
+        uint64_t one = 1;
+        if ( write( wakeEvent, &one, sizeof( one ) ) < 0 ) {
+            // Counter full, the log thread is awake anyway
+        }
+    }
+}
+
+////////////////////////////////////////////
+void RtLogger::flush( void )
+{
+    std::lock_guard<std::mutex> lock( writeMutex );
+
+    // The queue has one consumer, whoever holds writeMutex
+    Record record;
+    while ( queue.pop( record ) ) {
+        sink( levelOf( record.event ), format( record.event, record.arg ) );
+    }
+
+    unsigned long long lost = dropped.load( std::memory_order_relaxed );
+    if ( lost != droppedReported ) {
+        sink( LEVEL_WARNING, "Audio thread log: " + std::to_string( lost - droppedReported ) +
+                             " messages dropped, queue full" );
+        droppedReported = lost;
+    }
+}
+
+////////////////////////////////////////////
+unsigned long long RtLogger::getDropped( void ) const
+{
+    return dropped.load( std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+RtLogger::Level RtLogger::levelOf( Event event )
+{
+    switch ( event ) {
+        case MTC_FRAMERATE_INVALID:
+            return LEVEL_WARNING;
+        default:
+            return LEVEL_INFO;
+    }
+}
+
+////////////////////////////////////////////
+std::string RtLogger::format( Event event, long long arg )
+{
+    switch ( event ) {
+        case MTC_PLAY_STARTED:
+            return "MTC -> Play started";
+        case MTC_PLAY_RESUMED:
+            return "MTC -> Play resumed";
+        case MTC_SIGNAL_LOST:
+            return "MTC signal lost";
+        case MTC_FRAMERATE_INVALID:
+            return "MTC frame rate invalid (0), defaulting to " + std::to_string( arg ) + "fps";
+        case OUT_OF_FILE:
+            return "Out of file boundaries!";
+        case END_WAIT:
+            return "Out of file boundaries, waiting " +
+                   ( arg == LONG_MAX ? std::string( "for quit command" ) : std::to_string( arg ) + " ms" );
+        case END_WAIT_EXCEEDED:
+            return "Waiting time exceded, ending audioplayer";
+        default:
+            return "Audio thread event " + std::to_string( (int) event ) + " " + std::to_string( arg );
+    }
+}
+
+////////////////////////////////////////////
+// Log thread: sleeps until signalled, or looks every RTLOGGER_POLL_MS
+// if the eventfd could not be made
+////////////////////////////////////////////
+void RtLogger::run( void )
+{
+    struct pollfd wake = { wakeEvent, POLLIN, 0 };
+    while ( !stopping.load( std::memory_order_acquire ) ) {
+        if ( wakeEvent >= 0 ) {
+            uint64_t count;
+            if ( poll( &wake, 1, -1 ) > 0 && read( wakeEvent, &count, sizeof( count ) ) < 0 ) {
+                // Already drained
+            }
+        } else {
+            poll( nullptr, 0, RTLOGGER_POLL_MS );
+        }
+
+        // Cleared before draining, an event pushed from here on signals again
+        signalled.exchange( false, std::memory_order_acq_rel );
+        flush();
+    }
+}
@@ -0,0 +1,121 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems real-time safe logger header file
+//
+// The audio thread only pushes an event code and a number into a
+// preallocated lock-free queue, never formats, allocates nor waits.
+// A background thread sleeping on an eventfd turns them into text for
+// CuemsLogger; the audio thread signals it with a non-blocking write,
+// once per batch. Events that find the queue full are counted and
+// reported as dropped.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef RTLOGGER_H
+#define RTLOGGER_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef RTLOGGER_QUEUE_SIZE
+#define RTLOGGER_QUEUE_SIZE 256             // Events waiting to be written
+#endif
+
+#ifndef RTLOGGER_POLL_MS
+#define RTLOGGER_POLL_MS 20                 // How often the log thread looks for events without an eventfd
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "commandqueue.h"
+
+class RtLogger
+{
+    public:
+        enum Event : uint16_t {
+            MTC_PLAY_STARTED,
+            MTC_PLAY_RESUMED,
+            MTC_SIGNAL_LOST,
+            MTC_FRAMERATE_INVALID,      // arg: frame rate used instead
+            OUT_OF_FILE,
+            END_WAIT,                   // arg: milliseconds, LONG_MAX for the quit command
+            END_WAIT_EXCEEDED,
+            EVENT_COUNT
+        };
+
+        enum Level { LEVEL_INFO, LEVEL_WARNING, LEVEL_ERROR };
+
+        // Where formatted events go, CuemsLogger unless given
+        typedef std::function<void( Level, const std::string& )> Sink;
+
+        RtLogger( Sink sink = nullptr );
+        ~RtLogger( void );              // Writes what is left
+
+        RtLogger( const RtLogger& ) = delete;
+        RtLogger& operator=( const RtLogger& ) = delete;
+
+        // Audio thread, or any other, wait-free
+        void log( Event event, long long arg = 0 );
+
+        // Any thread: write everything queued so far, now
+        void flush( void );
+
+        unsigned long long getDropped( void ) const;
+
+        static Level levelOf( Event event );
+        static std::string format( Event event, long long arg );
+
+    private:
+        struct Record {
+            Event event;
+            long long arg;
+        };
+
+        void run( void );
+        void signal( void );            // Wakes the log thread
+
+        CommandQueue<Record, RTLOGGER_QUEUE_SIZE> queue;
+        std::atomic<unsigned long long> dropped{0};
+        unsigned long long droppedReported = 0;
+
+        Sink sink;
+        std::mutex writeMutex;          // flush() and the log thread take turns
+        int wakeEvent = -1;             // eventfd the log thread sleeps on
+        std::atomic<bool> signalled{false};     // Wake pending, later events skip the write
+        std::atomic<bool> stopping{false};
+        std::thread thread;
+};
+
+#endif // RTLOGGER_H
@@ -0,0 +1,221 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems sample converter source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "sampleconverter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CONVERTER_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CONVERTER_NEON
+#endif
+
+typedef SampleConverter::Function Function;
+typedef SampleConverter::ChannelCounts ChannelCounts;
+
+////////////////////////////////////////////
+// Planar float kernels: channel planes in, interleaved frames out
+////////////////////////////////////////////
+#ifdef CONVERTER_X86
+__attribute__((target("sse")))
+static void sseStereo( const uint8_t* const* planes, float* out, size_t frames )
+{
+    const float* left = (const float*) planes[0];
+    const float* right = (const float*) planes[1];
+    size_t i = 0;
+    for ( ; i + 4 <= frames; i += 4 ) {
+        __m128 l = _mm_loadu_ps( left + i );
+        __m128 r = _mm_loadu_ps( right + i );
+        _mm_storeu_ps( out + i * 2, _mm_unpacklo_ps( l, r ) );
+        _mm_storeu_ps( out + i * 2 + 4, _mm_unpackhi_ps( l, r ) );
+    }
+    const uint8_t* tail[2] = { (const uint8_t*) ( left + i ), (const uint8_t*) ( right + i ) };
+    SampleConverter::planarLoop<float, 2>( tail, out + i * 2, frames - i );
+}
+
+// unpack works within 128 bit lanes, the halves are swapped back after
+__attribute__((target("avx")))
+static void avxStereo( const uint8_t* const* planes, float* out, size_t frames )
+{
+    const float* left = (const float*) planes[0];
+    const float* right = (const float*) planes[1];
+    size_t i = 0;
+    for ( ; i + 8 <= frames; i += 8 ) {
+        __m256 l = _mm256_loadu_ps( left + i );
+        __m256 r = _mm256_loadu_ps( right + i );
+        __m256 low = _mm256_unpacklo_ps( l, r );     // frames 0 1 | 4 5
+        __m256 high = _mm256_unpackhi_ps( l, r );    // frames 2 3 | 6 7
+        _mm256_storeu_ps( out + i * 2, _mm256_permute2f128_ps( low, high, 0x20 ) );
+        _mm256_storeu_ps( out + i * 2 + 8, _mm256_permute2f128_ps( low, high, 0x31 ) );
+    }
+    const uint8_t* tail[2] = { (const uint8_t*) ( left + i ), (const uint8_t*) ( right + i ) };
+    SampleConverter::planarLoop<float, 2>( tail, out + i * 2, frames - i );
+}
+
+// Four frames at a time, as two 4x4 transposes: channels 0-3 and 4-7
+__attribute__((target("sse")))
+static void sseOctal( const uint8_t* const* planes, float* out, size_t frames )
+{
+    const float* in[8];
+    for ( unsigned int c = 0; c < 8; c++ ) {
+        in[c] = (const float*) planes[c];
+    }
+    size_t i = 0;
+    for ( ; i + 4 <= frames; i += 4 ) {
+        __m128 a0 = _mm_loadu_ps( in[0] + i ), a1 = _mm_loadu_ps( in[1] + i );
+        __m128 a2 = _mm_loadu_ps( in[2] + i ), a3 = _mm_loadu_ps( in[3] + i );
+        __m128 b0 = _mm_loadu_ps( in[4] + i ), b1 = _mm_loadu_ps( in[5] + i );
+        __m128 b2 = _mm_loadu_ps( in[6] + i ), b3 = _mm_loadu_ps( in[7] + i );
+        _MM_TRANSPOSE4_PS( a0, a1, a2, a3 );
+        _MM_TRANSPOSE4_PS( b0, b1, b2, b3 );
+        float* frame = out + i * 8;
+        _mm_storeu_ps( frame, a0 );
+        _mm_storeu_ps( frame + 4, b0 );
+        _mm_storeu_ps( frame + 8, a1 );
+        _mm_storeu_ps( frame + 12, b1 );
+        _mm_storeu_ps( frame + 16, a2 );
+        _mm_storeu_ps( frame + 20, b2 );
+        _mm_storeu_ps( frame + 24, a3 );
+        _mm_storeu_ps( frame + 28, b3 );
+    }
+    const uint8_t* tail[8];
+    for ( unsigned int c = 0; c < 8; c++ ) {
+        tail[c] = (const uint8_t*) ( in[c] + i );
+    }
+    SampleConverter::planarLoop<float, 8>( tail, out + i * 8, frames - i );
+}
+#endif
+
+#ifdef CONVERTER_NEON
+static void neonStereo( const uint8_t* const* planes, float* out, size_t frames )
+{
+    const float* left = (const float*) planes[0];
+    const float* right = (const float*) planes[1];
+    size_t i = 0;
+    for ( ; i + 4 <= frames; i += 4 ) {
+        float32x4x2_t frame = { { vld1q_f32( left + i ), vld1q_f32( right + i ) } };
+        vst2q_f32( out + i * 2, frame );
+    }
+    const uint8_t* tail[2] = { (const uint8_t*) ( left + i ), (const uint8_t*) ( right + i ) };
+    SampleConverter::planarLoop<float, 2>( tail, out + i * 2, frames - i );
+}
+#endif
+
+////////////////////////////////////////////
+// Picked once, on first use
+////////////////////////////////////////////
+struct KernelChoice {
+    Function stereo;
+    Function octal;
+    const char* name;
+};
+
+static KernelChoice chooseKernels( void )
+{
+#if defined(CONVERTER_X86)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx" ) ) {
+        return { avxStereo, sseOctal, "avx" };
+    }
+    if ( __builtin_cpu_supports( "sse" ) ) {
+        return { sseStereo, sseOctal, "sse" };
+    }
+#elif defined(CONVERTER_NEON)
+    return { neonStereo, SampleConverter::planarLoop<float, 8>, "neon" };
+#endif
+    return { SampleConverter::planarLoop<float, 2>, SampleConverter::planarLoop<float, 8>, "scalar" };
+}
+
+static const KernelChoice& kernelChoice( void )
+{
+    static const KernelChoice choice = chooseKernels();
+    return choice;
+}
+
+template <>
+void SampleConverter::planar<float, 2>( const uint8_t* const* planes, float* out, size_t frames )
+{
+    kernelChoice().stereo( planes, out, frames );
+}
+
+template <>
+void SampleConverter::planar<float, 8>( const uint8_t* const* planes, float* out, size_t frames )
+{
+    kernelChoice().octal( planes, out, frames );
+}
+
+////////////////////////////////////////////
+// The table, [format][channel count index], built at compile time
+////////////////////////////////////////////
+template <typename Sample, bool Planar, unsigned int... Counts>
+static constexpr std::array<Function, sizeof...( Counts )> row( SampleConverter::ChannelSet<Counts...> )
+{
+    return { { ( Planar ? &SampleConverter::planar<Sample, Counts> : &SampleConverter::packed<Sample, Counts> )... } };
+}
+
+static constexpr std::array<std::array<Function, ChannelCounts::size>, SampleConverter::FORMAT_COUNT> converters{ {
+    row<int16_t, false>( ChannelCounts() ),
+    row<int32_t, false>( ChannelCounts() ),
+    row<float, false>( ChannelCounts() ),
+    row<double, false>( ChannelCounts() ),
+    row<int16_t, true>( ChannelCounts() ),
+    row<int32_t, true>( ChannelCounts() ),
+    row<float, true>( ChannelCounts() ),
+    row<double, true>( ChannelCounts() )
+} };
+
+static_assert( converters[SampleConverter::FLTP][1] == &SampleConverter::planar<float, 2>,
+               "Converter table rows follow Format, columns ChannelCounts" );
+
+////////////////////////////////////////////
+Function SampleConverter::find( Format format, unsigned int channels )
+{
+    if ( format < 0 || format >= FORMAT_COUNT ) {
+        return nullptr;
+    }
+
+    for ( size_t i = 0; i < ChannelCounts::size; i++ ) {
+        if ( ChannelCounts::counts[i] == channels ) {
+            return converters[format][i];
+        }
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////
+const char* SampleConverter::getKernelName( void )
+{
+    return kernelChoice().name;
+}
@@ -0,0 +1,114 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems sample converter header file
+//
+// Decoded samples to interleaved float without a swresample context,
+// for the formats and channel counts decoders give most of the time.
+// One function per source format, channel count and interleaving,
+// generated from templates into a constexpr table, so each has its
+// sample type, scale and channel loop fixed at compile time. Planar
+// float (AAC, Opus, MP3) in stereo and 8 channels, the hottest case,
+// is interleaved by vectorised kernels (AVX, SSE or NEON) chosen once
+// at run time. Anything else is left to libswresample.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef SAMPLECONVERTER_H
+#define SAMPLECONVERTER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class SampleConverter
+{
+    public:
+        // Same order as FFmpeg's packed and planar sample formats
+        enum Format { S16, S32, FLT, DBL, S16P, S32P, FLTP, DBLP, FORMAT_COUNT };
+
+        // planes as in AVFrame::extended_data: one for packed formats,
+        // one per channel for planar ones
+        typedef void (*Function)( const uint8_t* const* planes, float* out, size_t frames );
+
+        // nullptr when there is no specialised converter
+        static Function find( Format format, unsigned int channels );
+
+        static const char* getKernelName( void );  // "avx", "sse", "neon" or "scalar"
+
+        // Channel counts with converters of their own
+        template <unsigned int... Counts>
+        struct ChannelSet {
+            static constexpr size_t size = sizeof...( Counts );
+            static constexpr std::array<unsigned int, size> counts{ { Counts... } };
+        };
+        typedef ChannelSet<1, 2, 6, 8> ChannelCounts;
+
+        // Full scale of each sample type
+        template <typename Sample> struct Scale;
+
+        //////////////////////////////////////////
+        // The converters. planarLoop is also the tail of the vector kernels.
+        template <typename Sample, unsigned int Channels>
+        static void packed( const uint8_t* const* planes, float* out, size_t frames ) {
+            const Sample* in = (const Sample*) planes[0];
+            for ( size_t i = 0; i < frames * Channels; i++ ) {
+                out[i] = (float) in[i] * Scale<Sample>::value;
+            }
+        }
+
+        template <typename Sample, unsigned int Channels>
+        static void planarLoop( const uint8_t* const* planes, float* out, size_t frames ) {
+            const Sample* in[Channels];
+            for ( unsigned int c = 0; c < Channels; c++ ) {
+                in[c] = (const Sample*) planes[c];
+            }
+            for ( size_t f = 0; f < frames; f++, out += Channels ) {
+                for ( unsigned int c = 0; c < Channels; c++ ) {
+                    out[c] = (float) in[c][f] * Scale<Sample>::value;
+                }
+            }
+        }
+
+        // Specialised in the source file for stereo and 8 channel float
+        template <typename Sample, unsigned int Channels>
+        static void planar( const uint8_t* const* planes, float* out, size_t frames ) {
+            planarLoop<Sample, Channels>( planes, out, frames );
+        }
+};
+
+template <> struct SampleConverter::Scale<int16_t> { static constexpr float value = 1.0f / 32768.0f; };
+template <> struct SampleConverter::Scale<int32_t> { static constexpr float value = 1.0f / 2147483648.0f; };
+template <> struct SampleConverter::Scale<float> { static constexpr float value = 1.0f; };
+template <> struct SampleConverter::Scale<double> { static constexpr float value = 1.0f; };
+
+template <> void SampleConverter::planar<float, 2>( const uint8_t* const* planes, float* out, size_t frames );
+template <> void SampleConverter::planar<float, 8>( const uint8_t* const* planes, float* out, size_t frames );
+
+#endif // SAMPLECONVERTER_H
@@ -0,0 +1,298 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems shared decoded PCM source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "sharedpcm.h"
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static_assert( sizeof(std::atomic<uint64_t>) == 8 && std::atomic<uint64_t>::is_always_lock_free,
+               "Shared PCM header needs address free atomics" );
+
+static const char sharedPcmMagic[8] = { 'C', 'U', 'E', 'M', 'S', 'S', 'H', 'M' };
+
+////////////////////////////////////////////
+SharedPcm::~SharedPcm( void )
+{
+    detach();
+}
+
+////////////////////////////////////////////
+string SharedPcm::nameFor( const string& key )
+{
+    return "/cuems-pcm-" + key;
+}
+
+////////////////////////////////////////////
+// Join or create the segment
+////////////////////////////////////////////
+SharedPcm::Role SharedPcm::attach(  const string& key, unsigned int channels, unsigned int sampleRate,
+                                    size_t expectedFloats )
+{
+    static_assert( sizeof(Header) == SHARED_PCM_HEADER_SIZE, "Shared PCM header size" );
+
+    detach();
+
+    name = nameFor( key );
+    nChannels = channels;
+    rate = sampleRate;
+
+    fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644 );
+    if ( fd >= 0 ) {
+        flock( fd, LOCK_SH );
+
+        role = PRODUCER;
+        if ( !reserve( std::max( expectedFloats, (size_t) channels ) ) ) {
+            detach();
+            return NONE;
+        }
+
+        Header* h = header();
+        memcpy( h->magic, sharedPcmMagic, 8 );
+        h->version = SHARED_PCM_VERSION;
+        h->channels = channels;
+        h->sampleRate = sampleRate;
+        h->frames.store( 0, std::memory_order_relaxed );
+        h->ownerPid.store( getpid(), std::memory_order_relaxed );
+        h->state.store( RENDERING, std::memory_order_release );
+        return role;
+    }
+
+    if ( errno != EEXIST ) {
+        return NONE;
+    }
+
+    fd = shm_open( name.c_str(), O_RDONLY | O_CLOEXEC, 0 );
+    if ( fd < 0 ) {
+        return NONE;
+    }
+
+    // Shared lock: while we hold it nobody unlinks the segment
+    flock( fd, LOCK_SH );
+    role = CONSUMER;
+    return role;
+}
+
+////////////////////////////////////////////
+// Producer: make room for floats samples after the header
+////////////////////////////////////////////
+bool SharedPcm::reserve( size_t floats )
+{
+    if ( floats <= capacity ) {
+        return true;
+    }
+
+    size_t newCapacity = std::max( floats, capacity * 2 );
+    size_t newLength = SHARED_PCM_HEADER_SIZE + newCapacity * sizeof(float);
+
+    // Allocate the pages now: a full /dev/shm is an error here instead
+    // of a SIGBUS when writing later
+    if ( ftruncate( fd, newLength ) != 0 || posix_fallocate( fd, 0, newLength ) != 0 ) {
+        return false;
+    }
+
+    void* map = ( base == nullptr ) ?
+        mmap( nullptr, newLength, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) :
+        mremap( base, length, newLength, MREMAP_MAYMOVE );
+
+    if ( map == MAP_FAILED ) {
+        return false;
+    }
+
+    base = map;
+    length = newLength;
+    capacity = newCapacity;
+    return true;
+}
+
+////////////////////////////////////////////
+bool SharedPcm::write( const float* samples, size_t floats )
+{
+    if ( role != PRODUCER || !reserve( nFloats + floats ) ) {
+        return false;
+    }
+
+    memcpy( (char*) base + SHARED_PCM_HEADER_SIZE + nFloats * sizeof(float), samples, floats * sizeof(float) );
+    nFloats += floats;
+    return true;
+}
+
+////////////////////////////////////////////
+bool SharedPcm::publish( void )
+{
+    if ( role != PRODUCER || base == nullptr ) {
+        return false;
+    }
+
+    // Whole frames only
+    nFloats -= nFloats % nChannels;
+
+    header()->frames.store( nFloats / nChannels, std::memory_order_relaxed );
+    header()->state.store( READY, std::memory_order_release );
+    return true;
+}
+
+////////////////////////////////////////////
+// Is whoever renders the segment still there?
+////////////////////////////////////////////
+bool SharedPcm::producerAlive( void ) const
+{
+    pid_t pid = header()->ownerPid.load( std::memory_order_relaxed );
+    return pid > 0 && ( kill( pid, 0 ) == 0 || errno == EPERM );
+}
+
+////////////////////////////////////////////
+// Consumer: wait for the producer and map what it rendered
+////////////////////////////////////////////
+bool SharedPcm::waitReady( const std::atomic<bool>& cancel )
+{
+    if ( role != CONSUMER ) {
+        return role == PRODUCER && header()->state.load() == READY;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // The creator may not have sized the segment yet
+    struct stat info;
+    while ( fstat( fd, &info ) == 0 && info.st_size < SHARED_PCM_HEADER_SIZE ) {
+        if ( cancel.load() ||
+             std::chrono::steady_clock::now() - start > std::chrono::milliseconds( SHARED_PCM_CLAIM_TIMEOUT_MS ) ) {
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( SHARED_PCM_POLL_MS ) );
+    }
+
+    base = mmap( nullptr, SHARED_PCM_HEADER_SIZE, PROT_READ, MAP_SHARED, fd, 0 );
+    if ( base == MAP_FAILED ) {
+        base = nullptr;
+        return false;
+    }
+    length = SHARED_PCM_HEADER_SIZE;
+
+    while ( true ) {
+        uint32_t state = header()->state.load( std::memory_order_acquire );
+
+        if ( state == READY ) {
+            break;
+        }
+        if ( state == FAILED || cancel.load() ) {
+            return false;
+        }
+        if ( state == RENDERING && !producerAlive() ) {
+            // Producer died: out of the way so the next player renders again
+            shm_unlink( name.c_str() );
+            return false;
+        }
+        if ( state == EMPTY &&
+             std::chrono::steady_clock::now() - start > std::chrono::milliseconds( SHARED_PCM_CLAIM_TIMEOUT_MS ) ) {
+            shm_unlink( name.c_str() );
+            return false;
+        }
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( SHARED_PCM_POLL_MS ) );
+    }
+
+    Header* h = header();
+    if ( memcmp( h->magic, sharedPcmMagic, 8 ) != 0 || h->version != SHARED_PCM_VERSION ||
+         h->channels != nChannels || h->sampleRate != rate ) {
+        return false;
+    }
+
+    size_t readyFloats = h->frames.load( std::memory_order_relaxed ) * nChannels;
+    size_t readyLength = SHARED_PCM_HEADER_SIZE + readyFloats * sizeof(float);
+
+    munmap( base, length );
+    base = mmap( nullptr, readyLength, PROT_READ, MAP_SHARED, fd, 0 );
+    if ( base == MAP_FAILED ) {
+        base = nullptr;
+        length = 0;
+        return false;
+    }
+
+    length = readyLength;
+    nFloats = readyFloats;
+    return true;
+}
+
+////////////////////////////////////////////
+const float* SharedPcm::data( void ) const
+{
+    return base != nullptr ? (const float*)( (const char*) base + SHARED_PCM_HEADER_SIZE ) : nullptr;
+}
+
+////////////////////////////////////////////
+// Leave the segment, unlinking it if we are the last user
+////////////////////////////////////////////
+void SharedPcm::detach( void )
+{
+    if ( fd < 0 ) {
+        return;
+    }
+
+    bool ready = base != nullptr && header()->state.load( std::memory_order_acquire ) == READY;
+
+    if ( role == PRODUCER && !ready ) {
+        // Unfinished, consumers give up and the name is free again
+        if ( base != nullptr ) {
+            header()->state.store( FAILED, std::memory_order_release );
+        }
+        shm_unlink( name.c_str() );
+    }
+
+    if ( base != nullptr ) {
+        munmap( base, length );
+    }
+
+    if ( ready && flock( fd, LOCK_EX | LOCK_NB ) == 0 ) {
+        shm_unlink( name.c_str() );
+    }
+
+    ::close( fd );
+
+    fd = -1;
+    role = NONE;
+    base = nullptr;
+    length = 0;
+    capacity = 0;
+    nFloats = 0;
+}
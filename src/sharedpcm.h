@@ -0,0 +1,129 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems shared decoded PCM header file
+//
+// One POSIX shared memory segment per rendition (same key as the
+// PCM cache), so the player processes of a node decode a file once
+// and all map the same pages. The segment name is the directory:
+// whoever creates it renders into it, everyone else waits on the
+// lock-free header for it to be ready and maps it read-only.
+//
+// Every attached process holds a shared flock on the segment, the
+// last one to detach (exclusive lock granted) unlinks it.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef SHAREDPCM_H
+#define SHAREDPCM_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#define SHARED_PCM_VERSION 1
+#define SHARED_PCM_HEADER_SIZE 64
+
+#ifndef SHARED_PCM_CLAIM_TIMEOUT_MS
+#define SHARED_PCM_CLAIM_TIMEOUT_MS 2000    // Creator that never set the segment up is gone
+#endif
+
+#ifndef SHARED_PCM_POLL_MS
+#define SHARED_PCM_POLL_MS 10               // Consumer polling while the producer renders
+#endif
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+class SharedPcm
+{
+    public:
+        enum Role { NONE, PRODUCER, CONSUMER };
+
+        SharedPcm( void ) {}
+        ~SharedPcm( void );
+
+        SharedPcm( const SharedPcm& ) = delete;
+        SharedPcm& operator=( const SharedPcm& ) = delete;
+
+        static string nameFor( const string& key );
+
+        // Joins the segment of key, creating it if nobody has: the
+        // PRODUCER must render the file, a CONSUMER waits for it
+        Role attach( const string& key, unsigned int channels, unsigned int sampleRate,
+                     size_t expectedFloats );
+        void detach( void );
+        Role getRole( void ) const { return role; }
+
+        // Producer
+        bool write( const float* samples, size_t floats );
+        bool publish( void );
+
+        // Consumer: blocks until ready, the producer failed or cancel is set
+        bool waitReady( const std::atomic<bool>& cancel );
+
+        // Both, once published / ready
+        const float* data( void ) const;
+        size_t floats( void ) const { return nFloats; }
+
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t channels;
+            uint32_t sampleRate;
+            std::atomic<uint32_t> state;
+            std::atomic<int32_t> ownerPid;
+            uint32_t reserved;
+            std::atomic<uint64_t> frames;
+            uint8_t padding[24];
+        };
+
+        enum State : uint32_t { EMPTY = 0, RENDERING, READY, FAILED };
+
+        string name;
+        int fd = -1;
+        Role role = NONE;
+        unsigned int nChannels = 0;
+        unsigned int rate = 0;
+
+        void* base = nullptr;
+        size_t length = 0;
+        size_t capacity = 0;            // Producer, floats the segment can hold
+        size_t nFloats = 0;
+
+        Header* header( void ) const { return (Header*) base; }
+        bool reserve( size_t floats );
+        bool producerAlive( void ) const;
+};
+
+#endif // SHAREDPCM_H
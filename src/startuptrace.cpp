@@ -0,0 +1,138 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems startup trace source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "startuptrace.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <time.h>
+#include <unistd.h>
+
+////////////////////////////////////////////
+StartupTrace::StartupTrace( void )
+{
+    originMs = spawnTimeMs();
+
+    // No /proc, phases count from here instead
+    if ( originMs <= 0 || originMs > nowMs() ) {
+        originMs = nowMs();
+    }
+}
+
+////////////////////////////////////////////
+void StartupTrace::mark( const std::string& name )
+{
+    double ms = nowMs() - originMs;
+
+    std::lock_guard<std::mutex> lock( mutex );
+    marks.push_back( { name, ms } );
+}
+
+////////////////////////////////////////////
+std::vector<StartupTrace::Phase> StartupTrace::phases( void ) const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return marks;
+}
+
+////////////////////////////////////////////
+double StartupTrace::totalMs( void ) const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return marks.empty() ? 0.0 : marks.back().ms;
+}
+
+////////////////////////////////////////////
+// First phase from spawn, the others as the time each one took
+////////////////////////////////////////////
+std::string StartupTrace::summary( void ) const
+{
+    std::vector<Phase> list = phases();
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << "Startup:";
+
+    double last = 0.0;
+    for ( size_t i = 0; i < list.size(); i++ ) {
+        out << ( i == 0 ? " " : ", " ) << list[i].name << ( i == 0 ? " " : " +" ) << list[i].ms - last;
+        last = list[i].ms;
+    }
+    out << " ms, " << last << " ms from spawn";
+
+    return out.str();
+}
+
+////////////////////////////////////////////
+// Field 22 of /proc/self/stat, in clock ticks since boot. The command
+// name before it may hold spaces, fields are counted from its ')'.
+////////////////////////////////////////////
+double StartupTrace::spawnTimeMs( void )
+{
+    std::ifstream stat( "/proc/self/stat" );
+    std::string line;
+    if ( !std::getline( stat, line ) ) {
+        return 0.0;
+    }
+
+    size_t end = line.rfind( ')' );
+    if ( end == std::string::npos ) {
+        return 0.0;
+    }
+
+    std::istringstream fields( line.substr( end + 1 ) );
+    std::string field;
+    for ( int i = 3; i < 22; i++ ) {
+        fields >> field;
+    }
+
+    unsigned long long ticks = 0;
+    if ( !( fields >> ticks ) ) {
+        return 0.0;
+    }
+
+    return ticks * 1000.0 / sysconf( _SC_CLK_TCK );
+}
+
+////////////////////////////////////////////
+// Same clock as the spawn time: since boot, suspend included
+////////////////////////////////////////////
+double StartupTrace::nowMs( void )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_BOOTTIME, &now );
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
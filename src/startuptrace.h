@@ -0,0 +1,76 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems startup trace header file
+//
+// Time from process spawn to each phase of the player start, so the
+// cost of getting a just-in-time player to RUNNING can be seen phase
+// by phase. Spawn time comes from /proc and has clock tick resolution
+// (usually 10 ms), the phases after it are exact. Marked from the
+// main thread, read from any.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+class StartupTrace
+{
+    public:
+        struct Phase {
+            std::string name;
+            double ms;                      // Since process spawn
+        };
+
+        StartupTrace( void );
+
+        void mark( const std::string& name );
+        std::vector<Phase> phases( void ) const;
+        double totalMs( void ) const;       // Up to the last mark, 0 before any
+
+        // "members 41.2, devices +12.5, ..." for the log
+        std::string summary( void ) const;
+
+        // Milliseconds on the boot clock, at spawn of this process or now
+        static double spawnTimeMs( void );
+        static double nowMs( void );
+
+    private:
+        double originMs;
+        mutable std::mutex mutex;
+        std::vector<Phase> marks;
+};
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,218 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems player voice source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "voice.h"
+#include <cstring>
+
+////////////////////////////////////////////
+Voice::Voice( void ) : streamer( audioFile )
+{
+}
+
+////////////////////////////////////////////
+Voice::~Voice( void )
+{
+    unload();
+    delete[] scratch;
+}
+
+////////////////////////////////////////////
+// Take the voice away from the audio thread. mix() raises its flag
+// before looking at the state again, so once we see it down with the
+// state already changed it will not come back until we allow it.
+////////////////////////////////////////////
+void Voice::release( void )
+{
+    state.store( VOICE_EMPTY );
+
+    while ( mixing.load() ) {
+        std::this_thread::yield();
+    }
+}
+
+////////////////////////////////////////////
+bool Voice::load(   const string& path, unsigned int channels, unsigned int sampleRate,
+                    unsigned int maxFrames, bool streaming )
+{
+    release();
+
+    streamer.rewind();
+    audioFile.close();
+
+    if ( channels == 0 || sampleRate == 0 || maxFrames == 0 ) {
+        return false;
+    }
+
+    audioFile.setTargetChannels( channels );
+    audioFile.setTargetSampleRate( sampleRate );
+    audioFile.open( path, ios::binary | ios::in );
+
+    if ( !audioFile.good() ) {
+        CuemsLogger::getLogger()->logError( "Voice: could not open " + path );
+        audioFile.close();
+        return false;
+    }
+
+    // Only ever grows, the audio thread sees it after the state store
+    if ( scratchFloats < (size_t) maxFrames * channels ) {
+        delete[] scratch;
+        scratchFloats = (size_t) maxFrames * channels;
+        scratch = new float[scratchFloats];
+    }
+    frameSize = channels * sizeof(float);
+    position = 0;
+
+    streamingMode = streaming && !audioFile.isPreloaded() &&
+                    streamer.start( maxFrames, channels, sampleRate );
+
+    state.store( VOICE_STOPPED, std::memory_order_release );
+    return true;
+}
+
+////////////////////////////////////////////
+void Voice::unload( void )
+{
+    release();
+
+    streamer.rewind();
+    audioFile.close();
+}
+
+////////////////////////////////////////////
+bool Voice::play( void )
+{
+    int stopped = VOICE_STOPPED;
+    return state.compare_exchange_strong( stopped, VOICE_PLAYING ) || stopped == VOICE_PLAYING;
+}
+
+////////////////////////////////////////////
+void Voice::stop( void )
+{
+    int playing = VOICE_PLAYING;
+    state.compare_exchange_strong( playing, VOICE_STOPPED );
+}
+
+////////////////////////////////////////////
+void Voice::setOffset( long long frames )
+{
+    offset.store( frames, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void Voice::setVolume( float gain )
+{
+    volume.store( gain, std::memory_order_relaxed );
+}
+
+////////////////////////////////////////////
+void Voice::setDecoderPool( DecoderPool* pool )
+{
+    streamer.setPool( pool );
+}
+
+////////////////////////////////////////////
+bool Voice::isLoaded( void ) const
+{
+    return state.load( std::memory_order_acquire ) != VOICE_EMPTY;
+}
+
+////////////////////////////////////////////
+bool Voice::isPlaying( void ) const
+{
+    return state.load( std::memory_order_acquire ) == VOICE_PLAYING;
+}
+
+////////////////////////////////////////////
+// Audio thread
+////////////////////////////////////////////
+unsigned long Voice::mix(   float* out, unsigned int frames, bool timelineKnown,
+                            long long timelineFrame, long long toleranceFrames )
+{
+    if ( state.load( std::memory_order_acquire ) != VOICE_PLAYING ) {
+        return 0;
+    }
+
+    mixing.store( true );
+    if ( state.load() != VOICE_PLAYING ) {
+        mixing.store( false, std::memory_order_release );
+        return 0;
+    }
+
+    unsigned long count = 0;
+    bool audible = true;
+
+    if ( timelineKnown ) {
+        long long target = ( timelineFrame + offset.load( std::memory_order_relaxed ) ) * frameSize;
+        long long tolerance = toleranceFrames * frameSize;
+
+        // Not started yet or already over at this point of the timeline
+        if ( target < 0 || target >= (long long) audioFile.getFileSize() ) {
+            audible = false;
+        }
+        else if ( llabs( position - target ) > tolerance ) {
+            if ( streamingMode ) {
+                streamer.seekg( target, ios_base::beg );
+            }
+            else {
+                audioFile.clear();
+                audioFile.seekg( target, ios_base::beg );
+            }
+            position = target;
+        }
+    }
+
+    if ( audible ) {
+        size_t bytes = std::min( (size_t) frames * frameSize, scratchFloats * sizeof(float) );
+
+        if ( streamingMode ) {
+            streamer.read( (char*) scratch, bytes );
+            count = streamer.gcount();
+        }
+        else {
+            audioFile.read( (char*) scratch, bytes );
+            count = audioFile.gcount();
+        }
+
+        float gain = volume.load( std::memory_order_relaxed );
+        for ( size_t i = 0; i < count / sizeof(float); i++ ) {
+            out[i] += scratch[i] * gain;
+        }
+
+        position += count;
+    }
+
+    mixing.store( false, std::memory_order_release );
+    return count;
+}
@@ -0,0 +1,109 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems player voice header file
+//
+// One more file played by the same player process and mixed into its
+// output: own decoder, offset, gain and play state, following the
+// player's MTC timeline. Controlled from the OSC thread, mixed from the
+// audio thread. The controller stops the voice and waits for the audio
+// thread to let go of it before touching the file.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef VOICE_H
+#define VOICE_H
+
+//////////////////////////////////////////////////////////
+// Preprocessor definitions
+#ifndef MAX_VOICES
+#define MAX_VOICES 64                       // Voices one player process can host
+#endif
+
+#include <atomic>
+#include <string>
+#include "audiofstream.h"
+#include "audiostreamer.h"
+
+using namespace std;
+
+class Voice
+{
+    public:
+        Voice( void );
+        ~Voice( void );
+
+        // Control side. Output format is the player's, maxFrames is the
+        // largest period the audio thread will ask for. Streaming decodes
+        // on a thread of its own unless the file ends up in memory.
+        bool load(  const string& path, unsigned int channels, unsigned int sampleRate,
+                    unsigned int maxFrames, bool streaming = false );
+        void unload( void );
+        bool play( void );
+        void stop( void );
+        void setOffset( long long frames );     // File position = timeline + offset
+        void setVolume( float gain );
+        void setDecoderPool( DecoderPool* pool );   // Streaming voices decode in the pool
+        bool isLoaded( void ) const;
+        bool isPlaying( void ) const;
+
+        // Audio thread: adds one period of the voice to out. With a
+        // timeline (MTC head plus output latency, in frames) the voice
+        // relocates to timeline + offset when it drifts further than
+        // tolerance (frames too), else it plays on from where it is.
+        // Frames, not bytes: the voice's channel count may not be the
+        // main file's. Returns the bytes mixed.
+        unsigned long mix(  float* out, unsigned int frames, bool timelineKnown,
+                            long long timelineFrame, long long toleranceFrames );
+
+        // Decoding options (quality, cache, preload) are set here before load
+        AudioFstream audioFile;
+
+    private:
+        enum State { VOICE_EMPTY, VOICE_STOPPED, VOICE_PLAYING };
+
+        AudioStreamer streamer;
+        std::atomic<int> state{VOICE_EMPTY};
+        std::atomic<bool> mixing{false};        // Audio thread inside mix()
+        std::atomic<long long> offset{0};       // In frames
+        std::atomic<float> volume{1.0f};
+
+        // Set while stopped, then read by the audio thread
+        bool streamingMode = false;
+        unsigned int frameSize = 0;             // Bytes per output frame
+        float* scratch = nullptr;
+        size_t scratchFloats = 0;
+
+        long long position = 0;                 // Audio thread, file position in bytes
+
+        void release( void );                   // Stop and wait for the audio thread
+};
+
+#endif // VOICE_H
@@ -0,0 +1,170 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems WAV file writer source file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "wavwriter.h"
+#include <cstdint>
+
+////////////////////////////////////////////
+// Little endian field helpers
+////////////////////////////////////////////
+static void put16( ofstream& out, uint16_t value )
+{
+    char bytes[2] = { (char)( value & 0xFF ), (char)( value >> 8 ) };
+    out.write( bytes, 2 );
+}
+
+static void put32( ofstream& out, uint32_t value )
+{
+    char bytes[4] = {   (char)( value & 0xFF ), (char)( ( value >> 8 ) & 0xFF ),
+                        (char)( ( value >> 16 ) & 0xFF ), (char)( value >> 24 ) };
+    out.write( bytes, 4 );
+}
+
+////////////////////////////////////////////
+WavWriter::WavWriter( void )
+{
+}
+
+////////////////////////////////////////////
+WavWriter::~WavWriter( void )
+{
+    close();
+}
+
+////////////////////////////////////////////
+// Create the file, sizes are filled in on close
+////////////////////////////////////////////
+bool WavWriter::open( const string& path, unsigned int channels, unsigned int sampleRate )
+{
+    close();
+
+    if ( channels == 0 || sampleRate == 0 ) {
+        return false;
+    }
+
+    file.open( path, ios_base::out | ios_base::binary | ios_base::trunc );
+    if ( !file.is_open() ) {
+        return false;
+    }
+
+    nChannels = channels;
+    framesWritten = 0;
+
+    uint16_t blockAlign = nChannels * sizeof(float);
+
+    // RIFF header, sizes patched on close
+    file.write( "RIFF", 4 );
+    put32( file, 0 );
+    file.write( "WAVE", 4 );
+
+    // Format chunk: WAVE_FORMAT_IEEE_FLOAT
+    file.write( "fmt ", 4 );
+    put32( file, 18 );
+    put16( file, 3 );
+    put16( file, nChannels );
+    put32( file, sampleRate );
+    put32( file, sampleRate * blockAlign );
+    put16( file, blockAlign );
+    put16( file, 32 );
+    put16( file, 0 );
+
+    // Non PCM formats carry a fact chunk with the frame count
+    file.write( "fact", 4 );
+    put32( file, 4 );
+    put32( file, 0 );
+
+    file.write( "data", 4 );
+    put32( file, 0 );
+
+    return file.good();
+}
+
+////////////////////////////////////////////
+// Append interleaved float frames
+////////////////////////////////////////////
+bool WavWriter::write( const float* samples, unsigned long frames )
+{
+    if ( !file.is_open() ) {
+        return false;
+    }
+
+    // Host and WAV byte order are both little endian on our targets
+    file.write( (const char*) samples, (streamsize) frames * nChannels * sizeof(float) );
+    framesWritten += frames;
+
+    return file.good();
+}
+
+////////////////////////////////////////////
+// Patch the sizes and close
+////////////////////////////////////////////
+void WavWriter::close( void )
+{
+    if ( !file.is_open() ) {
+        return;
+    }
+
+    writeHeader();
+    file.close();
+}
+
+////////////////////////////////////////////
+void WavWriter::writeHeader( void )
+{
+    // 4GB is the RIFF limit, longer renders keep a truncated size
+    uint64_t dataBytes = framesWritten * nChannels * sizeof(float);
+    uint32_t dataSize = dataBytes > 0xFFFFFFF0ull ? 0xFFFFFFF0u : (uint32_t) dataBytes;
+
+    file.seekp( 4 );
+    put32( file, 4 + ( 8 + 18 ) + ( 8 + 4 ) + ( 8 + dataSize ) );
+
+    file.seekp( 12 + 8 + 18 + 8 );
+    put32( file, (uint32_t) framesWritten );
+
+    file.seekp( 12 + 8 + 18 + 12 + 4 );
+    put32( file, dataSize );
+}
+
+////////////////////////////////////////////
+bool WavWriter::isOpen( void ) const
+{
+    return file.is_open();
+}
+
+////////////////////////////////////////////
+unsigned long long WavWriter::getFramesWritten( void ) const
+{
+    return framesWritten;
+}
@@ -0,0 +1,67 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab Coop.
+
+    Authors:
+        Alex Ramos <alex@stagelab.coop>
+        Ion Reguera <ion@stagelab.coop>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems WAV file writer header file
+//
+// Writes interleaved 32-bit float audio, as the callback produces it,
+// to an IEEE float WAV file. Used by the offline render mode.
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+class WavWriter
+{
+    public:
+        WavWriter( void );
+        ~WavWriter( void );
+
+        bool open( const string& path, unsigned int channels, unsigned int sampleRate );
+        bool write( const float* samples, unsigned long frames );
+        void close( void );             // Patches the header sizes
+
+        bool isOpen( void ) const;
+        unsigned long long getFramesWritten( void ) const;
+
+    private:
+        ofstream file;
+        unsigned int nChannels = 0;
+        unsigned long long framesWritten = 0;
+
+        void writeHeader( void );
+};
+
+#endif // WAVWRITER_H
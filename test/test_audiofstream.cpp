@@ -24,7 +24,14 @@
 #include <fstream>
 #include <filesystem>
 #include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 #include "audiofstream.h"
+#include "testwav.h"
 
 namespace fs = std::filesystem;
 
@@ -332,3 +339,451 @@ TEST_F(AudioFstreamTest, SeekgVariousPositions) {
     // Should not crash
 }
 
+// Test a seek lands on the exact requested frame, through the native
+// reader and through FFmpeg's decode and discard
+TEST_F(AudioFstreamTest, SeekgSampleAccurate) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    for (bool native : {true, false}) {
+        SCOPED_TRACE(native ? "native PCM" : "FFmpeg");
+        AudioFstream stream;
+        stream.setNativePcm(native);
+        stream.open(rampFile.string(), std::ios::binary | std::ios::in);
+        ASSERT_TRUE(stream.good());
+
+        const long long frames[] = {12345, 1, 4097, 0, 19000};
+        for (long long frame : frames) {
+            stream.seekg(frame * 2 * sizeof(float), std::ios_base::beg);
+
+            float buffer[2];
+            stream.read((char*) buffer, sizeof(buffer));
+            ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+            EXPECT_EQ((long long) std::lround(buffer[0] * 32768.0f), frame);
+            EXPECT_EQ((long long) std::lround(buffer[1] * 32768.0f), frame);
+        }
+    }
+
+    fs::remove(rampFile);
+}
+
+// Test a seek while resampling gives the same audio as playing through
+TEST_F(AudioFstreamTest, SeekgResampledMatchesContinuousRead) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    const size_t target = 9000;     // Output frames at 48 kHz
+    const size_t count = 256;
+
+    for (bool native : {true, false}) {
+        SCOPED_TRACE(native ? "native PCM" : "FFmpeg");
+
+        std::vector<float> continuous((target + count) * 2);
+        {
+            AudioFstream stream;
+            stream.setNativePcm(native);
+            stream.open(rampFile.string(), std::ios::binary | std::ios::in);
+            stream.setTargetSampleRate(48000);
+            size_t done = 0;
+            while (done < continuous.size()) {
+                size_t chunk = std::min((size_t) 1024, continuous.size() - done);
+                stream.read((char*) (continuous.data() + done), chunk * sizeof(float));
+                ASSERT_GT(stream.gcount(), 0);
+                done += stream.gcount() / sizeof(float);
+            }
+        }
+
+        AudioFstream stream;
+        stream.setNativePcm(native);
+        stream.open(rampFile.string(), std::ios::binary | std::ios::in);
+        stream.setTargetSampleRate(48000);
+        stream.seekg(target * 2 * sizeof(float), std::ios_base::beg);
+
+        std::vector<float> seeked(count * 2);
+        stream.read((char*) seeked.data(), seeked.size() * sizeof(float));
+        ASSERT_EQ(stream.gcount(), (streamsize) (seeked.size() * sizeof(float)));
+
+        for (size_t i = 0; i < seeked.size(); i++) {
+            EXPECT_NEAR(seeked[i], continuous[target * 2 + i], 1e-3f);
+        }
+    }
+
+    fs::remove(rampFile);
+}
+
+// Test the playback rate is only taken in varispeed mode and clamped
+TEST_F(AudioFstreamTest, VarispeedPlaybackRate) {
+    AudioFstream stream;
+
+    stream.setPlaybackRate(1.01);
+    EXPECT_DOUBLE_EQ(stream.getPlaybackRate(), 1.0);
+
+    stream.setVarispeed(true);
+    stream.setPlaybackRate(1.01);
+    EXPECT_DOUBLE_EQ(stream.getPlaybackRate(), 1.01);
+
+    stream.setPlaybackRate(2.0);
+    EXPECT_DOUBLE_EQ(stream.getPlaybackRate(), VARISPEED_MAX_RATIO);
+}
+
+// Test a faster playback rate consumes more of the file
+TEST_F(AudioFstreamTest, VarispeedConsumesAtRate) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    AudioFstream stream(rampFile.string());
+    stream.setVarispeed(true);
+    stream.setTargetSampleRate(44100);     // Same rate, resampler kept for varispeed
+    stream.setPlaybackRate(1.04);
+
+    // 10000 output frames at 1.04x cover about 10400 input frames
+    float buffer[2000];
+    for (int i = 0; i < 10; i++) {
+        stream.read((char*) buffer, sizeof(buffer));
+        ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+    }
+
+    float lastFrame = buffer[1998] * 32768.0f;
+    EXPECT_NEAR(lastFrame, 10400.0f, 150.0f);
+
+    fs::remove(rampFile);
+}
+
+// Test a preloaded file reads exactly like the decoder and seeks are exact
+TEST_F(AudioFstreamTest, PreloadMatchesDecodedRead) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    std::vector<float> decoded;
+    {
+        AudioFstream stream(rampFile.string());
+        stream.setTargetSampleRate(48000);
+        EXPECT_FALSE(stream.isPreloaded());
+        float buffer[1024];
+        do {
+            stream.read((char*) buffer, sizeof(buffer));
+            decoded.insert(decoded.end(), buffer, buffer + stream.gcount() / sizeof(float));
+        } while (stream.gcount() == (streamsize) sizeof(buffer));
+    }
+    ASSERT_GT(decoded.size(), 0u);
+
+    AudioFstream stream(rampFile.string());
+    stream.setPreload(true, 0);
+    EXPECT_FALSE(stream.isPreloaded());     // Waits for the output rate
+    stream.setTargetSampleRate(48000);
+    ASSERT_TRUE(stream.isPreloaded());
+    EXPECT_EQ(stream.getFileSize(), decoded.size() * sizeof(float));
+
+    std::vector<float> preloaded(decoded.size() + 64);
+    stream.read((char*) preloaded.data(), preloaded.size() * sizeof(float));
+    ASSERT_EQ(stream.gcount(), (streamsize) (decoded.size() * sizeof(float)));
+    EXPECT_TRUE(stream.eof());
+    for (size_t i = 0; i < decoded.size(); i++) {
+        ASSERT_NEAR(preloaded[i], decoded[i], 1e-6f);
+    }
+
+    // Seeks are pointer arithmetic, back from the end of the file too
+    stream.seekg(9000 * 2 * sizeof(float), std::ios_base::beg);
+    EXPECT_FALSE(stream.eof());
+    float buffer[512];
+    stream.read((char*) buffer, sizeof(buffer));
+    ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+    for (size_t i = 0; i < 512; i++) {
+        EXPECT_FLOAT_EQ(buffer[i], decoded[9000 * 2 + i]);
+    }
+
+    fs::remove(rampFile);
+}
+
+// Test the automatic preload threshold and that varispeed opts out
+TEST_F(AudioFstreamTest, PreloadThreshold) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 44100, 2, rampSample);     // One second
+
+    AudioFstream stream(rampFile.string());
+    stream.setTargetSampleRate(44100);
+    stream.setPreload(false, 0.5);
+    EXPECT_FALSE(stream.isPreloaded());
+    stream.setPreload(false, 2.0);
+    EXPECT_TRUE(stream.isPreloaded());
+
+    // Kept across reopening, as after OSC /load
+    stream.loadFile(rampFile.string());
+    EXPECT_TRUE(stream.isPreloaded());
+
+    // A new rate decodes again
+    stream.setTargetSampleRate(48000);
+    EXPECT_TRUE(stream.isPreloaded());
+    EXPECT_NEAR((double) (stream.getFileSize() / sizeof(float) / 2), 48000.0, 2.0);
+
+    stream.setVarispeed(true);
+    EXPECT_FALSE(stream.isPreloaded());
+    EXPECT_TRUE(stream.good());
+
+    fs::remove(rampFile);
+}
+
+// Test switching to memory keeps the read position
+TEST_F(AudioFstreamTest, PreloadKeepsPosition) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    AudioFstream stream(rampFile.string());
+    stream.setTargetSampleRate(44100);
+
+    float buffer[512];
+    stream.read((char*) buffer, sizeof(buffer));
+    ASSERT_FALSE(stream.isPreloaded());
+
+    stream.setPreload(true, 0);
+    ASSERT_TRUE(stream.isPreloaded());
+
+    stream.read((char*) buffer, sizeof(buffer));
+    ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+    EXPECT_FLOAT_EQ(buffer[0] * 32768.0f, 256.0f);
+    EXPECT_FLOAT_EQ(buffer[511] * 32768.0f, 511.0f);
+
+    fs::remove(rampFile);
+}
+
+// Test the PCM cache is rendered in background, then mapped on later opens
+TEST_F(AudioFstreamTest, PcmCacheRenderAndMap) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    fs::path cacheDir = fs::temp_directory_path() / "test_audio_pcmcache";
+    fs::remove_all(cacheDir);
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    std::vector<float> decoded(4096 * 2);
+    {
+        AudioFstream stream(rampFile.string());
+        stream.setTargetSampleRate(48000);
+        stream.read((char*) decoded.data(), decoded.size() * sizeof(float));
+        ASSERT_EQ(stream.gcount(), (streamsize) (decoded.size() * sizeof(float)));
+    }
+
+    {
+        AudioFstream stream(rampFile.string());
+        stream.setCacheDirectory(cacheDir.string());
+        stream.setTargetSampleRate(48000);
+
+        // Playback goes on with the decoder while the cache is written
+        float buffer[512];
+        stream.read((char*) buffer, sizeof(buffer));
+        ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+
+        for (int i = 0; i < 500 && !stream.isPreloaded(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(stream.isPreloaded());
+
+        // Same position once switched to the mapping
+        stream.read((char*) buffer, sizeof(buffer));
+        ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+        for (size_t i = 0; i < 512; i++) {
+            EXPECT_NEAR(buffer[i], decoded[512 + i], 1e-6f);
+        }
+    }
+    ASSERT_FALSE(fs::is_empty(cacheDir));
+
+    // A new open maps the rendition straight away
+    AudioFstream stream(rampFile.string());
+    stream.setCacheDirectory(cacheDir.string());
+    stream.setTargetSampleRate(48000);
+    ASSERT_TRUE(stream.isPreloaded());
+
+    stream.seekg(1000 * 2 * sizeof(float), std::ios_base::beg);
+    float buffer[512];
+    stream.read((char*) buffer, sizeof(buffer));
+    for (size_t i = 0; i < 512; i++) {
+        EXPECT_NEAR(buffer[i], decoded[1000 * 2 + i], 1e-6f);
+    }
+
+    // Another rate is another rendition
+    stream.setTargetSampleRate(44100);
+    for (int i = 0; i < 500 && !stream.isPreloaded(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(stream.isPreloaded());
+    stream.close();
+
+    size_t renditions = std::distance(fs::directory_iterator(cacheDir), fs::directory_iterator());
+    EXPECT_EQ(renditions, 2u);
+
+    fs::remove_all(cacheDir);
+    fs::remove(rampFile);
+}
+
+// Test two streams on one file share a single decoded rendition
+TEST_F(AudioFstreamTest, SharedMemoryRendition) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp_shm.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    AudioFstream first(rampFile.string());
+    first.setSharedMemory(true);
+    first.setTargetSampleRate(48000);
+
+    AudioFstream second(rampFile.string());
+    second.setSharedMemory(true);
+    second.setTargetSampleRate(48000);
+
+    for (int i = 0; i < 500 && !(first.isPreloaded() && second.isPreloaded()); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(first.isPreloaded());
+    ASSERT_TRUE(second.isPreloaded());
+
+    float a[512], b[512];
+    first.seekg(1000 * 2 * sizeof(float), std::ios_base::beg);
+    second.seekg(1000 * 2 * sizeof(float), std::ios_base::beg);
+    first.read((char*) a, sizeof(a));
+    second.read((char*) b, sizeof(b));
+    ASSERT_EQ(second.gcount(), (streamsize) sizeof(b));
+    for (size_t i = 0; i < 512; i++) {
+        EXPECT_FLOAT_EQ(a[i], b[i]);
+    }
+
+    // The last one out removes the segment
+    first.close();
+    second.close();
+    for (const auto& entry : fs::directory_iterator("/dev/shm")) {
+        EXPECT_EQ(entry.path().filename().string().find("cuems-pcm-test_audio_ramp_shm"), std::string::npos);
+    }
+
+    fs::remove(rampFile);
+}
+
+// Test the channel layout changes in place and reading goes on where it was
+TEST_F(AudioFstreamTest, SetTargetChannelsKeepsPosition) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    for (bool native : {true, false}) {
+        SCOPED_TRACE(native ? "native PCM" : "FFmpeg");
+        AudioFstream stream;
+        stream.setNativePcm(native);
+        stream.open(rampFile.string(), std::ios::binary | std::ios::in);
+        ASSERT_TRUE(stream.good());
+        ASSERT_EQ(stream.getChannels(), 2u);
+
+        float buffer[2 * 256];
+        stream.read((char*) buffer, sizeof(buffer));
+        ASSERT_EQ(stream.gcount(), (streamsize) sizeof(buffer));
+
+        // Upmixed, the frame size changes but not the frame count
+        stream.setTargetChannels(4);
+        ASSERT_TRUE(stream.good());
+        EXPECT_EQ(stream.getChannels(), 4u);
+        EXPECT_EQ(stream.getFileSize(), 20000 * 4 * (long long) sizeof(float));
+
+        float quad[4 * 100];
+        stream.read((char*) quad, sizeof(quad));
+        ASSERT_EQ(stream.gcount(), (streamsize) sizeof(quad));
+
+        // Back to the file's own layout, samples are exact again
+        stream.setTargetChannels(0);
+        ASSERT_TRUE(stream.good());
+        EXPECT_EQ(stream.getChannels(), 2u);
+
+        float frame[2];
+        stream.read((char*) frame, sizeof(frame));
+        ASSERT_EQ(stream.gcount(), (streamsize) sizeof(frame));
+        EXPECT_EQ(std::lround(frame[0] * 32768.0f), 356);
+        EXPECT_EQ(std::lround(frame[1] * 32768.0f), 356);
+    }
+
+    fs::remove(rampFile);
+}
+
+// Test a native file remixed in place comes out as FFmpeg remixes it
+TEST_F(AudioFstreamTest, SetTargetChannelsNativeMatchesFFmpeg) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, [](uint32_t frame, uint16_t channel) {
+        return (int32_t) (channel ? frame % 1000 : frame % 32768);
+    });
+
+    std::vector<float> mixed[2];
+    for (bool native : {true, false}) {
+        AudioFstream stream;
+        stream.setNativePcm(native);
+        stream.open(rampFile.string(), std::ios::binary | std::ios::in);
+        ASSERT_TRUE(stream.good());
+
+        float skip[2 * 300];
+        stream.read((char*) skip, sizeof(skip));
+        stream.setTargetChannels(1);
+        ASSERT_TRUE(stream.good());
+
+        std::vector<float>& out = mixed[native];
+        out.resize(5000);
+        stream.read((char*) out.data(), out.size() * sizeof(float));
+        ASSERT_EQ(stream.gcount(), (streamsize) (out.size() * sizeof(float)));
+    }
+
+    for (size_t i = 0; i < mixed[0].size(); i++) {
+        ASSERT_NEAR(mixed[1][i], mixed[0][i], 1e-6f) << "frame " << i;
+    }
+
+    fs::remove(rampFile);
+}
+
+// Test a preloaded file is loaded again in the new layout
+TEST_F(AudioFstreamTest, SetTargetChannelsPreloaded) {
+    fs::path rampFile = fs::temp_directory_path() / "test_audio_ramp.wav";
+    writeTestWav(rampFile, 20000, 2, rampSample);
+
+    AudioFstream stream(rampFile.string());
+    stream.setPreload(true, 0);
+    stream.setTargetSampleRate(44100);
+    ASSERT_TRUE(stream.isPreloaded());
+
+    stream.seekg(1000 * 2 * sizeof(float), std::ios_base::beg);
+    stream.setTargetChannels(4);
+    stream.setTargetChannels(2);
+    ASSERT_TRUE(stream.isPreloaded());
+
+    float frame[2];
+    stream.read((char*) frame, sizeof(frame));
+    ASSERT_EQ(stream.gcount(), (streamsize) sizeof(frame));
+    EXPECT_EQ(std::lround(frame[0] * 32768.0f), 1000);
+
+    fs::remove(rampFile);
+}
+
+// Test 24 bit PCM is read natively with every sample exact, seeks included
+TEST_F(AudioFstreamTest, NativePcm24Bit) {
+    fs::path file24 = fs::temp_directory_path() / "test_audio_24bit.wav";
+    writeTestWav(file24, 5000, 1, [](uint32_t frame, uint16_t) {
+        return (int32_t) frame * 1000 - 2500000;
+    }, 48000, 24);
+
+    AudioFstream stream(file24.string());
+    ASSERT_TRUE(stream.good());
+    EXPECT_EQ(stream.getChannels(), 1u);
+    EXPECT_EQ(stream.getSampleRate(), 48000u);
+    EXPECT_EQ(stream.getFileSize(), 5000 * (long long) sizeof(float));
+
+    // Odd sized reads, through the vector kernels and their tails
+    std::vector<float> samples(5000);
+    size_t done = 0;
+    for (size_t chunk = 1; done < samples.size(); chunk += 37) {
+        size_t floats = std::min(chunk, samples.size() - done);
+        stream.read((char*) (samples.data() + done), floats * sizeof(float));
+        ASSERT_EQ(stream.gcount(), (streamsize) (floats * sizeof(float)));
+        done += floats;
+    }
+    for (size_t i = 0; i < samples.size(); i++) {
+        ASSERT_EQ(std::lround(samples[i] * 8388608.0f), (long) i * 1000 - 2500000);
+    }
+
+    stream.read((char*) samples.data(), sizeof(float));
+    EXPECT_EQ(stream.gcount(), 0);
+    EXPECT_TRUE(stream.eof());
+
+    stream.seekg(-10 * (long long) sizeof(float), std::ios_base::end);
+    float sample;
+    stream.read((char*) &sample, sizeof(sample));
+    ASSERT_EQ(stream.gcount(), (streamsize) sizeof(sample));
+    EXPECT_EQ(std::lround(sample * 8388608.0f), 4990L * 1000 - 2500000);
+
+    fs::remove(file24);
+}
@@ -23,10 +23,32 @@
 #include <gtest/gtest.h>
 #include <atomic>
 #include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <poll.h>
+#include <oscpack/osc/OscOutboundPacketStream.h>
 #include "audioplayer.h"
+#include "testwav.h"
 
 namespace fs = std::filesystem;
 
+// Feeds OSC messages straight to the player's handler, no socket involved
+class OscTestPlayer : public AudioPlayer {
+public:
+    using AudioPlayer::AudioPlayer;
+
+    void receive(const std::string& address, float value) {
+        char buffer[256];
+        osc::OutboundPacketStream packet(buffer, sizeof(buffer));
+        packet << osc::BeginMessage((oscAddress + address).c_str()) << value << osc::EndMessage;
+        osc::ReceivedPacket received(packet.Data(), packet.Size());
+        ProcessMessage(osc::ReceivedMessage(received), IpEndpointName());
+    }
+};
+
 // Note: AudioPlayer tests are limited because it requires:
 // - JACK audio server running
 // - Real audio hardware
@@ -81,7 +103,8 @@ TEST_F(AudioPlayerTest, ClassExists) {
 // - JACK running
 // - Valid audio file
 // - Audio device available
-// These would be integration tests, not unit tests
+// These would be integration tests, not unit tests. The null backend
+// (RTAUDIO_DUMMY, see NullBackendRender) is the exception.
 
 // Test that AudioPlayer inherits from OscReceiver
 TEST_F(AudioPlayerTest, InheritanceCheck) {
@@ -212,4 +235,266 @@ TEST_F(AudioPlayerTest, ConstantValues) {
     #endif
 }
 
+// Test the null backend renders the file following scripted MTC
+TEST_F(AudioPlayerTest, NullBackendRender) {
+    fs::path inFile = fs::temp_directory_path() / "test_render_in.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_render_out.wav";
+
+    // One second 16 bit stereo ramp, every sample holds its frame index
+    writeTestWav(inFile, 44100, 2, rampSample);
+
+    {
+        AudioPlayer player(17999, 0, 0, "", inFile.string(), "", "Render_Test",
+                           true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY);
+        EXPECT_EQ(player.renderToFile(outFile.string(), 0.5), CUEMS_EXIT_OK);
+
+        // The callback counters are what /stats reports
+        CallbackStats::Snapshot stats = player.callbackStats.snapshot();
+        EXPECT_EQ(stats.callbacks, 44u);
+        EXPECT_EQ(stats.underflows, 0u);
+        EXPECT_EQ(stats.seeks, 0u);
+        EXPECT_GT(stats.decodeUs, 0.0);
+        EXPECT_LT(std::abs(stats.driftMs), 2000.0 / RENDER_MTC_FRAMERATE);
+    }
+
+    // 0.5 s rounded up to whole 512 frame periods, after the 58 byte header
+    std::ifstream out(outFile, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    size_t frames = (data.size() - 58) / 8;
+    EXPECT_EQ(frames, 22528u);
+
+    // No seek expected, the output is the file itself
+    const float* samples = (const float*) (data.data() + 58);
+    EXPECT_FLOAT_EQ(samples[1000 * 2] * 32768.0f, 1000.0f);
+    EXPECT_FLOAT_EQ(samples[20000 * 2 + 1] * 32768.0f, 20000.0f);
+
+    fs::remove(inFile);
+    fs::remove(outFile);
+}
+
+// Test the end of play wakes a poll() on the player's eventfd
+TEST_F(AudioPlayerTest, EndOfPlayEvent) {
+    fs::path inFile = fs::temp_directory_path() / "test_end_in.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_end_out.wav";
+
+    // A tenth of a second of 16 bit stereo silence
+    writeTestWav(inFile, 4410, 2, [](uint32_t, uint16_t) { return 0; });
+
+    {
+        AudioPlayer player(17996, 0, 0, "", inFile.string(), "", "End_Test",
+                           true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY);
+        ASSERT_GE(player.getEndOfPlayEvent(), 0);
+
+        struct pollfd event = { player.getEndOfPlayEvent(), POLLIN, 0 };
+        EXPECT_EQ(poll(&event, 1, 0), 0);
+
+        // No length given, renders until the file ends
+        EXPECT_EQ(player.renderToFile(outFile.string()), CUEMS_EXIT_OK);
+        EXPECT_TRUE(AudioPlayer::endOfPlay);
+        EXPECT_EQ(poll(&event, 1, 0), 1);
+        EXPECT_TRUE(event.revents & POLLIN);
+    }
+
+    fs::remove(inFile);
+    fs::remove(outFile);
+}
+
+// Test a preloaded cue goes on air at the next period after /swap
+TEST_F(AudioPlayerTest, PreloadAndSwapCue) {
+    fs::path firstFile = fs::temp_directory_path() / "test_cue_first.wav";
+    fs::path nextFile = fs::temp_directory_path() / "test_cue_next.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_cue_out.wav";
+
+    // One second 16 bit stereo ramps, the second one starts at 5000
+    auto writeRamp = [](const fs::path& path, uint32_t start) {
+        writeTestWav(path, 44100, 2, [start](uint32_t frame, uint16_t) {
+            return (int32_t)((start + frame) % 32768);
+        });
+    };
+    writeRamp(firstFile, 0);
+    writeRamp(nextFile, 5000);
+
+    {
+        AudioPlayer player(17998, 0, 0, "", firstFile.string(), "", "Cue_Test",
+                           true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY);
+
+        // Nothing to swap to yet
+        player.swapCue();
+        EXPECT_FALSE(player.isCueReady());
+
+        ASSERT_TRUE(player.preloadCue(nextFile.string()));
+        for (int i = 0; i < 500 && !player.isCueReady(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(player.isCueReady());
+
+        player.swapCue();
+        EXPECT_EQ(player.renderToFile(outFile.string(), 0.25), CUEMS_EXIT_OK);
+        EXPECT_FALSE(player.isCueReady());
+        EXPECT_EQ(player.callbackStats.snapshot().seeks, 0u);
+    }
+
+    // Switched before the first period, the output is the second file
+    std::ifstream out(outFile, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    ASSERT_GT(data.size(), 58u + 2000 * 8);
+    const float* samples = (const float*) (data.data() + 58);
+    EXPECT_FLOAT_EQ(samples[0] * 32768.0f, 5000.0f);
+    EXPECT_FLOAT_EQ(samples[1000 * 2 + 1] * 32768.0f, 6000.0f);
+
+    fs::remove(firstFile);
+    fs::remove(nextFile);
+    fs::remove(outFile);
+}
 
+// Test an /offset after a swap moves the cue by the change, not to the value
+TEST_F(AudioPlayerTest, OffsetAfterSwapIsRelative) {
+    fs::path firstFile = fs::temp_directory_path() / "test_cue_offset_first.wav";
+    fs::path nextFile = fs::temp_directory_path() / "test_cue_offset_next.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_cue_offset_out.wav";
+
+    writeTestWav(firstFile, 44100, 2, rampSample);
+    writeTestWav(nextFile, 44100, 2, [](uint32_t frame, uint16_t) {
+        return (int32_t)((5000 + frame) % 32768);
+    });
+
+    {
+        // Started with a 100 ms offset
+        OscTestPlayer player(17994, 100, 0, "", firstFile.string(), "", "Cue_Offset_Test",
+                             true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY);
+
+        ASSERT_TRUE(player.preloadCue(nextFile.string()));
+        for (int i = 0; i < 500 && !player.isCueReady(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(player.isCueReady());
+
+        // The same offset sent again right after the swap changes nothing
+        player.swapCue();
+        player.receive("/offset", 100.0f);
+        EXPECT_EQ(player.renderToFile(outFile.string(), 0.25), CUEMS_EXIT_OK);
+    }
+
+    // The cue still starts from its top
+    std::ifstream out(outFile, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    ASSERT_GT(data.size(), 58u + 2000 * 8);
+    const float* samples = (const float*) (data.data() + 58);
+    EXPECT_FLOAT_EQ(samples[0] * 32768.0f, 5000.0f);
+    EXPECT_FLOAT_EQ(samples[1000 * 2 + 1] * 32768.0f, 6000.0f);
+
+    fs::remove(firstFile);
+    fs::remove(nextFile);
+    fs::remove(outFile);
+}
+
+// Test a stereo file routed to four output ports
+TEST_F(AudioPlayerTest, RoutedRender) {
+    fs::path inFile = fs::temp_directory_path() / "test_route_in.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_route_out.wav";
+
+    // One second 16 bit stereo ramps, right 100 ahead of left
+    writeTestWav(inFile, 44100, 2, [](uint32_t frame, uint16_t channel) {
+        return (int32_t)((frame + channel * 100) % 32768);
+    });
+
+    {
+        AudioPlayer player(17997, 0, 0, "", inFile.string(), "", "Route_Test",
+                           true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY,
+                           "hq", -1, false, false, NULL_BACKEND_BUFFER_FRAMES,
+                           false, PRELOAD_MAX_SECONDS, "", false, 0, 0, {}, false,
+                           4, "0:0,1:1,0:3:0.5,1:3:0.5");
+        EXPECT_TRUE(player.routingMode);
+        EXPECT_EQ(player.outputChannels, 4u);
+        EXPECT_EQ(player.nChannels, 2u);
+        EXPECT_EQ(player.renderToFile(outFile.string(), 0.25), CUEMS_EXIT_OK);
+    }
+
+    // Ports: left, right, silence, the mean of both
+    std::ifstream out(outFile, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    ASSERT_GT(data.size(), 58u + 2000 * 16);
+    const float* samples = (const float*) (data.data() + 58);
+    EXPECT_FLOAT_EQ(samples[1000 * 4] * 32768.0f, 1000.0f);
+    EXPECT_FLOAT_EQ(samples[1000 * 4 + 1] * 32768.0f, 1100.0f);
+    EXPECT_EQ(samples[1000 * 4 + 2], 0.0f);
+    EXPECT_FLOAT_EQ(samples[1000 * 4 + 3] * 32768.0f, 1050.0f);
+
+    fs::remove(inFile);
+    fs::remove(outFile);
+}
+
+// Test a voice follows the timeline in its own frames when routed
+TEST_F(AudioPlayerTest, RoutedVoice) {
+    fs::path mainFile = fs::temp_directory_path() / "test_route_voice_main.wav";
+    fs::path voiceFile = fs::temp_directory_path() / "test_route_voice_voice.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_route_voice_out.wav";
+
+    // One second 16 bit stereo ramps, every sample holds its frame index
+    writeTestWav(mainFile, 44100, 2, rampSample);
+    writeTestWav(voiceFile, 44100, 2, rampSample);
+
+    {
+        // Main file frames are 8 bytes, the voice decodes to the 4 ports, 16
+        AudioPlayer player(17995, 0, 0, "", mainFile.string(), "", "Route_Voice_Test",
+                           true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY,
+                           "hq", -1, false, false, NULL_BACKEND_BUFFER_FRAMES,
+                           false, PRELOAD_MAX_SECONDS, "", false, 1, 0, {}, false,
+                           4, "0:0,1:1");
+        ASSERT_EQ(player.voices.size(), 1u);
+        Voice& voice = *player.voices[0];
+        ASSERT_TRUE(voice.load(voiceFile.string(), player.outputChannels, 44100,
+                               NULL_BACKEND_BUFFER_FRAMES));
+        voice.setOffset(1000);
+        ASSERT_TRUE(voice.play());
+        EXPECT_EQ(player.renderToFile(outFile.string(), 0.25), CUEMS_EXIT_OK);
+    }
+
+    // Port 0 holds the main file plus the voice 1000 frames ahead of it
+    std::ifstream out(outFile, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    ASSERT_GT(data.size(), 58u + 6000 * 16);
+    const float* samples = (const float*) (data.data() + 58);
+    EXPECT_FLOAT_EQ(samples[2000 * 4] * 32768.0f, 2000.0f + 3000.0f);
+    EXPECT_FLOAT_EQ(samples[5000 * 4] * 32768.0f, 5000.0f + 6000.0f);
+
+    fs::remove(mainFile);
+    fs::remove(voiceFile);
+    fs::remove(outFile);
+}
+
+// Test a voice without an offset lines up with the main file under output latency
+TEST_F(AudioPlayerTest, VoiceOutputLatency) {
+    fs::path mainFile = fs::temp_directory_path() / "test_latency_voice_main.wav";
+    fs::path voiceFile = fs::temp_directory_path() / "test_latency_voice_voice.wav";
+    fs::path outFile = fs::temp_directory_path() / "test_latency_voice_out.wav";
+
+    writeTestWav(mainFile, 44100, 2, rampSample);
+    writeTestWav(voiceFile, 44100, 2, rampSample);
+
+    {
+        // 20 ms of output latency, 882 frames at 44.1 kHz
+        AudioPlayer player(17996, 0, 0, "", mainFile.string(), "", "Latency_Voice_Test",
+                           true, false, 2, 44100, RtAudio::Api::RTAUDIO_DUMMY,
+                           "hq", 20, false, false, NULL_BACKEND_BUFFER_FRAMES,
+                           false, PRELOAD_MAX_SECONDS, "", false, 1);
+        ASSERT_EQ(player.voices.size(), 1u);
+        Voice& voice = *player.voices[0];
+        ASSERT_TRUE(voice.load(voiceFile.string(), player.outputChannels, 44100,
+                               NULL_BACKEND_BUFFER_FRAMES));
+        ASSERT_TRUE(voice.play());
+        EXPECT_EQ(player.renderToFile(outFile.string(), 0.25), CUEMS_EXIT_OK);
+    }
+
+    // Both ahead by the latency, so every sample is twice the same frame
+    std::ifstream out(outFile, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(out)), std::istreambuf_iterator<char>());
+    ASSERT_GT(data.size(), 58u + 6000 * 8);
+    const float* samples = (const float*) (data.data() + 58);
+    EXPECT_FLOAT_EQ(samples[2000 * 2] * 32768.0f, 2.0f * (2000 + 882));
+    EXPECT_FLOAT_EQ(samples[5000 * 2 + 1] * 32768.0f, 2.0f * (5000 + 882));
+
+    fs::remove(mainFile);
+    fs::remove(voiceFile);
+    fs::remove(outFile);
+}
@@ -0,0 +1,159 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include "audiostreamer.h"
+#include "testwav.h"
+
+namespace fs = std::filesystem;
+
+class AudioStreamerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testFile = fs::temp_directory_path() / "test_streamer.wav";
+        writeTestWav(testFile, 44100, 2, rampSample);
+    }
+
+    void TearDown() override {
+        if (fs::exists(testFile)) {
+            fs::remove(testFile);
+        }
+    }
+
+    fs::path testFile;
+};
+
+// Test invalid geometry is refused
+TEST_F(AudioStreamerTest, StartInvalidGeometry) {
+    AudioFstream file;
+    AudioStreamer streamer(file);
+
+    EXPECT_FALSE(streamer.start(0, 2, 44100));
+    EXPECT_FALSE(streamer.isRunning());
+}
+
+// Test reading before start gives a full buffer of silence
+TEST_F(AudioStreamerTest, ReadBeforeStartIsSilence) {
+    AudioFstream file;
+    AudioStreamer streamer(file);
+
+    float buffer[256];
+    std::fill(buffer, buffer + 256, 1.0f);
+    streamer.read((char*) buffer, sizeof(buffer));
+
+    EXPECT_EQ(streamer.gcount(), (streamsize) sizeof(buffer));
+    for (int i = 0; i < 256; i++) {
+        EXPECT_EQ(buffer[i], 0.0f);
+    }
+}
+
+// Test a closed file is reported as end of stream
+TEST_F(AudioStreamerTest, ClosedFileReachesEof) {
+    AudioFstream file;
+    AudioStreamer streamer(file);
+
+    ASSERT_TRUE(streamer.start(128, 2, 44100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    float buffer[256];
+    streamer.read((char*) buffer, sizeof(buffer));
+
+    EXPECT_EQ(streamer.gcount(), 0);
+    EXPECT_TRUE(streamer.eof());
+    streamer.stop();
+}
+
+// Test the streamer delivers the same samples as reading the file directly
+TEST_F(AudioStreamerTest, MatchesDirectRead) {
+    AudioFstream direct(testFile.string());
+    ASSERT_TRUE(direct.good());
+
+    float expected[512];
+    direct.read((char*) expected, sizeof(expected));
+    ASSERT_EQ(direct.gcount(), (streamsize) sizeof(expected));
+
+    AudioFstream file(testFile.string());
+    AudioStreamer streamer(file);
+    ASSERT_TRUE(streamer.start(256, 2, 44100));
+
+    // Give the decoder thread time to fill the ring
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    float buffer[512];
+    streamer.read((char*) buffer, sizeof(buffer));
+    EXPECT_EQ(streamer.gcount(), (streamsize) sizeof(buffer));
+    EXPECT_EQ(streamer.getUnderruns(), 0u);
+
+    for (int i = 0; i < 512; i++) {
+        EXPECT_FLOAT_EQ(buffer[i], expected[i]);
+    }
+
+    streamer.stop();
+}
+
+// Test a seek is serviced by the decoder thread
+TEST_F(AudioStreamerTest, SeekIsServiced) {
+    AudioFstream file(testFile.string());
+    AudioStreamer streamer(file);
+    ASSERT_TRUE(streamer.start(256, 2, 44100));
+
+    float buffer[512];
+    streamer.seekg(1000 * 2 * sizeof(float), std::ios_base::beg);
+
+    // Until acknowledged the consumer only plays silence
+    streamer.read((char*) buffer, sizeof(buffer));
+    EXPECT_EQ(streamer.gcount(), (streamsize) sizeof(buffer));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    streamer.read((char*) buffer, sizeof(buffer));
+    EXPECT_EQ(streamer.gcount(), (streamsize) sizeof(buffer));
+    EXPECT_FALSE(streamer.eof());
+
+    streamer.stop();
+}
+
+// Test the fill level and decode time reported to /stats
+TEST_F(AudioStreamerTest, BufferFillAndDecodeTime) {
+    AudioFstream file(testFile.string());
+    AudioStreamer streamer(file);
+    EXPECT_DOUBLE_EQ(streamer.getBufferFill(), 0.0);
+    EXPECT_DOUBLE_EQ(streamer.getDecodeUs(), 0.0);
+
+    ASSERT_TRUE(streamer.start(256, 2, 44100, 4));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Four periods decoded ahead fill the ring
+    EXPECT_DOUBLE_EQ(streamer.getBufferFill(), 1.0);
+    EXPECT_GT(streamer.getDecodeUs(), 0.0);
+
+    // With the producer stopped one period read leaves three
+    streamer.stop();
+    float buffer[512];
+    streamer.read((char*) buffer, sizeof(buffer));
+    EXPECT_DOUBLE_EQ(streamer.getBufferFill(), 0.75);
+}
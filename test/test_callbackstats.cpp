@@ -0,0 +1,155 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include "callbackstats.h"
+
+// Test every value lands in a bucket whose upper bound is above it
+TEST(CallbackStatsTest, BucketsBoundValues) {
+    for (uint32_t us = 0; us < 100000; us += 7) {
+        unsigned int bucket = CallbackStats::bucketFor(us);
+        ASSERT_LT(bucket, (unsigned int) CALLBACK_STATS_BUCKETS);
+        EXPECT_GT(CallbackStats::bucketUpperBound(bucket), us);
+        if (bucket > 0) {
+            EXPECT_LE(CallbackStats::bucketUpperBound(bucket - 1), us);
+        }
+    }
+
+    // Resolution stays within a quarter octave
+    unsigned int bucket = CallbackStats::bucketFor(1000);
+    EXPECT_LE(CallbackStats::bucketUpperBound(bucket), 1280u);
+}
+
+// Test out of range values go to the last bucket
+TEST(CallbackStatsTest, OverflowBucket) {
+    EXPECT_EQ(CallbackStats::bucketFor(0xFFFFFFFF), (unsigned int) CALLBACK_STATS_BUCKETS - 1);
+}
+
+// Test percentiles, average, max and load
+TEST(CallbackStatsTest, Percentiles) {
+    CallbackStats stats;
+    stats.setPeriod(512, 48000);        // 10666 us budget
+
+    for (int i = 0; i < 90; i++) stats.recordCallback(100);
+    for (int i = 0; i < 9; i++) stats.recordCallback(1000);
+    stats.recordCallback(5000);
+
+    CallbackStats::Snapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.callbacks, 100u);
+    EXPECT_DOUBLE_EQ(snap.avgUs, (90 * 100 + 9 * 1000 + 5000) / 100.0);
+    EXPECT_DOUBLE_EQ(snap.maxUs, 5000.0);
+    EXPECT_DOUBLE_EQ(snap.lastUs, 5000.0);
+    EXPECT_NEAR(snap.periodUs, 10666.7, 0.1);
+    EXPECT_NEAR(snap.load, snap.avgUs / snap.periodUs, 1e-9);
+
+    EXPECT_GT(snap.p50Us, 100.0);
+    EXPECT_LE(snap.p50Us, 128.0);
+    EXPECT_GT(snap.p95Us, 1000.0);
+    EXPECT_LE(snap.p95Us, 1280.0);
+    EXPECT_GT(snap.p99Us, 1000.0);
+    EXPECT_LE(snap.p99Us, 1280.0);
+}
+
+// Test the event counters and reset
+TEST(CallbackStatsTest, CountersAndReset) {
+    CallbackStats stats;
+    stats.recordUnderflow();
+    stats.recordUnderflow();
+    stats.recordShortRead();
+    stats.recordSeek();
+    stats.recordSeek();
+    stats.recordSeek();
+    stats.recordCallback(42);
+
+    CallbackStats::Snapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.underflows, 2u);
+    EXPECT_EQ(snap.shortReads, 1u);
+    EXPECT_EQ(snap.seeks, 3u);
+
+    stats.reset();
+    snap = stats.snapshot();
+    EXPECT_EQ(snap.callbacks, 0u);
+    EXPECT_EQ(snap.underflows, 0u);
+    EXPECT_EQ(snap.seeks, 0u);
+    EXPECT_DOUBLE_EQ(snap.maxUs, 0.0);
+    EXPECT_DOUBLE_EQ(snap.p99Us, 0.0);
+}
+
+// Test decode time average and last drift
+TEST(CallbackStatsTest, DecodeAndDrift) {
+    CallbackStats stats;
+    stats.recordDecode(100000);
+    stats.recordDecode(300000);
+    stats.recordDrift(-3.5);
+    stats.recordDrift(1.25);
+
+    CallbackStats::Snapshot snap = stats.snapshot();
+    EXPECT_DOUBLE_EQ(snap.decodeUs, 200.0);
+    EXPECT_DOUBLE_EQ(snap.driftMs, 1.25);
+
+    stats.reset();
+    snap = stats.snapshot();
+    EXPECT_DOUBLE_EQ(snap.decodeUs, 0.0);
+    EXPECT_DOUBLE_EQ(snap.driftMs, 0.0);
+}
+
+// Test the scope timer records once per scope
+TEST(CallbackStatsTest, TimerRecords) {
+    CallbackStats stats;
+    {
+        CallbackStats::Timer timer(stats);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    CallbackStats::Snapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.callbacks, 1u);
+    EXPECT_GE(snap.maxUs, 2000.0);
+}
+
+// Test snapshots can be taken while the audio thread records
+TEST(CallbackStatsTest, ConcurrentReaders) {
+    CallbackStats stats;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]() {
+        for (int i = 0; i < 200000; i++) {
+            stats.recordCallback(i % 500);
+            if (i % 1000 == 0) stats.recordUnderflow();
+        }
+        done = true;
+    });
+
+    uint64_t lastCallbacks = 0;
+    while (!done) {
+        CallbackStats::Snapshot snap = stats.snapshot();
+        EXPECT_GE(snap.callbacks, lastCallbacks);
+        EXPECT_LE(snap.maxUs, 499.0);
+        lastCallbacks = snap.callbacks;
+    }
+    writer.join();
+
+    CallbackStats::Snapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.callbacks, 200000u);
+    EXPECT_EQ(snap.underflows, 200u);
+    EXPECT_DOUBLE_EQ(snap.maxUs, 499.0);
+}
@@ -0,0 +1,118 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "commandqueue.h"
+
+namespace {
+struct Item {
+    uint32_t producer;
+    uint32_t sequence;
+};
+}
+
+// Test items come out in the order they went in
+TEST(CommandQueueTest, FifoOrder) {
+    CommandQueue<Item, 8> queue;
+    Item item;
+    EXPECT_FALSE(queue.pop(item));
+
+    for (uint32_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(queue.push({0, i}));
+    }
+    for (uint32_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(item.sequence, i);
+    }
+    EXPECT_FALSE(queue.pop(item));
+}
+
+// Test a full queue refuses pushes until something is popped
+TEST(CommandQueueTest, BoundedCapacity) {
+    CommandQueue<Item, 4> queue;
+    for (uint32_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.push({0, i}));
+    }
+    EXPECT_FALSE(queue.push({0, 4}));
+
+    Item item;
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item.sequence, 0u);
+    EXPECT_TRUE(queue.push({0, 4}));
+}
+
+// Test positions wrap around the cells many times
+TEST(CommandQueueTest, WrapAround) {
+    CommandQueue<Item, 4> queue;
+    Item item;
+    for (uint32_t i = 0; i < 1000; i++) {
+        ASSERT_TRUE(queue.push({0, i}));
+        ASSERT_TRUE(queue.push({1, i}));
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(item.producer, 0u);
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(item.producer, 1u);
+        EXPECT_EQ(item.sequence, i);
+    }
+}
+
+// Test several producers against one consumer: nothing lost or
+// duplicated, and each producer's items keep their order
+TEST(CommandQueueTest, ConcurrentProducers) {
+    const uint32_t producers = 4;
+    const uint32_t perProducer = 50000;
+    CommandQueue<Item, 64> queue;
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p, perProducer] {
+            for (uint32_t i = 0; i < perProducer; i++) {
+                while (!queue.push({p, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(producers, 0);
+    uint32_t received = 0;
+    while (received < producers * perProducer) {
+        Item item;
+        if (!queue.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_LT(item.producer, producers);
+        ASSERT_EQ(item.sequence, next[item.producer]);
+        next[item.producer]++;
+        received++;
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Item item;
+    EXPECT_FALSE(queue.pop(item));
+}
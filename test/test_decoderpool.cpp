@@ -0,0 +1,177 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include "decoderpool.h"
+#include "audiostreamer.h"
+#include "testwav.h"
+
+namespace fs = std::filesystem;
+
+class DecoderPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testFile = fs::temp_directory_path() / "test_decoderpool.wav";
+
+        // 16 bit stereo ramp, every sample holds its frame index
+        writeTestWav(testFile, 44100, 2, rampSample);
+    }
+
+    void TearDown() override {
+        fs::remove(testFile);
+    }
+
+    fs::path testFile;
+};
+
+// Test CPU lists are expanded and garbage refused
+TEST_F(DecoderPoolTest, ParseCpuList) {
+    EXPECT_EQ(DecoderPool::parseCpuList("3"), std::vector<int>({3}));
+    EXPECT_EQ(DecoderPool::parseCpuList("0,2,4-7"), std::vector<int>({0, 2, 4, 5, 6, 7}));
+    EXPECT_TRUE(DecoderPool::parseCpuList("").empty());
+
+    EXPECT_THROW(DecoderPool::parseCpuList("a"), std::invalid_argument);
+    EXPECT_THROW(DecoderPool::parseCpuList("2x"), std::invalid_argument);
+    EXPECT_THROW(DecoderPool::parseCpuList("4-2"), std::invalid_argument);
+    EXPECT_THROW(DecoderPool::parseCpuList("1-"), std::invalid_argument);
+    EXPECT_THROW(DecoderPool::parseCpuList("-1"), std::invalid_argument);
+}
+
+// Test the deadline follows the buffered audio
+TEST_F(DecoderPoolTest, StreamerDeadline) {
+    AudioFstream file(testFile.string());
+    AudioStreamer streamer(file);
+    EXPECT_EQ(streamer.getDeadlineUs(), -1);
+
+    DecoderPool pool(1);
+    streamer.setPool(&pool);
+    ASSERT_TRUE(streamer.start(441, 2, 44100, 4));
+
+    // A full ring has nothing to decode
+    for (int i = 0; i < 200 && streamer.getDeadlineUs() != -1; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(streamer.getDeadlineUs(), -1);
+    EXPECT_GT(streamer.getBufferFill(), 0.5);
+
+    // One period read leaves room, and what is left to play
+    std::vector<float> buffer(441 * 2);
+    streamer.stop();
+    streamer.read((char*) buffer.data(), buffer.size() * sizeof(float));
+    long long deadline = streamer.getDeadlineUs();
+    EXPECT_GE(deadline, 30000);
+    EXPECT_LE(deadline, 40000);
+}
+
+// Test a few workers keep many streams fed with the right audio
+TEST_F(DecoderPoolTest, ServesManyStreams) {
+    const int streams = 6;
+    DecoderPool pool(2);
+    EXPECT_EQ(pool.getWorkers(), 2u);
+
+    std::vector<std::unique_ptr<AudioFstream>> files;
+    std::vector<std::unique_ptr<AudioStreamer>> streamers;
+    for (int i = 0; i < streams; i++) {
+        files.emplace_back(new AudioFstream(testFile.string()));
+        streamers.emplace_back(new AudioStreamer(*files.back()));
+        streamers.back()->setPool(&pool);
+        ASSERT_TRUE(streamers.back()->start(256, 2, 44100));
+    }
+
+    // Every stream advances its own way through the file
+    std::vector<float> buffer(256 * 2);
+    for (int period = 0; period < 40; period++) {
+        for (int i = 0; i < streams; i++) {
+            for (int wait = 0; wait < 1000 && !streamers[i]->isBuffered(buffer.size()); wait++) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            if (period % (i + 1) != 0) continue;
+
+            streamers[i]->read((char*) buffer.data(), buffer.size() * sizeof(float));
+            ASSERT_EQ(streamers[i]->gcount(), (streamsize)(buffer.size() * sizeof(float)));
+        }
+    }
+
+    for (int i = 0; i < streams; i++) {
+        for (int wait = 0; wait < 1000 && !streamers[i]->isBuffered(buffer.size()); wait++) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        streamers[i]->read((char*) buffer.data(), buffer.size() * sizeof(float));
+        float frame = buffer[0] * 32768.0f;
+        EXPECT_FLOAT_EQ(frame, (float)(((40 + i) / (i + 1)) * 256));
+        EXPECT_EQ(streamers[i]->getUnderruns(), 0u);
+    }
+
+    // Stopped streams are left alone
+    for (auto& streamer : streamers) {
+        streamer->stop();
+        EXPECT_FALSE(streamer->isRunning());
+    }
+    unsigned long long fills = pool.getFills();
+    EXPECT_GT(fills, 0u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pool.getFills(), fills);
+}
+
+// Test a seek is served through the pool
+TEST_F(DecoderPoolTest, ServesSeeks) {
+    DecoderPool pool(2);
+    AudioFstream file(testFile.string());
+    AudioStreamer streamer(file);
+    streamer.setPool(&pool);
+    ASSERT_TRUE(streamer.start(256, 2, 44100));
+
+    std::vector<float> buffer(256 * 2);
+    streamer.seekg(10000 * 2 * sizeof(float), std::ios_base::beg);
+
+    // Silence while pending, then the play head is caught up
+    for (int i = 0; i < 1000 && !streamer.isBuffered(buffer.size()); i++) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    streamer.read((char*) buffer.data(), buffer.size() * sizeof(float));
+    for (int i = 0; i < 1000 && !streamer.isBuffered(buffer.size()); i++) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    streamer.read((char*) buffer.data(), buffer.size() * sizeof(float));
+    EXPECT_NEAR(buffer[0] * 32768.0f, 10000.0f, 256.0f * 2);
+    streamer.stop();
+}
+
+// Test a stream can be destroyed as soon as it is out of the pool, while
+// the workers keep scanning the other slots (run under ASan to be sure)
+TEST_F(DecoderPoolTest, DestroyedRightAfterRemove) {
+    DecoderPool pool(4);
+    AudioFstream file(testFile.string());
+
+    for (int i = 0; i < 200; i++) {
+        std::unique_ptr<AudioStreamer> streamer(new AudioStreamer(file));
+        streamer->setPool(&pool);
+        ASSERT_TRUE(streamer->start(64, 2, 44100, 2));
+        streamer->stop();
+    }
+}
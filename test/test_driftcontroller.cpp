@@ -0,0 +1,87 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "driftcontroller.h"
+
+// Test no error keeps nominal speed
+TEST(DriftControllerTest, NoErrorNominalRate) {
+    DriftController controller;
+
+    EXPECT_DOUBLE_EQ(controller.getRate(), 1.0);
+    EXPECT_DOUBLE_EQ(controller.update(0.0, 10.0), 1.0);
+}
+
+// Test errors inside the deadband are ignored
+TEST(DriftControllerTest, DeadbandIgnored) {
+    DriftController controller(0.5, 0.005, 1.0, 250.0);
+
+    EXPECT_DOUBLE_EQ(controller.update(0.8, 10.0), 1.0);
+    EXPECT_DOUBLE_EQ(controller.update(-0.8, 10.0), 1.0);
+}
+
+// Test being ahead slows down and being behind speeds up
+TEST(DriftControllerTest, CorrectionDirection) {
+    DriftController ahead;
+    EXPECT_LT(ahead.update(5.0, 10.0), 1.0);
+
+    DriftController behind;
+    EXPECT_GT(behind.update(-5.0, 10.0), 1.0);
+}
+
+// Test the rate never leaves the allowed deviation
+TEST(DriftControllerTest, RateClamped) {
+    DriftController controller(0.5, 0.005, 1.0, 250.0);
+
+    EXPECT_DOUBLE_EQ(controller.update(1000.0, 10.0), 0.995);
+    controller.reset();
+    EXPECT_DOUBLE_EQ(controller.update(-1000.0, 10.0), 1.005);
+}
+
+// Test jitter is smoothed by the error filter
+TEST(DriftControllerTest, JitterFiltered) {
+    DriftController controller(0.5, 0.005, 0.0, 250.0);
+
+    controller.update(0.0, 10.0);
+    for (int i = 0; i < 100; i++) {
+        controller.update((i % 2) ? 10.0 : -10.0, 10.0);
+    }
+
+    EXPECT_LT(std::abs(controller.getFilteredErrorMs()), 1.0);
+}
+
+// Test a simulated drifting clock is pulled in
+TEST(DriftControllerTest, ConvergesOnDrift) {
+    DriftController controller;
+
+    // Play head starts 20 ms ahead of the master clock
+    double errorMs = 20.0;
+    const double periodMs = 10.0;
+
+    for (int i = 0; i < 3000; i++) {
+        double rate = controller.update(errorMs, periodMs);
+        errorMs += (rate - 1.0) * periodMs;
+    }
+
+    EXPECT_LT(std::abs(errorMs), VARISPEED_DEADBAND_MS + 0.5);
+}
@@ -0,0 +1,263 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+#include "gainstage.h"
+
+// Interleaved buffer where sample = frame * channels + channel + 1
+static std::vector<float> rampBuffer( unsigned int frames, unsigned int channels ) {
+    std::vector<float> buffer( frames * channels );
+    for (size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = (float) (i + 1);
+    }
+    return buffer;
+}
+
+// Test unity gain leaves the buffer untouched
+TEST(GainStageTest, UnityIsTransparent) {
+    GainStage gain;
+    std::vector<float> buffer = rampBuffer(100, 2);
+    std::vector<float> original = buffer;
+
+    gain.process(buffer.data(), 100, 2);
+    EXPECT_EQ(buffer, original);
+    EXPECT_NE(std::string(GainStage::getKernelName()), "");
+}
+
+// Test constant per channel gains match the plain modulo loop, for channel
+// counts that do and do not fill a vector and frame counts with a tail
+TEST(GainStageTest, ConstantGainsMatchReference) {
+    for (unsigned int channels : {1u, 2u, 3u, 6u, 8u, 13u}) {
+        for (unsigned int frames : {1u, 7u, 8u, 64u, 509u}) {
+            GainStage gain;
+            std::vector<float> gains(channels);
+            for (unsigned int c = 0; c < channels; c++) {
+                gains[c] = 0.1f * (c + 1);
+                gain.setGain(c, gains[c]);
+            }
+
+            // First period ramps from unity, the second one is constant
+            std::vector<float> buffer = rampBuffer(frames, channels);
+            gain.process(buffer.data(), frames, channels);
+
+            buffer = rampBuffer(frames, channels);
+            std::vector<float> expected = buffer;
+            for (size_t i = 0; i < expected.size(); i++) {
+                expected[i] *= gains[i % channels];
+            }
+
+            gain.process(buffer.data(), frames, channels);
+            for (size_t i = 0; i < buffer.size(); i++) {
+                ASSERT_FLOAT_EQ(buffer[i], expected[i]) << channels << " ch, " << frames << " frames, sample " << i;
+            }
+        }
+    }
+}
+
+// Test a linear ramp moves by equal steps and lands on the new gain
+TEST(GainStageTest, LinearRamp) {
+    const unsigned int frames = 100;
+    const unsigned int channels = 3;
+    GainStage gain;
+    gain.setGain(1, 0.0f);
+
+    std::vector<float> buffer(frames * channels, 1.0f);
+    gain.process(buffer.data(), frames, channels);
+
+    for (unsigned int f = 0; f < frames; f++) {
+        EXPECT_FLOAT_EQ(buffer[f * channels], 1.0f);
+        EXPECT_NEAR(buffer[f * channels + 1], 1.0f - (f + 1) / (float) frames, 1e-5);
+        EXPECT_FLOAT_EQ(buffer[f * channels + 2], 1.0f);
+    }
+    EXPECT_NEAR(buffer[(frames - 1) * channels + 1], 0.0f, 1e-5);
+
+    // Next period holds the new gain
+    std::fill(buffer.begin(), buffer.end(), 1.0f);
+    gain.process(buffer.data(), frames, channels);
+    for (unsigned int f = 0; f < frames; f++) {
+        EXPECT_FLOAT_EQ(buffer[f * channels + 1], 0.0f);
+    }
+}
+
+// Test an exponential ramp falls by a constant ratio per frame and ends
+// on the new gain
+TEST(GainStageTest, ExponentialRamp) {
+    const unsigned int frames = 256;
+    const unsigned int channels = 2;
+    GainStage gain;
+    gain.setRamp(GainStage::RAMP_EXPONENTIAL);
+    gain.setAllGains(0.01f);
+
+    std::vector<float> buffer(frames * channels, 1.0f);
+    gain.process(buffer.data(), frames, channels);
+
+    float ratio = std::pow(0.01f, 1.0f / frames);
+    for (unsigned int c = 0; c < channels; c++) {
+        for (unsigned int f = 1; f < frames; f++) {
+            EXPECT_NEAR(buffer[f * channels + c] / buffer[(f - 1) * channels + c], ratio, 1e-4);
+        }
+        EXPECT_NEAR(buffer[(frames - 1) * channels + c], 0.01f, 1e-4);
+    }
+}
+
+// Test exponential ramps to and from silence go through the floor and
+// land on the exact gain
+TEST(GainStageTest, ExponentialRampToSilence) {
+    const unsigned int frames = 64;
+    GainStage gain;
+    gain.setRamp(GainStage::RAMP_EXPONENTIAL);
+    gain.setGain(0, 0.0f);
+
+    std::vector<float> buffer(frames, 1.0f);
+    gain.process(buffer.data(), frames, 1);
+    for (unsigned int f = 1; f < frames; f++) {
+        EXPECT_LT(buffer[f], buffer[f - 1]);
+    }
+    EXPECT_LT(buffer[frames - 2], 2 * GAIN_RAMP_FLOOR);
+    EXPECT_EQ(buffer[frames - 1], 0.0f);
+
+    std::fill(buffer.begin(), buffer.end(), 1.0f);
+    gain.process(buffer.data(), frames, 1);
+    EXPECT_EQ(buffer[0], 0.0f);
+
+    gain.setGain(0, 1.0f);
+    std::fill(buffer.begin(), buffer.end(), 1.0f);
+    gain.process(buffer.data(), frames, 1);
+    EXPECT_GT(buffer[0], 0.0f);
+    EXPECT_NEAR(buffer[frames - 1], 1.0f, 1e-4);
+}
+
+// Test gains out of range are ignored and oversized buffers left alone
+TEST(GainStageTest, Limits) {
+    GainStage gain;
+    gain.setGain(GAIN_MAX_CHANNELS, 0.5f);
+    EXPECT_EQ(gain.getGain(GAIN_MAX_CHANNELS), 0.0f);
+    EXPECT_EQ(gain.getGain(0), 1.0f);
+
+    gain.setAllGains(0.5f);
+    std::vector<float> buffer = rampBuffer(4, GAIN_MAX_CHANNELS + 1);
+    std::vector<float> original = buffer;
+    gain.process(buffer.data(), 4, GAIN_MAX_CHANNELS + 1);
+    EXPECT_EQ(buffer, original);
+}
+
+// Runs a fade over several buffers of ones, returns the gain of every frame
+static std::vector<float> runFade( GainStage& gain, unsigned int frames, unsigned int period ) {
+    std::vector<float> gains;
+    std::vector<float> buffer(period);
+    while (gains.size() < frames) {
+        std::fill(buffer.begin(), buffer.end(), 1.0f);
+        gain.process(buffer.data(), period, 1);
+        gains.insert(gains.end(), buffer.begin(), buffer.end());
+    }
+    return gains;
+}
+
+// Test a linear fade spans buffers and lands on its gain on the exact frame
+TEST(GainStageTest, LinearFade) {
+    GainStage gain;
+    gain.fade(0, 0.0f, 1000);
+    std::vector<float> gains = runFade(gain, 1536, 512);
+
+    for (unsigned int f = 0; f < 1000; f++) {
+        ASSERT_NEAR(gains[f], 1.0f - (f + 1) / 1000.0f, 1e-4) << "frame " << f;
+    }
+    for (unsigned int f = 999; f < gains.size(); f++) {
+        ASSERT_FLOAT_EQ(gains[f], 0.0f) << "frame " << f;
+    }
+    EXPECT_EQ(gain.getGain(0), 0.0f);
+}
+
+// Test equal power fades keep the quarter sine shape both ways
+TEST(GainStageTest, EqualPowerFade) {
+    GainStage gain;
+    gain.fade(0, 0.0f, 1024, GainStage::CURVE_EQUAL_POWER);
+    std::vector<float> gains = runFade(gain, 1024, 256);
+    EXPECT_NEAR(gains[511], std::cos(M_PI / 4), 1e-3);
+    EXPECT_FLOAT_EQ(gains[1023], 0.0f);
+
+    gain.fade(0, 1.0f, 1024, GainStage::CURVE_EQUAL_POWER);
+    gains = runFade(gain, 1024, 256);
+    EXPECT_NEAR(gains[511], std::sin(M_PI / 4), 1e-3);
+    EXPECT_NEAR(gains[255], std::sin(M_PI / 8), 1e-3);
+    EXPECT_FLOAT_EQ(gains[1023], 1.0f);
+}
+
+// Test logarithmic fades go by equal steps in dB
+TEST(GainStageTest, LogarithmicFade) {
+    GainStage gain;
+    gain.fade(0, 0.01f, 2048, GainStage::CURVE_LOGARITHMIC);
+    std::vector<float> gains = runFade(gain, 2048, 512);
+
+    EXPECT_NEAR(gains[1023], 0.1f, 1e-3);
+    EXPECT_NEAR(gains[511], std::pow(0.01f, 0.25f), 1e-3);
+    EXPECT_FLOAT_EQ(gains[2047], 0.01f);
+    for (unsigned int f = 1; f < gains.size(); f++) {
+        ASSERT_LT(gains[f], gains[f - 1]);
+    }
+}
+
+// Test fades on several channels end on their own frames
+TEST(GainStageTest, PerChannelFades) {
+    const unsigned int channels = 2;
+    const unsigned int frames = 512;
+    GainStage gain;
+    gain.fade(0, 0.0f, 100);
+    gain.fade(1, 0.5f, 300);
+
+    std::vector<float> buffer(frames * channels, 1.0f);
+    gain.process(buffer.data(), frames, channels);
+
+    EXPECT_NEAR(buffer[49 * channels], 0.5f, 1e-4);
+    EXPECT_FLOAT_EQ(buffer[99 * channels], 0.0f);
+    EXPECT_FLOAT_EQ(buffer[100 * channels], 0.0f);
+    EXPECT_NEAR(buffer[149 * channels + 1], 0.75f, 1e-4);
+    EXPECT_FLOAT_EQ(buffer[299 * channels + 1], 0.5f);
+    EXPECT_FLOAT_EQ(buffer[511 * channels + 1], 0.5f);
+}
+
+// Test a new gain takes over a fade from where it got to
+TEST(GainStageTest, FadeInterrupted) {
+    GainStage gain;
+    gain.fade(0, 0.0f, 1000);
+    std::vector<float> gains = runFade(gain, 500, 500);
+    EXPECT_NEAR(gains[499], 0.5f, 1e-4);
+
+    gain.setGain(0, 1.0f);
+    gains = runFade(gain, 500, 500);
+    EXPECT_NEAR(gains[0], 0.501f, 1e-4);
+    EXPECT_FLOAT_EQ(gains[499], 1.0f);
+
+    gains = runFade(gain, 500, 500);
+    EXPECT_FLOAT_EQ(gains[0], 1.0f);
+    EXPECT_FLOAT_EQ(gains[499], 1.0f);
+}
+
+// Test curve names
+TEST(GainStageTest, ParseCurve) {
+    EXPECT_EQ(GainStage::parseCurve("linear"), GainStage::CURVE_LINEAR);
+    EXPECT_EQ(GainStage::parseCurve("equalpower"), GainStage::CURVE_EQUAL_POWER);
+    EXPECT_EQ(GainStage::parseCurve("log"), GainStage::CURVE_LOGARITHMIC);
+    EXPECT_THROW(GainStage::parseCurve("cubic"), std::invalid_argument);
+}
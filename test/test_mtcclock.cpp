@@ -0,0 +1,137 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "mtcclock.h"
+
+namespace {
+
+// Standard deviation of a series
+double deviation(const std::vector<double>& values) {
+    double mean = 0.0;
+    for (double v : values) mean += v;
+    mean /= values.size();
+
+    double var = 0.0;
+    for (double v : values) var += (v - mean) * (v - mean);
+    return std::sqrt(var / values.size());
+}
+
+// Simulates 25 fps quarter frames with arrival jitter, sampled once
+// per 256 frame period at 48 kHz. Returns the raw and smoothed errors
+// against the true timeline, and the speed estimates.
+void simulate(MtcClock& clock, double speed, int periods,
+              std::vector<double>& rawErrors, std::vector<double>& pllErrors,
+              std::vector<double>& speeds) {
+    const double msPerFrame = 1000.0 / 48000;
+    const int period = 256;
+    unsigned int seed = 12345;
+    long rawHead = 0;
+    double nextQuarterMs = 0.0;
+    double arrivalMs = 0.0;
+
+    clock.setSampleRate(48000);
+
+    for (int p = 0; p < periods; p++) {
+        long long sampleTime = (long long) p * period;
+        double nowMs = sampleTime * msPerFrame;
+        double trueMs = nowMs * speed;
+
+        // Deliver every quarter frame whose (jittered) arrival has passed
+        while (arrivalMs <= nowMs) {
+            rawHead = (long) nextQuarterMs;
+            nextQuarterMs += 10.0;
+            seed = seed * 1103515245 + 12345;
+            double jitter = ((seed >> 16) % 800) / 100.0;    // 0 to 8 ms
+            arrivalMs = nextQuarterMs / speed + jitter;
+        }
+
+        clock.update(rawHead, sampleTime);
+
+        if (p > periods / 2) {
+            rawErrors.push_back(rawHead - trueMs);
+            pllErrors.push_back(clock.positionMs(sampleTime) - trueMs);
+            speeds.push_back(clock.getSpeed());
+        }
+    }
+}
+
+}
+
+// Test the first update seeds the estimate
+TEST(MtcClockTest, FirstUpdateSeeds) {
+    MtcClock clock;
+    clock.setSampleRate(48000);
+    clock.update(5000, 0);
+
+    EXPECT_DOUBLE_EQ(clock.positionMs(0), 5000.0);
+    EXPECT_NEAR(clock.positionMs(48000), 6000.0, 1e-9);
+    EXPECT_FALSE(clock.isLocked());
+}
+
+// Test jittery arrivals give a smoother timeline than the raw head
+TEST(MtcClockTest, SmoothsJitter) {
+    MtcClock clock;
+    std::vector<double> rawErrors, pllErrors, speeds;
+    simulate(clock, 1.0, 4000, rawErrors, pllErrors, speeds);
+
+    EXPECT_TRUE(clock.isLocked());
+    EXPECT_LT(deviation(pllErrors), deviation(rawErrors) / 2);
+}
+
+// Test the speed estimate follows a master running off nominal rate
+TEST(MtcClockTest, TracksSpeed) {
+    MtcClock clock;
+    std::vector<double> rawErrors, pllErrors, speeds;
+    simulate(clock, 1.001, 8000, rawErrors, pllErrors, speeds);
+
+    double meanSpeed = 0.0;
+    for (double v : speeds) meanSpeed += v;
+    meanSpeed /= speeds.size();
+
+    EXPECT_NEAR(meanSpeed, 1.001, 0.0005);
+    EXPECT_NEAR(clock.getSpeed(), 1.001, 0.005);
+}
+
+// Test a timecode jump relocks on the new position
+TEST(MtcClockTest, JumpRelocks) {
+    MtcClock clock;
+    clock.setSampleRate(48000);
+    clock.update(1000, 0);
+    clock.update(1010, 480);
+
+    clock.update(60000, 960);
+    EXPECT_DOUBLE_EQ(clock.positionMs(960), 60000.0);
+    EXPECT_FALSE(clock.isLocked());
+}
+
+// Test reset forgets the previous estimate
+TEST(MtcClockTest, Reset) {
+    MtcClock clock;
+    clock.update(1000, 0);
+    clock.reset();
+    clock.update(2000, 100);
+
+    EXPECT_DOUBLE_EQ(clock.positionMs(100), 2000.0);
+}
@@ -0,0 +1,129 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include "pcmcache.h"
+
+namespace fs = std::filesystem;
+
+class PcmCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cacheDir = fs::temp_directory_path() / "test_pcmcache";
+        fs::remove_all(cacheDir);
+        mediaFile = fs::temp_directory_path() / "test_pcmcache_media.bin";
+        std::ofstream(mediaFile) << "media";
+    }
+
+    void TearDown() override {
+        fs::remove_all(cacheDir);
+        fs::remove(mediaFile);
+    }
+
+    fs::path cacheDir;
+    fs::path mediaFile;
+};
+
+// Test the key follows the file and the rendering settings
+TEST_F(PcmCacheTest, KeyChanges) {
+    std::string key = PcmCache::keyFor(mediaFile.string(), 48000, 2, "hq");
+    ASSERT_FALSE(key.empty());
+    EXPECT_EQ(key, PcmCache::keyFor(mediaFile.string(), 48000, 2, "hq"));
+    EXPECT_EQ(key.rfind("test_pcmcache_media-", 0), 0u);
+
+    EXPECT_NE(key, PcmCache::keyFor(mediaFile.string(), 44100, 2, "hq"));
+    EXPECT_NE(key, PcmCache::keyFor(mediaFile.string(), 48000, 1, "hq"));
+    EXPECT_NE(key, PcmCache::keyFor(mediaFile.string(), 48000, 2, "vhq"));
+
+    // Same size, new contents and mtime
+    fs::last_write_time(mediaFile, fs::last_write_time(mediaFile) + std::chrono::seconds(10));
+    EXPECT_NE(key, PcmCache::keyFor(mediaFile.string(), 48000, 2, "hq"));
+
+    EXPECT_TRUE(PcmCache::keyFor("/nonexistent/file.wav", 48000, 2, "hq").empty());
+}
+
+// Test a written rendition maps back with the same samples
+TEST_F(PcmCacheTest, WriteAndMap) {
+    std::string path = PcmCache::pathFor(cacheDir.string(), "roundtrip");
+    std::vector<float> samples(3000);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = i * 0.001f;
+
+    PcmCache::Writer writer;
+    ASSERT_TRUE(writer.open(path, 2, 48000));
+    ASSERT_TRUE(writer.write(samples.data(), 1000));
+    ASSERT_TRUE(writer.write(samples.data() + 1000, 2000));
+    EXPECT_FALSE(fs::exists(path));         // Not visible before commit
+    ASSERT_TRUE(writer.commit());
+    EXPECT_EQ(fs::file_size(path), (uintmax_t) (PCM_CACHE_HEADER_SIZE + 3000 * sizeof(float)));
+
+    PcmCache::Mapping mapping;
+    ASSERT_TRUE(mapping.open(path, 2, 48000));
+    ASSERT_EQ(mapping.floats(), 3000u);
+    for (size_t i = 0; i < samples.size(); i++) {
+        ASSERT_FLOAT_EQ(mapping.data()[i], samples[i]);
+    }
+
+    mapping.close();
+    EXPECT_FALSE(mapping.isOpen());
+    EXPECT_EQ(mapping.data(), nullptr);
+}
+
+// Test renditions of another format or truncated files are refused
+TEST_F(PcmCacheTest, RejectsMismatches) {
+    std::string path = PcmCache::pathFor(cacheDir.string(), "mismatch");
+    float samples[64] = {0};
+
+    PcmCache::Writer writer;
+    ASSERT_TRUE(writer.open(path, 2, 48000));
+    ASSERT_TRUE(writer.write(samples, 64));
+    ASSERT_TRUE(writer.commit());
+
+    PcmCache::Mapping mapping;
+    EXPECT_FALSE(mapping.open(path, 2, 44100));
+    EXPECT_FALSE(mapping.open(path, 1, 48000));
+    EXPECT_FALSE(mapping.open(path + ".missing", 2, 48000));
+
+    fs::resize_file(path, fs::file_size(path) - 4);
+    EXPECT_FALSE(mapping.open(path, 2, 48000));
+}
+
+// Test aborted or unfinished renditions leave nothing behind
+TEST_F(PcmCacheTest, AbortLeavesNothing) {
+    std::string path = PcmCache::pathFor(cacheDir.string(), "aborted");
+    float samples[64] = {0};
+    {
+        PcmCache::Writer writer;
+        ASSERT_TRUE(writer.open(path, 2, 48000));
+        writer.write(samples, 64);
+    }
+    {
+        PcmCache::Writer writer;
+        ASSERT_TRUE(writer.open(path, 2, 48000));
+        writer.write(samples, 63);          // Not whole frames
+        EXPECT_FALSE(writer.commit());
+    }
+    EXPECT_TRUE(fs::is_empty(cacheDir));
+}
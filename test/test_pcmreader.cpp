@@ -0,0 +1,355 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "pcmreader.h"
+
+namespace fs = std::filesystem;
+
+// Little and big endian writers for building headers
+static void putLe(std::string& s, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) s += (char) (v >> (8 * i));
+}
+static void putBe(std::string& s, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) s += (char) (v >> (8 * i));
+}
+
+// Integer ramp, a distinct value for each sample
+static std::vector<int32_t> ramp(size_t samples, int bits) {
+    std::vector<int32_t> values(samples);
+    int32_t max = (int32_t) ((1LL << (bits - 1)) - 1);
+    for (size_t i = 0; i < samples; i++) {
+        values[i] = (int32_t) ((int64_t) (i * 7919) % (2LL * max) - max);
+    }
+    return values;
+}
+
+static std::string samplesLe(const std::vector<int32_t>& values, int bits) {
+    std::string s;
+    for (int32_t v : values) putLe(s, (uint32_t) v, bits / 8);
+    return s;
+}
+
+static std::string samplesBe(const std::vector<int32_t>& values, int bits) {
+    std::string s;
+    for (int32_t v : values) putBe(s, (uint32_t) v, bits / 8);
+    return s;
+}
+
+static std::string fmtChunk(unsigned int tag, unsigned int channels, unsigned int rate, unsigned int bits) {
+    std::string s;
+    putLe(s, tag, 2);
+    putLe(s, channels, 2);
+    putLe(s, rate, 4);
+    putLe(s, rate * channels * bits / 8, 4);
+    putLe(s, channels * bits / 8, 2);
+    putLe(s, bits, 2);
+    return s;
+}
+
+static std::string wavFile(unsigned int tag, unsigned int channels, unsigned int rate,
+                           unsigned int bits, const std::string& data) {
+    std::string fmt = fmtChunk(tag, channels, rate, bits);
+    std::string s = "RIFF";
+    putLe(s, 4 + 8 + fmt.size() + 8 + 4 + 8 + data.size(), 4);
+    s += "WAVE";
+    // A chunk to skip, odd sized to check the padding
+    s += "LIST";
+    putLe(s, 3, 4);
+    s += std::string("abc\0", 4);
+    s += "fmt ";
+    putLe(s, fmt.size(), 4);
+    s += fmt;
+    s += "data";
+    putLe(s, data.size(), 4);
+    return s + data;
+}
+
+class PcmReaderTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        fs::remove(path);
+    }
+
+    void write(const std::string& contents) {
+        std::ofstream(path, std::ios::binary) << contents;
+    }
+
+    // Reads the whole file and checks it against integer samples
+    void expectSamples(PcmReader& reader, const std::vector<int32_t>& values, int bits) {
+        std::vector<float> out(values.size() + reader.getChannels());
+        size_t frames = reader.read(out.data(), out.size() / reader.getChannels());
+        ASSERT_EQ(frames * reader.getChannels(), values.size());
+        float scale = 1.0f / (float) (1LL << (bits - 1));
+        for (size_t i = 0; i < values.size(); i++) {
+            ASSERT_FLOAT_EQ(out[i], values[i] * scale) << "sample " << i;
+        }
+    }
+
+    fs::path path = fs::temp_directory_path() / "test_pcmreader.audio";
+};
+
+// Test 16 bit WAV is read with its format and every sample
+TEST_F(PcmReaderTest, Wav16) {
+    auto values = ramp(2 * 1001, 16);
+    write(wavFile(1, 2, 44100, 16, samplesLe(values, 16)));
+
+    PcmReader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getChannels(), 2u);
+    EXPECT_EQ(reader.getSampleRate(), 44100u);
+    EXPECT_EQ(reader.getFrames(), 1001);
+    EXPECT_STREQ(reader.getFormatName(), "s16le");
+    expectSamples(reader, values, 16);
+    EXPECT_EQ(reader.read(nullptr, 10), 0u);    // At the end
+}
+
+// Test 24 and 32 bit integer WAV
+TEST_F(PcmReaderTest, Wav24And32) {
+    auto values24 = ramp(6 * 333, 24);
+    write(wavFile(1, 6, 48000, 24, samplesLe(values24, 24)));
+    PcmReader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getEncoding(), PcmReader::INT24_LE);
+    expectSamples(reader, values24, 24);
+
+    auto values32 = ramp(3 * 257, 32);
+    write(wavFile(1, 3, 96000, 32, samplesLe(values32, 32)));
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getEncoding(), PcmReader::INT32_LE);
+    EXPECT_EQ(reader.getSampleRate(), 96000u);
+    expectSamples(reader, values32, 32);
+}
+
+// Test float WAV, plain and WAVE_FORMAT_EXTENSIBLE
+TEST_F(PcmReaderTest, WavFloatAndExtensible) {
+    std::vector<float> samples(2 * 100);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = std::sin(i * 0.1f);
+    std::string data((const char*) samples.data(), samples.size() * sizeof(float));
+
+    write(wavFile(3, 2, 48000, 32, data));
+    PcmReader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getEncoding(), PcmReader::FLOAT32_LE);
+    std::vector<float> out(samples.size());
+    ASSERT_EQ(reader.read(out.data(), 100), 100u);
+    EXPECT_EQ(out, samples);
+
+    // Extensible: cbSize, valid bits, channel mask and the sub format GUID
+    std::string fmt = fmtChunk(0xFFFE, 2, 48000, 32);
+    putLe(fmt, 22, 2);
+    putLe(fmt, 32, 2);
+    putLe(fmt, 3, 4);
+    putLe(fmt, 3, 2);
+    fmt += std::string("\x00\x00\x00\x00\x10\x00\x80\x00\x00\xAA\x00\x38\x9B\x71", 14);
+    std::string file = "RIFF";
+    putLe(file, 4 + 8 + fmt.size() + 8 + data.size(), 4);
+    file += "WAVEfmt ";
+    putLe(file, fmt.size(), 4);
+    file += fmt + "data";
+    putLe(file, data.size(), 4);
+    write(file + data);
+
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getEncoding(), PcmReader::FLOAT32_LE);
+    ASSERT_EQ(reader.read(out.data(), 100), 100u);
+    EXPECT_EQ(out, samples);
+}
+
+// Test RF64 takes the data size from ds64, and Wave64
+TEST_F(PcmReaderTest, Rf64AndWave64) {
+    auto values = ramp(2 * 500, 16);
+    std::string data = samplesLe(values, 16);
+    std::string fmt = fmtChunk(1, 2, 48000, 16);
+
+    std::string rf64 = "RF64";
+    putLe(rf64, 0xFFFFFFFF, 4);
+    rf64 += "WAVEds64";
+    putLe(rf64, 28, 4);
+    putLe(rf64, 0, 8);                      // RIFF size
+    putLe(rf64, data.size(), 8);            // data size
+    putLe(rf64, 500, 8);                    // sample count
+    putLe(rf64, 0, 4);                      // table length
+    rf64 += "fmt ";
+    putLe(rf64, fmt.size(), 4);
+    rf64 += fmt + "data";
+    putLe(rf64, 0xFFFFFFFF, 4);
+    write(rf64 + data + "trailing");        // Only ds64 tells where data ends
+
+    PcmReader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getFrames(), 500);
+    expectSamples(reader, values, 16);
+
+    const unsigned char riffGuid[16] = { 'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11,
+                                         0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00 };
+    const unsigned char tail[12] = { 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+    auto guid = [&](const char* name) { return std::string(name, 4) + std::string((const char*) tail, 12); };
+
+    std::string w64((const char*) riffGuid, 16);
+    putLe(w64, 0, 8);
+    w64 += guid("wave") + guid("fmt ");
+    putLe(w64, 24 + fmt.size(), 8);
+    w64 += fmt;                             // 16 bytes, already aligned to 8
+    w64 += guid("data");
+    putLe(w64, 24 + data.size(), 8);
+    write(w64 + data);
+
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getFrames(), 500);
+    expectSamples(reader, values, 16);
+}
+
+// Test AIFF (big endian) and AIFF-C with byte swapped samples
+TEST_F(PcmReaderTest, AiffAndAifc) {
+    auto values = ramp(2 * 300, 24);
+    // 44100 Hz as an 80 bit extended
+    const std::string rate("\x40\x0E\xAC\x44\x00\x00\x00\x00\x00\x00", 10);
+
+    auto aiff = [&](bool aifc, const char* compression, const std::string& data) {
+        std::string comm;
+        putBe(comm, 2, 2);
+        putBe(comm, 300, 4);
+        putBe(comm, 24, 2);
+        comm += rate;
+        if (aifc) comm += std::string(compression, 4) + std::string("\0", 2);
+        std::string s = "FORM";
+        putBe(s, 4 + 8 + comm.size() + 8 + 8 + data.size(), 4);
+        s += aifc ? "AIFC" : "AIFF";
+        s += "COMM";
+        putBe(s, comm.size(), 4);
+        s += comm + "SSND";
+        putBe(s, 8 + data.size(), 4);
+        putBe(s, 0, 8);                     // offset and block size
+        return s + data;
+    };
+
+    write(aiff(false, nullptr, samplesBe(values, 24)));
+    PcmReader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getSampleRate(), 44100u);
+    EXPECT_EQ(reader.getFrames(), 300);
+    EXPECT_EQ(reader.getEncoding(), PcmReader::INT24_BE);
+    expectSamples(reader, values, 24);
+
+    write(aiff(true, "sowt", samplesLe(values, 24)));
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getEncoding(), PcmReader::INT24_LE);
+    expectSamples(reader, values, 24);
+
+    // Compressed AIFF-C is left to FFmpeg
+    write(aiff(true, "ima4", samplesLe(values, 24)));
+    EXPECT_FALSE(reader.open(path.string()));
+}
+
+// Test seeks land on the exact frame and clamp to the end
+TEST_F(PcmReaderTest, Seek) {
+    auto values = ramp(2 * 1000, 16);
+    write(wavFile(1, 2, 48000, 16, samplesLe(values, 16)));
+
+    PcmReader reader;
+    ASSERT_TRUE(reader.open(path.string()));
+    reader.seek(777);
+    EXPECT_EQ(reader.tell(), 777);
+    float out[4];
+    ASSERT_EQ(reader.read(out, 2), 2u);
+    EXPECT_FLOAT_EQ(out[0], values[2 * 777] / 32768.0f);
+    EXPECT_FLOAT_EQ(out[3], values[2 * 778 + 1] / 32768.0f);
+    EXPECT_EQ(reader.tell(), 779);
+
+    reader.seek(5000);
+    EXPECT_EQ(reader.tell(), 1000);
+    EXPECT_EQ(reader.read(out, 2), 0u);
+    reader.seek(-3);
+    EXPECT_EQ(reader.tell(), 0);
+}
+
+// Test what the reader can't play is refused, and short data is cut
+TEST_F(PcmReaderTest, RefusedAndTruncated) {
+    PcmReader reader;
+    EXPECT_FALSE(reader.open("/nonexistent/file.wav"));
+
+    write(wavFile(1, 2, 48000, 8, std::string(100, '\x80')));     // 8 bit
+    EXPECT_FALSE(reader.open(path.string()));
+    write(wavFile(2, 2, 48000, 16, std::string(100, '\0')));       // ADPCM
+    EXPECT_FALSE(reader.open(path.string()));
+    write("ID3 not a wave file at all");
+    EXPECT_FALSE(reader.open(path.string()));
+    EXPECT_FALSE(reader.isOpen());
+
+    // data chunk claims more than the file holds, half a frame at the end
+    auto values = ramp(2 * 100, 16);
+    std::string file = wavFile(1, 2, 48000, 16, samplesLe(values, 16) + "xx");
+    write(file.substr(0, file.size() - 2 - 40 * 4 - 2));
+    ASSERT_TRUE(reader.open(path.string()));
+    EXPECT_EQ(reader.getFrames(), 59);
+}
+
+// Test every kernel against the scalar reference, tails included
+TEST_F(PcmReaderTest, KernelsMatchReference) {
+    std::mt19937 random(42);
+    std::vector<unsigned char> bytes(4 * 1037 + 64);
+    for (auto& b : bytes) b = (unsigned char) random();
+
+    const PcmReader::Encoding encodings[] = { PcmReader::INT16_LE, PcmReader::INT16_BE,
+                                              PcmReader::INT24_LE, PcmReader::INT24_BE,
+                                              PcmReader::INT32_LE, PcmReader::INT32_BE,
+                                              PcmReader::FLOAT32_LE, PcmReader::FLOAT32_BE };
+    for (auto encoding : encodings) {
+        unsigned int size = PcmReader::bytesPerSample(encoding);
+        bool bigEndian = encoding == PcmReader::INT16_BE || encoding == PcmReader::INT24_BE ||
+                         encoding == PcmReader::INT32_BE || encoding == PcmReader::FLOAT32_BE;
+        bool isFloat = encoding == PcmReader::FLOAT32_LE || encoding == PcmReader::FLOAT32_BE;
+
+        for (size_t samples : { 0, 1, 5, 7, 9, 16, 31, 1037 }) {
+            std::vector<float> out(samples + 1, -9.0f);
+            PcmReader::convert(bytes.data(), out.data(), samples, encoding);
+            for (size_t i = 0; i < samples; i++) {
+                uint32_t raw = 0;
+                for (unsigned int b = 0; b < size; b++) {
+                    unsigned int shift = bigEndian ? 8 * (size - 1 - b) : 8 * b;
+                    raw |= (uint32_t) bytes[i * size + b] << shift;
+                }
+                float expected;
+                if (isFloat) {
+                    memcpy(&expected, &raw, 4);
+                } else {
+                    int32_t value = (int32_t) (raw << (32 - 8 * size)) >> (32 - 8 * size);
+                    expected = value / (float) (1LL << (8 * size - 1));
+                }
+                if (std::isnan(expected)) {
+                    ASSERT_TRUE(std::isnan(out[i]));
+                } else {
+                    ASSERT_FLOAT_EQ(out[i], expected) << PcmReader::getKernelName() << " encoding "
+                                                      << encoding << " sample " << i << " of " << samples;
+                }
+            }
+            EXPECT_EQ(out[samples], -9.0f);     // Nothing written past the end
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "ringbuffer.h"
+
+// Test capacity is rounded up to a power of two
+TEST(RingBufferTest, CapacityPowerOfTwo) {
+    RingBuffer<float> ring;
+    ring.allocate(1000);
+
+    EXPECT_EQ(ring.size(), 1024u);
+    EXPECT_EQ(ring.readAvailable(), 0u);
+    EXPECT_EQ(ring.writeAvailable(), 1024u);
+}
+
+// Test write then read returns the same data
+TEST(RingBufferTest, WriteRead) {
+    RingBuffer<float> ring;
+    ring.allocate(16);
+
+    float in[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    EXPECT_EQ(ring.write(in, 8), 8u);
+    EXPECT_EQ(ring.readAvailable(), 8u);
+
+    float out[8] = {0};
+    EXPECT_EQ(ring.read(out, 8), 8u);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(out[i], in[i]);
+    }
+    EXPECT_EQ(ring.readAvailable(), 0u);
+}
+
+// Test writes beyond capacity are truncated
+TEST(RingBufferTest, WriteFull) {
+    RingBuffer<float> ring;
+    ring.allocate(8);
+
+    float in[12] = {0};
+    EXPECT_EQ(ring.write(in, 12), 8u);
+    EXPECT_EQ(ring.writeAvailable(), 0u);
+}
+
+// Test data wraps around the end of the storage
+TEST(RingBufferTest, WrapAround) {
+    RingBuffer<int> ring;
+    ring.allocate(8);
+
+    int in[6] = {1, 2, 3, 4, 5, 6};
+    int out[6] = {0};
+    ring.write(in, 6);
+    ring.read(out, 6);
+
+    // Next write crosses the end of the buffer
+    ring.write(in, 6);
+    EXPECT_EQ(ring.read(out, 6), 6u);
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(out[i], in[i]);
+    }
+}
+
+// Test skip and reset
+TEST(RingBufferTest, SkipAndReset) {
+    RingBuffer<int> ring;
+    ring.allocate(8);
+
+    int in[6] = {1, 2, 3, 4, 5, 6};
+    ring.write(in, 6);
+
+    EXPECT_EQ(ring.skip(2), 2u);
+    int out = 0;
+    ring.read(&out, 1);
+    EXPECT_EQ(out, 3);
+
+    ring.reset();
+    EXPECT_EQ(ring.readAvailable(), 0u);
+    EXPECT_EQ(ring.skip(4), 0u);
+}
+
+// Test one producer and one consumer thread see an ordered stream
+TEST(RingBufferTest, ProducerConsumerThreads) {
+    RingBuffer<int> ring;
+    ring.allocate(64);
+
+    const int total = 20000;
+
+    std::thread producer([&ring]() {
+        int next = 0;
+        while (next < total) {
+            int chunk[7];
+            int n = std::min(7, total - next);
+            for (int i = 0; i < n; i++) chunk[i] = next + i;
+            size_t written = ring.write(chunk, n);
+            if (written == 0) std::this_thread::yield();
+            next += (int) written;
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < total) {
+        int chunk[5];
+        size_t n = ring.read(chunk, 5);
+        if (n == 0) std::this_thread::yield();
+        for (size_t i = 0; i < n; i++) {
+            if (chunk[i] != expected++) ordered = false;
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(ordered);
+}
@@ -0,0 +1,184 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "routingmatrix.h"
+
+// Interleaved input where sample = frame * 100 + channel + 1
+static std::vector<float> frameBuffer( unsigned int frames, unsigned int channels ) {
+    std::vector<float> buffer( frames * channels );
+    for (unsigned int f = 0; f < frames; f++) {
+        for (unsigned int c = 0; c < channels; c++) {
+            buffer[f * channels + c] = (float) (f * 100 + c + 1);
+        }
+    }
+    return buffer;
+}
+
+// Test stereo to six outputs goes L R L R L R by default
+TEST(RoutingMatrixTest, DefaultSpreadsInputs) {
+    RoutingMatrix matrix;
+    matrix.setSize(2, 6);
+
+    std::vector<float> in = frameBuffer(16, 2);
+    std::vector<float> out(16 * 6, -1.0f);
+    matrix.route(in.data(), out.data(), 16);
+
+    for (unsigned int f = 0; f < 16; f++) {
+        for (unsigned int o = 0; o < 6; o++) {
+            ASSERT_EQ(out[f * 6 + o], in[f * 2 + o % 2]) << "frame " << f << " output " << o;
+        }
+    }
+}
+
+// Test more inputs than outputs are folded onto them by default
+TEST(RoutingMatrixTest, DefaultFoldsInputs) {
+    RoutingMatrix matrix;
+    matrix.setSize(6, 2);
+
+    std::vector<float> in = frameBuffer(5, 6);
+    std::vector<float> out(5 * 2);
+    matrix.route(in.data(), out.data(), 5);
+
+    for (unsigned int f = 0; f < 5; f++) {
+        EXPECT_EQ(out[f * 2], in[f * 6] + in[f * 6 + 2] + in[f * 6 + 4]);
+        EXPECT_EQ(out[f * 2 + 1], in[f * 6 + 1] + in[f * 6 + 3] + in[f * 6 + 5]);
+    }
+}
+
+// Test the same channel counts pass through untouched
+TEST(RoutingMatrixTest, Identity) {
+    RoutingMatrix matrix;
+    matrix.setSize(3, 3);
+
+    std::vector<float> in = frameBuffer(9, 3);
+    std::vector<float> out(9 * 3);
+    matrix.route(in.data(), out.data(), 9);
+    EXPECT_EQ(out, in);
+}
+
+// Test any matrix against a plain reference, for sizes that do and do
+// not fill vectors, and that nothing is written past the output
+TEST(RoutingMatrixTest, MatchesReference) {
+    for (unsigned int inputs : {1u, 2u, 3u, 6u, 8u}) {
+        for (unsigned int outputs : {1u, 2u, 5u, 6u, 8u, 9u, 13u}) {
+            for (unsigned int frames : {1u, 2u, 7u, 64u}) {
+                RoutingMatrix matrix;
+                matrix.setSize(inputs, outputs);
+                for (unsigned int i = 0; i < inputs; i++) {
+                    for (unsigned int o = 0; o < outputs; o++) {
+                        matrix.setGain(i, o, ( (i + 2 * o) % 3 ) * 0.25f);
+                    }
+                }
+
+                std::vector<float> in = frameBuffer(frames, inputs);
+                std::vector<float> out(frames * outputs + 8, -1.0f);
+                matrix.route(in.data(), out.data(), frames);
+
+                for (unsigned int f = 0; f < frames; f++) {
+                    for (unsigned int o = 0; o < outputs; o++) {
+                        float expected = 0.0f;
+                        for (unsigned int i = 0; i < inputs; i++) {
+                            expected += in[f * inputs + i] * matrix.getGain(i, o);
+                        }
+                        ASSERT_FLOAT_EQ(out[f * outputs + o], expected)
+                            << inputs << " in, " << outputs << " out, frame " << f << " output " << o;
+                    }
+                }
+                for (unsigned int i = frames * outputs; i < out.size(); i++) {
+                    ASSERT_EQ(out[i], -1.0f) << inputs << " in, " << outputs << " out, " << frames << " frames";
+                }
+            }
+        }
+    }
+}
+
+// Test explicit routes replace the default ones
+TEST(RoutingMatrixTest, SetRoutes) {
+    RoutingMatrix matrix;
+    matrix.setSize(2, 4);
+    matrix.setRoutes(RoutingMatrix::parseRoutes("0:0,1:1,0:3:0.5,1:3:0.5"));
+
+    EXPECT_EQ(matrix.getGain(0, 2), 0.0f);
+    EXPECT_EQ(matrix.getGain(1, 3), 0.5f);
+
+    std::vector<float> in = {2.0f, 4.0f};
+    std::vector<float> out(4);
+    matrix.route(in.data(), out.data(), 1);
+    EXPECT_EQ(out, std::vector<float>({2.0f, 4.0f, 0.0f, 3.0f}));
+
+    // Routes out of the matrix are ignored
+    matrix.setGain(2, 0, 1.0f);
+    matrix.setGain(0, 4, 1.0f);
+    EXPECT_EQ(matrix.getGain(2, 0), 0.0f);
+}
+
+// Test route specifications
+TEST(RoutingMatrixTest, ParseRoutes) {
+    std::vector<RoutingMatrix::Route> routes = RoutingMatrix::parseRoutes("0:0,1:5:0.25");
+    ASSERT_EQ(routes.size(), 2u);
+    EXPECT_EQ(routes[0].input, 0u);
+    EXPECT_EQ(routes[0].output, 0u);
+    EXPECT_EQ(routes[0].gain, 1.0f);
+    EXPECT_EQ(routes[1].input, 1u);
+    EXPECT_EQ(routes[1].output, 5u);
+    EXPECT_EQ(routes[1].gain, 0.25f);
+
+    EXPECT_THROW(RoutingMatrix::parseRoutes(""), std::invalid_argument);
+    EXPECT_THROW(RoutingMatrix::parseRoutes("0"), std::invalid_argument);
+    EXPECT_THROW(RoutingMatrix::parseRoutes("0-1"), std::invalid_argument);
+    EXPECT_THROW(RoutingMatrix::parseRoutes("0:1:x"), std::invalid_argument);
+    EXPECT_THROW(RoutingMatrix::parseRoutes("0:1:1:2"), std::invalid_argument);
+    EXPECT_THROW(RoutingMatrix::parseRoutes("0:64"), std::invalid_argument);
+}
+
+// Test the audio thread always sees whole matrices while they are edited
+TEST(RoutingMatrixTest, ConcurrentEdits) {
+    RoutingMatrix matrix;
+    matrix.setSize(1, 8);
+    std::atomic<bool> done{false};
+
+    // Every published matrix has the same gain on all outputs
+    std::thread editor([&]() {
+        for (int n = 0; n < 20000; n++) {
+            std::vector<RoutingMatrix::Route> routes;
+            for (unsigned int o = 0; o < 8; o++) {
+                routes.push_back({0, o, (float) (n % 7)});
+            }
+            matrix.setRoutes(routes);
+        }
+        done = true;
+    });
+
+    std::vector<float> in(32, 1.0f);
+    std::vector<float> out(32 * 8);
+    while (!done) {
+        matrix.route(in.data(), out.data(), 32);
+        for (unsigned int i = 1; i < out.size(); i++) {
+            ASSERT_EQ(out[i], out[0]);
+        }
+    }
+    editor.join();
+}
@@ -0,0 +1,137 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// These tests only do something in builds configured with
+// -DCUEMS_RT_ALLOC_CHECK=ON, otherwise they are skipped.
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "rtallocguard.h"
+#include "ringbuffer.h"
+#include "audiostreamer.h"
+#include "testwav.h"
+
+namespace fs = std::filesystem;
+
+class RtAllocGuardTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!RtAllocGuard::enabled()) {
+            GTEST_SKIP() << "Built without CUEMS_RT_ALLOC_CHECK";
+        }
+        testFile = fs::temp_directory_path() / "test_rtalloc.wav";
+        // One second of 16 bit stereo PCM
+        writeTestWav(testFile, 44100, 2, [](uint32_t frame, uint16_t channel) {
+            return (int32_t)(((frame * 2 + channel) * 37) % 20000);
+        });
+    }
+
+    void TearDown() override {
+        if (fs::exists(testFile)) {
+            fs::remove(testFile);
+        }
+    }
+
+    fs::path testFile;
+};
+
+// Test allocations inside a guard are counted
+TEST_F(RtAllocGuardTest, CountsInsideGuard) {
+    RtAllocGuard::resetCounts();
+    {
+        RtAllocGuard guard;
+        int* value = new int(1);
+        delete value;
+    }
+    EXPECT_GE(RtAllocGuard::getNewCount(), 1u);
+    EXPECT_GE(RtAllocGuard::getAllocationCount(), 1u);
+}
+
+// Test allocations outside a guard are ignored
+TEST_F(RtAllocGuardTest, IgnoresOutsideGuard) {
+    RtAllocGuard::resetCounts();
+    int* value = new int(1);
+    delete value;
+    EXPECT_EQ(RtAllocGuard::getAllocationCount(), 0u);
+}
+
+// Test ring buffer transfers never allocate
+TEST_F(RtAllocGuardTest, RingBufferIsAllocationFree) {
+    RingBuffer<float> ring;
+    ring.allocate(1024);
+    float buffer[256] = {0};
+
+    RtAllocGuard::resetCounts();
+    {
+        RtAllocGuard guard;
+        ring.write(buffer, 256);
+        ring.read(buffer, 256);
+        ring.skip(16);
+    }
+    EXPECT_EQ(RtAllocGuard::getAllocationCount(), 0u);
+}
+
+// Test the streaming consumer path never allocates
+TEST_F(RtAllocGuardTest, StreamerReadIsAllocationFree) {
+    AudioFstream file(testFile.string());
+    AudioStreamer streamer(file);
+    ASSERT_TRUE(streamer.start(256, 2, 44100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    float buffer[512];
+    RtAllocGuard::resetCounts();
+    {
+        RtAllocGuard guard;
+        for (int i = 0; i < 4; i++) {
+            streamer.read((char*) buffer, sizeof(buffer));
+        }
+        streamer.seekg(0, std::ios_base::beg);
+        streamer.read((char*) buffer, sizeof(buffer));
+    }
+    EXPECT_EQ(RtAllocGuard::getAllocationCount(), 0u);
+
+    streamer.stop();
+}
+
+// Test the resampling read path makes no C++ allocations after open.
+// FFmpeg demuxing still mallocs packets, use --streaming to keep that
+// off the audio thread.
+TEST_F(RtAllocGuardTest, ResampleReadMakesNoNewCalls) {
+    AudioFstream stream(testFile.string());
+    ASSERT_TRUE(stream.good());
+    stream.setTargetSampleRate(48000);
+
+    float buffer[1024];
+    stream.read((char*) buffer, sizeof(buffer));    // Warm up
+
+    RtAllocGuard::resetCounts();
+    {
+        RtAllocGuard guard;
+        for (int i = 0; i < 8; i++) {
+            stream.read((char*) buffer, sizeof(buffer));
+        }
+    }
+    EXPECT_EQ(RtAllocGuard::getNewCount(), 0u);
+}
@@ -0,0 +1,146 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <climits>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "rtlogger.h"
+
+namespace {
+struct Collected {
+    std::mutex mutex;
+    std::vector<std::pair<RtLogger::Level, std::string>> lines;
+
+    RtLogger::Sink sink() {
+        return [this](RtLogger::Level level, const std::string& text) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.emplace_back(level, text);
+        };
+    }
+};
+}
+
+// Test events read like the messages they replace
+TEST(RtLoggerTest, Format) {
+    EXPECT_EQ(RtLogger::format(RtLogger::MTC_PLAY_STARTED, 0), "MTC -> Play started");
+    EXPECT_EQ(RtLogger::format(RtLogger::MTC_FRAMERATE_INVALID, 25), "MTC frame rate invalid (0), defaulting to 25fps");
+    EXPECT_EQ(RtLogger::format(RtLogger::END_WAIT, 1500), "Out of file boundaries, waiting 1500 ms");
+    EXPECT_EQ(RtLogger::format(RtLogger::END_WAIT, LONG_MAX), "Out of file boundaries, waiting for quit command");
+    EXPECT_EQ(RtLogger::levelOf(RtLogger::MTC_FRAMERATE_INVALID), RtLogger::LEVEL_WARNING);
+    EXPECT_EQ(RtLogger::levelOf(RtLogger::OUT_OF_FILE), RtLogger::LEVEL_INFO);
+}
+
+// Test events logged from another thread reach the sink in order
+TEST(RtLoggerTest, DeliveredInOrder) {
+    Collected collected;
+    {
+        RtLogger logger(collected.sink());
+        std::thread audio([&logger] {
+            logger.log(RtLogger::MTC_PLAY_STARTED);
+            logger.log(RtLogger::MTC_SIGNAL_LOST);
+            logger.log(RtLogger::END_WAIT, 200);
+        });
+        audio.join();
+        logger.flush();
+
+        std::lock_guard<std::mutex> lock(collected.mutex);
+        ASSERT_EQ(collected.lines.size(), 3u);
+        EXPECT_EQ(collected.lines[0].second, "MTC -> Play started");
+        EXPECT_EQ(collected.lines[1].second, "MTC signal lost");
+        EXPECT_EQ(collected.lines[2].second, "Out of file boundaries, waiting 200 ms");
+    }
+}
+
+// Test the log thread writes on its own, without a flush
+TEST(RtLoggerTest, BackgroundThreadWrites) {
+    Collected collected;
+    RtLogger logger(collected.sink());
+    logger.log(RtLogger::OUT_OF_FILE);
+
+    for (int i = 0; i < 100; i++) {
+        {
+            std::lock_guard<std::mutex> lock(collected.mutex);
+            if (!collected.lines.empty()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> lock(collected.mutex);
+    ASSERT_EQ(collected.lines.size(), 1u);
+    EXPECT_EQ(collected.lines[0].second, "Out of file boundaries!");
+}
+
+// Test events trickling in after the log thread woke are not left behind
+TEST(RtLoggerTest, EveryWakeDrained) {
+    Collected collected;
+    RtLogger logger(collected.sink());
+    const size_t events = 200;
+
+    std::thread audio([&logger] {
+        for (size_t i = 0; i < events; i++) {
+            logger.log(RtLogger::END_WAIT, i);
+            if (i % 10 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    audio.join();
+
+    for (int i = 0; i < 100; i++) {
+        {
+            std::lock_guard<std::mutex> lock(collected.mutex);
+            if (collected.lines.size() == events) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> lock(collected.mutex);
+    ASSERT_EQ(collected.lines.size(), events);
+    EXPECT_EQ(collected.lines.back().second, "Out of file boundaries, waiting 199 ms");
+}
+
+// Test a flood never blocks, whatever does not fit is counted and reported
+TEST(RtLoggerTest, OverflowCountsDrops) {
+    Collected collected;
+    const int events = RTLOGGER_QUEUE_SIZE * 8;
+    unsigned long long dropped = 0;
+    {
+        RtLogger logger(collected.sink());
+        for (int i = 0; i < events; i++) {
+            logger.log(RtLogger::END_WAIT, i);
+        }
+        dropped = logger.getDropped();
+    }
+
+    size_t written = 0;
+    bool reported = false;
+    for (const auto& line : collected.lines) {
+        if (line.second.find("dropped") != std::string::npos) {
+            reported = true;
+            EXPECT_EQ(line.first, RtLogger::LEVEL_WARNING);
+        } else {
+            written++;
+        }
+    }
+    EXPECT_EQ(written + dropped, (size_t) events);
+    EXPECT_EQ(reported, dropped > 0);
+}
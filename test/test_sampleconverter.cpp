@@ -0,0 +1,106 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "sampleconverter.h"
+
+// Random samples for every channel, as packed bytes and as planes
+template <typename Sample>
+struct Source {
+    Source(unsigned int channels, size_t frames, float range) : channels(channels), frames(frames) {
+        std::mt19937 random(channels * 1000 + frames);
+        std::uniform_real_distribution<double> value(-range, range);
+        samples.resize(channels * frames);
+        for (auto& s : samples) s = (Sample) value(random);
+
+        planes.resize(channels, std::vector<Sample>(frames));
+        for (size_t f = 0; f < frames; f++) {
+            for (unsigned int c = 0; c < channels; c++) planes[c][f] = samples[f * channels + c];
+        }
+        for (unsigned int c = 0; c < channels; c++) planePointers.push_back((const uint8_t*) planes[c].data());
+        packedPointer = (const uint8_t*) samples.data();
+    }
+
+    unsigned int channels;
+    size_t frames;
+    std::vector<Sample> samples;                // Interleaved
+    std::vector<std::vector<Sample>> planes;
+    std::vector<const uint8_t*> planePointers;
+    const uint8_t* packedPointer;
+};
+
+template <typename Sample>
+static void expectConverted(SampleConverter::Format packed, SampleConverter::Format planar,
+                            float range, float scale) {
+    for (unsigned int channels : { 1, 2, 6, 8 }) {
+        for (size_t frames : { 0, 1, 3, 4, 7, 8, 9, 1031 }) {
+            Source<Sample> source(channels, frames, range);
+            std::vector<float> out(channels * frames + 1);
+
+            SampleConverter::Function convert = SampleConverter::find(packed, channels);
+            ASSERT_NE(convert, nullptr);
+            out.back() = -9.0f;
+            convert(&source.packedPointer, out.data(), frames);
+            for (size_t i = 0; i < source.samples.size(); i++) {
+                ASSERT_FLOAT_EQ(out[i], (float) source.samples[i] * scale) << channels << " channels, sample " << i;
+            }
+            EXPECT_EQ(out.back(), -9.0f);
+
+            convert = SampleConverter::find(planar, channels);
+            ASSERT_NE(convert, nullptr);
+            std::fill(out.begin(), out.end(), 0.0f);
+            out.back() = -9.0f;
+            convert(source.planePointers.data(), out.data(), frames);
+            for (size_t i = 0; i < source.samples.size(); i++) {
+                ASSERT_FLOAT_EQ(out[i], (float) source.samples[i] * scale)
+                    << SampleConverter::getKernelName() << ", " << channels << " planes, sample " << i << " of " << frames;
+            }
+            EXPECT_EQ(out.back(), -9.0f);      // Nothing written past the end
+        }
+    }
+}
+
+// Test integer formats are scaled to full scale float
+TEST(SampleConverterTest, IntegerFormats) {
+    expectConverted<int16_t>(SampleConverter::S16, SampleConverter::S16P, 32767, 1.0f / 32768.0f);
+    expectConverted<int32_t>(SampleConverter::S32, SampleConverter::S32P, 2147483000.0f, 1.0f / 2147483648.0f);
+}
+
+// Test float and double come through unscaled, planar float included
+TEST(SampleConverterTest, FloatFormats) {
+    expectConverted<float>(SampleConverter::FLT, SampleConverter::FLTP, 1.5f, 1.0f);
+    expectConverted<double>(SampleConverter::DBL, SampleConverter::DBLP, 1.5f, 1.0f);
+}
+
+// Test other channel counts are left to libswresample
+TEST(SampleConverterTest, UnspecialisedCases) {
+    for (unsigned int channels : { 0, 3, 4, 5, 7, 16 }) {
+        EXPECT_EQ(SampleConverter::find(SampleConverter::FLTP, channels), nullptr) << channels;
+    }
+    EXPECT_EQ(SampleConverter::find(SampleConverter::FORMAT_COUNT, 2), nullptr);
+
+    const char* kernel = SampleConverter::getKernelName();
+    EXPECT_TRUE(strcmp(kernel, "avx") == 0 || strcmp(kernel, "sse") == 0 ||
+                strcmp(kernel, "neon") == 0 || strcmp(kernel, "scalar") == 0);
+}
@@ -0,0 +1,153 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "sharedpcm.h"
+
+class SharedPcmTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        key = "test-" + std::to_string(getpid()) + "-" +
+              ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        shm_unlink(SharedPcm::nameFor(key).c_str());
+    }
+
+    void TearDown() override {
+        shm_unlink(SharedPcm::nameFor(key).c_str());
+    }
+
+    bool segmentExists() {
+        int fd = shm_open(SharedPcm::nameFor(key).c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        close(fd);
+        return true;
+    }
+
+    std::string key;
+};
+
+// Test the first attach renders, the next one maps what it published
+TEST_F(SharedPcmTest, ProducerThenConsumer) {
+    SharedPcm producer, consumer;
+    ASSERT_EQ(producer.attach(key, 2, 48000, 64), SharedPcm::PRODUCER);
+    ASSERT_EQ(consumer.attach(key, 2, 48000, 64), SharedPcm::CONSUMER);
+
+    std::atomic<bool> cancel{false};
+    std::atomic<bool> ready{false};
+    std::thread waiter([&]() { ready = consumer.waitReady(cancel); });
+
+    // Beyond the expected size, the segment grows
+    std::vector<float> samples(100000);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = i * 0.5f;
+    ASSERT_TRUE(producer.write(samples.data(), 50000));
+    ASSERT_TRUE(producer.write(samples.data() + 50000, 50000));
+    ASSERT_TRUE(producer.publish());
+    waiter.join();
+
+    ASSERT_TRUE(ready);
+    ASSERT_EQ(consumer.floats(), samples.size());
+    EXPECT_EQ(producer.floats(), samples.size());
+    for (size_t i = 0; i < samples.size(); i += 997) {
+        EXPECT_FLOAT_EQ(consumer.data()[i], samples[i]);
+    }
+
+    // Unlinked by the last one out
+    consumer.detach();
+    EXPECT_TRUE(segmentExists());
+    producer.detach();
+    EXPECT_FALSE(segmentExists());
+}
+
+// Test consumers give up on an unfinished rendition and the name is freed
+TEST_F(SharedPcmTest, ProducerGivesUp) {
+    SharedPcm producer, consumer;
+    ASSERT_EQ(producer.attach(key, 2, 48000, 64), SharedPcm::PRODUCER);
+    ASSERT_EQ(consumer.attach(key, 2, 48000, 64), SharedPcm::CONSUMER);
+
+    float samples[64] = {0};
+    producer.write(samples, 64);
+    producer.detach();
+
+    std::atomic<bool> cancel{false};
+    EXPECT_FALSE(consumer.waitReady(cancel));
+    consumer.detach();
+
+    SharedPcm next;
+    EXPECT_EQ(next.attach(key, 2, 48000, 64), SharedPcm::PRODUCER);
+}
+
+// Test a producer process that died is detected
+TEST_F(SharedPcmTest, DeadProducer) {
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        SharedPcm producer;
+        producer.attach(key, 2, 48000, 64);
+        _exit(0);                   // No detach, like a crash
+    }
+    waitpid(child, nullptr, 0);
+
+    SharedPcm consumer;
+    ASSERT_EQ(consumer.attach(key, 2, 48000, 64), SharedPcm::CONSUMER);
+    std::atomic<bool> cancel{false};
+    EXPECT_FALSE(consumer.waitReady(cancel));
+    consumer.detach();
+
+    SharedPcm next;
+    EXPECT_EQ(next.attach(key, 2, 48000, 64), SharedPcm::PRODUCER);
+}
+
+// Test waiting can be cancelled
+TEST_F(SharedPcmTest, CancelWait) {
+    SharedPcm producer, consumer;
+    ASSERT_EQ(producer.attach(key, 2, 48000, 64), SharedPcm::PRODUCER);
+    ASSERT_EQ(consumer.attach(key, 2, 48000, 64), SharedPcm::CONSUMER);
+
+    std::atomic<bool> cancel{false};
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        cancel = true;
+    });
+    EXPECT_FALSE(consumer.waitReady(cancel));
+    canceller.join();
+}
+
+// Test a rendition of another format is refused
+TEST_F(SharedPcmTest, FormatMismatch) {
+    SharedPcm producer, consumer;
+    ASSERT_EQ(producer.attach(key, 2, 48000, 64), SharedPcm::PRODUCER);
+    float samples[64] = {0};
+    producer.write(samples, 64);
+    ASSERT_TRUE(producer.publish());
+
+    ASSERT_EQ(consumer.attach(key, 1, 48000, 64), SharedPcm::CONSUMER);
+    std::atomic<bool> cancel{false};
+    EXPECT_FALSE(consumer.waitReady(cancel));
+}
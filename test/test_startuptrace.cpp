@@ -0,0 +1,63 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include "startuptrace.h"
+
+// Test the spawn time is in the past of the boot clock
+TEST(StartupTraceTest, SpawnBeforeNow) {
+    double spawn = StartupTrace::spawnTimeMs();
+    ASSERT_GT(spawn, 0.0);
+    EXPECT_LE(spawn, StartupTrace::nowMs());
+}
+
+// Test phases are kept in order and measured from spawn
+TEST(StartupTraceTest, PhasesInOrder) {
+    StartupTrace trace;
+    EXPECT_DOUBLE_EQ(trace.totalMs(), 0.0);
+
+    trace.mark("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    trace.mark("second");
+
+    std::vector<StartupTrace::Phase> phases = trace.phases();
+    ASSERT_EQ(phases.size(), 2u);
+    EXPECT_EQ(phases[0].name, "first");
+    EXPECT_EQ(phases[1].name, "second");
+    EXPECT_GE(phases[0].ms, 0.0);
+    EXPECT_GE(phases[1].ms - phases[0].ms, 19.0);
+    EXPECT_DOUBLE_EQ(trace.totalMs(), phases[1].ms);
+}
+
+// Test the summary names every phase with its own duration
+TEST(StartupTraceTest, Summary) {
+    StartupTrace trace;
+    trace.mark("devices");
+    trace.mark("stream");
+
+    std::string summary = trace.summary();
+    EXPECT_EQ(summary.find("Startup: devices "), 0u);
+    EXPECT_NE(summary.find(", stream +"), std::string::npos);
+    EXPECT_NE(summary.find("ms from spawn"), std::string::npos);
+}
@@ -0,0 +1,137 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include "voice.h"
+#include "testwav.h"
+
+namespace fs = std::filesystem;
+
+class VoiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rampFile = fs::temp_directory_path() / "test_voice_ramp.wav";
+
+        // 16 bit stereo ramp at 44.1 kHz, every sample holds its frame index
+        writeTestWav(rampFile, 20000, 2, rampSample);
+    }
+
+    void TearDown() override {
+        fs::remove(rampFile);
+    }
+
+    // Frame index held by an output sample
+    static float frameOf(float sample) {
+        return sample * 32768.0f;
+    }
+
+    static constexpr long long frameBytes = 2 * sizeof(float);
+    fs::path rampFile;
+};
+
+// Test nothing is mixed until loaded and playing
+TEST_F(VoiceTest, LoadAndPlay) {
+    Voice voice;
+    std::vector<float> out(512 * 2, 0.0f);
+
+    EXPECT_FALSE(voice.isLoaded());
+    EXPECT_FALSE(voice.play());
+    EXPECT_EQ(voice.mix(out.data(), 512, false, 0, 0), 0u);
+
+    ASSERT_TRUE(voice.load(rampFile.string(), 2, 44100, 512));
+    EXPECT_TRUE(voice.isLoaded());
+    EXPECT_FALSE(voice.isPlaying());
+    EXPECT_EQ(voice.mix(out.data(), 512, false, 0, 0), 0u);
+
+    ASSERT_TRUE(voice.play());
+    EXPECT_TRUE(voice.isPlaying());
+    EXPECT_EQ(voice.mix(out.data(), 512, false, 0, 0), 512u * frameBytes);
+    EXPECT_FLOAT_EQ(frameOf(out[0]), 0.0f);
+    EXPECT_FLOAT_EQ(frameOf(out[100 * 2 + 1]), 100.0f);
+
+    voice.stop();
+    EXPECT_FALSE(voice.isPlaying());
+    EXPECT_EQ(voice.mix(out.data(), 512, false, 0, 0), 0u);
+}
+
+// Test voices add onto the output with their gain
+TEST_F(VoiceTest, MixesWithGain) {
+    Voice voice;
+    ASSERT_TRUE(voice.load(rampFile.string(), 2, 44100, 512));
+    voice.setVolume(0.5f);
+    voice.play();
+
+    std::vector<float> out(512 * 2, 1.0f);
+    voice.mix(out.data(), 512, false, 0, 0);
+    EXPECT_FLOAT_EQ(out[0], 1.0f);
+    EXPECT_FLOAT_EQ(out[200 * 2], 1.0f + 100.0f / 32768.0f);
+}
+
+// Test the voice sits on the timeline at its offset
+TEST_F(VoiceTest, FollowsTimeline) {
+    Voice voice;
+    ASSERT_TRUE(voice.load(rampFile.string(), 2, 44100, 512));
+    voice.setOffset(1000);
+    voice.play();
+
+    long long tolerance = 50;
+    std::vector<float> out(512 * 2, 0.0f);
+
+    // Relocated to timeline + offset
+    voice.mix(out.data(), 512, true, 0, tolerance);
+    EXPECT_FLOAT_EQ(frameOf(out[0]), 1000.0f);
+
+    // Inside the tolerance it just plays on
+    std::fill(out.begin(), out.end(), 0.0f);
+    voice.mix(out.data(), 512, true, 500, tolerance);
+    EXPECT_FLOAT_EQ(frameOf(out[0]), 1512.0f);
+
+    // A timecode jump relocates it
+    std::fill(out.begin(), out.end(), 0.0f);
+    voice.mix(out.data(), 512, true, 10000, tolerance);
+    EXPECT_FLOAT_EQ(frameOf(out[0]), 11000.0f);
+
+    // Before its start and past its end it is silent
+    std::fill(out.begin(), out.end(), 0.0f);
+    EXPECT_EQ(voice.mix(out.data(), 512, true, -2000, tolerance), 0u);
+    EXPECT_EQ(voice.mix(out.data(), 512, true, 30000, tolerance), 0u);
+    EXPECT_FLOAT_EQ(out[0], 0.0f);
+}
+
+// Test unloading and failed loads leave the voice empty
+TEST_F(VoiceTest, Unload) {
+    Voice voice;
+    ASSERT_TRUE(voice.load(rampFile.string(), 2, 44100, 512));
+    voice.play();
+    voice.unload();
+    EXPECT_FALSE(voice.isLoaded());
+
+    std::vector<float> out(512 * 2, 0.0f);
+    EXPECT_EQ(voice.mix(out.data(), 512, false, 0, 0), 0u);
+
+    EXPECT_FALSE(voice.load("/nonexistent/voice.wav", 2, 44100, 512));
+    EXPECT_FALSE(voice.isLoaded());
+    EXPECT_FALSE(voice.play());
+}
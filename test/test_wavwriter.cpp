@@ -0,0 +1,105 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include "wavwriter.h"
+
+namespace fs = std::filesystem;
+
+class WavWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testFile = fs::temp_directory_path() / "test_wavwriter.wav";
+    }
+
+    void TearDown() override {
+        if (fs::exists(testFile)) {
+            fs::remove(testFile);
+        }
+    }
+
+    std::vector<char> readAll() {
+        std::ifstream in(testFile, std::ios::binary);
+        return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t field32(const std::vector<char>& data, size_t offset) {
+        uint32_t value;
+        memcpy(&value, data.data() + offset, 4);
+        return value;
+    }
+
+    uint16_t field16(const std::vector<char>& data, size_t offset) {
+        uint16_t value;
+        memcpy(&value, data.data() + offset, 2);
+        return value;
+    }
+
+    fs::path testFile;
+};
+
+// Test invalid geometry is refused
+TEST_F(WavWriterTest, OpenInvalid) {
+    WavWriter writer;
+    EXPECT_FALSE(writer.open(testFile.string(), 0, 48000));
+    EXPECT_FALSE(writer.open(testFile.string(), 2, 0));
+    EXPECT_FALSE(writer.isOpen());
+}
+
+// Test writing without opening fails
+TEST_F(WavWriterTest, WriteClosed) {
+    WavWriter writer;
+    float samples[4] = {0};
+    EXPECT_FALSE(writer.write(samples, 2));
+}
+
+// Test header fields and data after close
+TEST_F(WavWriterTest, HeaderAndData) {
+    WavWriter writer;
+    ASSERT_TRUE(writer.open(testFile.string(), 2, 48000));
+
+    float samples[8] = {0.0f, 0.5f, -0.5f, 1.0f, 0.25f, -0.25f, 0.125f, -1.0f};
+    ASSERT_TRUE(writer.write(samples, 4));
+    EXPECT_EQ(writer.getFramesWritten(), 4u);
+    writer.close();
+
+    std::vector<char> data = readAll();
+    ASSERT_EQ(data.size(), 58u + sizeof(samples));
+
+    EXPECT_EQ(std::string(data.data(), 4), "RIFF");
+    EXPECT_EQ(field32(data, 4), data.size() - 8);
+    EXPECT_EQ(std::string(data.data() + 8, 4), "WAVE");
+    EXPECT_EQ(field16(data, 20), 3);           // IEEE float
+    EXPECT_EQ(field16(data, 22), 2);
+    EXPECT_EQ(field32(data, 24), 48000u);
+    EXPECT_EQ(field16(data, 34), 32);
+    EXPECT_EQ(std::string(data.data() + 38, 4), "fact");
+    EXPECT_EQ(field32(data, 46), 4u);
+    EXPECT_EQ(std::string(data.data() + 50, 4), "data");
+    EXPECT_EQ(field32(data, 54), sizeof(samples));
+    EXPECT_EQ(memcmp(data.data() + 58, samples, sizeof(samples)), 0);
+}
@@ -0,0 +1,78 @@
+/* LICENSE TEXT
+
+    audioplayer for linux based using RtAudio and RtMidi libraries to
+    process audio and receive MTC sync. It also uses oscpack to receive
+    some configurations through osc commands.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+// WAV files written by the tests: integer PCM, little endian, the plain
+// 44 byte RIFF header every decoder in the tree understands.
+
+#ifndef TESTWAV_H
+#define TESTWAV_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+
+// Value of a sample from its frame and channel, in the low bits of the
+// int32_t for formats narrower than 32 bits
+typedef std::function<int32_t(uint32_t frame, uint16_t channel)> TestWavGenerator;
+
+// Every sample holds its own frame index, what most tests check against
+inline int32_t rampSample(uint32_t frame, uint16_t) {
+    return (int32_t)(frame % 32768);
+}
+
+inline void writeTestWav(const std::filesystem::path& path, uint32_t frames, uint16_t channels,
+                         const TestWavGenerator& sample, uint32_t rate = 44100, uint16_t bits = 16) {
+    uint16_t sampleBytes = bits / 8, blockAlign = channels * sampleBytes, pcm = 1;
+    uint32_t dataSize = frames * blockAlign, chunkSize = 36 + dataSize;
+    uint32_t fmtSize = 16, byteRate = rate * blockAlign;
+
+    std::string data;
+    data.reserve(44 + dataSize);
+    auto put = [&data](const void* value, size_t size) {
+        data.append((const char*) value, size);
+    };
+    put("RIFF", 4);
+    put(&chunkSize, 4);
+    put("WAVEfmt ", 8);
+    put(&fmtSize, 4);
+    put(&pcm, 2);
+    put(&channels, 2);
+    put(&rate, 4);
+    put(&byteRate, 4);
+    put(&blockAlign, 2);
+    put(&bits, 2);
+    put("data", 4);
+    put(&dataSize, 4);
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint16_t c = 0; c < channels; c++) {
+            int32_t value = sample(i, c);
+            put(&value, sampleBytes);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.data(), data.size());
+}
+
+#endif // TESTWAV_H